@@ -0,0 +1,126 @@
+#ifndef TEMPLATE_LIB_BENCH_H
+#define TEMPLATE_LIB_BENCH_H
+
+/**
+ * Shared helpers of the benchmarks: a monotonic clock, a deterministic key generator and the command line options.
+ *
+ * Every benchmark writes one CSV row per measurement to stdout (the header first) and its progress to stderr, so
+ * the output of two commits can be compared directly.
+ *
+ * Note:
+ * -Must be included before any other header (it selects the POSIX clock)
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * max_size - The largest element count to run (the sizes go from BENCH_MIN_SIZE up in steps of 4x)
+ * reps     - The number of times each measurement is repeated, the fastest run is reported
+ * min_ops  - The least number of operations a lookup measurement runs, small tables are looked up in rounds
+ */
+struct bench_options
+{
+	size_t max_size;
+	size_t reps;
+	size_t min_ops;
+};
+
+#define BENCH_MIN_SIZE ((size_t)1u << 10u)
+
+/**
+ * Written by the measured loops so that the compiler cannot drop the lookups.
+ */
+static volatile uint64_t bench_sink;
+
+/**
+ * bench_now
+ * @return The monotonic clock in nanoseconds
+ */
+static inline uint64_t
+bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * bench_mix64
+ * The splitmix64 finalizer. It is a bijection, so distinct inputs give distinct (random looking) keys.
+ *
+ * @param x The value to mix
+ * @return The mixed value
+ */
+static inline uint64_t
+bench_mix64(uint64_t x)
+{
+	x ^= x >> 30u;
+	x *= UINT64_C(0xbf58476d1ce4e5b9);
+	x ^= x >> 27u;
+	x *= UINT64_C(0x94d049bb133111eb);
+	x ^= x >> 31u;
+	return x;
+}
+
+/**
+ * bench_shuffle
+ * Fill order with a random permutation of 0..count-1, the same one on every run.
+ *
+ * @param order The permutation to fill
+ * @param count The number of elements in order
+ * @param seed The seed of the permutation
+ */
+static inline void
+bench_shuffle(size_t* order, const size_t count, const uint64_t seed)
+{
+	for (size_t i = 0; i < count; i++) {
+		order[i] = i;
+	}
+	for (size_t i = count; i > 1; i--) {
+		const size_t j = (size_t)(bench_mix64(seed + i) % i);
+		const size_t tmp = order[i - 1];
+		order[i - 1] = order[j];
+		order[j] = tmp;
+	}
+}
+
+/**
+ * bench_parse_options
+ * Parse the options shared by all benchmarks:
+ * 	--max <count>  The largest element count to run
+ * 	--reps <count> The number of repetitions of each measurement
+ *
+ * @param opts The options, holding the defaults of the benchmark
+ * @param argc The argument count of main
+ * @param argv The arguments of main
+ * @return 0 on success, otherwise 1 after printing the usage
+ */
+static inline int
+bench_parse_options(struct bench_options* opts, const int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 < argc && strcmp(argv[i], "--max") == 0) {
+			opts->max_size = (size_t)strtoull(argv[++i], NULL, 10);
+		} else if (i + 1 < argc && strcmp(argv[i], "--reps") == 0) {
+			opts->reps = (size_t)strtoull(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "usage: %s [--max <count>] [--reps <count>]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (opts->max_size < BENCH_MIN_SIZE)
+		opts->max_size = BENCH_MIN_SIZE;
+	if (opts->reps == 0)
+		opts->reps = 1;
+	return 0;
+}
+
+#endif //TEMPLATE_LIB_BENCH_H
@@ -0,0 +1,245 @@
+/**
+ * bench_array
+ * Nanoseconds per operation of array.h.
+ *
+ * Workloads:
+ * 	append          - Append to an array of capacity 2, once per grow factor (1.25, 1.5, 2 and 3), grows included
+ * 	append_reserved - array_<T>_ensure_capacity to the final size first, then append
+ * 	append_n        - array_<T>_append_n blocks of 256 elements to an array of capacity 2, grows included
+ * 	append_fill     - array_<T>_append_fill 256 elements at a time to an array of capacity 2, grows included
+ * 	push            - Add to the head of an array of size elements
+ * 	erase_head      - Erase the head of an array of size elements
+ * 	insert_middle   - Insert in the middle of an array of size elements
+ * 	remove_middle   - Remove from the middle of an array of size elements
+ *
+ * Every workload runs for elements of 1, 4, 8, 16, 64 and 256 bytes, with and without TL_NO_ZERO_MEM, for 1K
+ * elements up to --max elements (by default 4M, at most 128MB of elements) in steps of 4x. The shifting workloads
+ * run as many operations as move about 256MB of elements, so their cost grows linearly with the size.
+ *
+ * Usage:
+ * 	bench_array [--max <count>] [--reps <count>] > array.csv
+ *
+ * Output columns:
+ * 	elem_bytes,zero_mem,grow_factor,size,op,ns_per_op
+ */
+
+#include "bench.h"
+
+#define BENCH_ARRAY_GROW_FACTORS 4u
+#define BENCH_ARRAY_DEFAULT_GROW_FACTOR 2.0f
+#define BENCH_ARRAY_MAX_BYTES ((size_t)1u << 27u)
+#define BENCH_ARRAY_SHIFT_BYTES ((size_t)1u << 28u)
+#define BENCH_ARRAY_BLOCK 256u
+
+static const float bench_array_grow_factors[BENCH_ARRAY_GROW_FACTORS] = {1.25f, 1.5f, 2.0f, 3.0f};
+
+enum bench_array_op
+{
+	BENCH_ARRAY_APPEND = 0,                   /* one per grow factor */
+	BENCH_ARRAY_APPEND_RESERVED = BENCH_ARRAY_GROW_FACTORS,
+	BENCH_ARRAY_APPEND_N,
+	BENCH_ARRAY_APPEND_FILL,
+	BENCH_ARRAY_PUSH,
+	BENCH_ARRAY_ERASE_HEAD,
+	BENCH_ARRAY_INSERT_MIDDLE,
+	BENCH_ARRAY_REMOVE_MIDDLE,
+	BENCH_ARRAY_OPS
+};
+
+static const char* const bench_array_op_names[BENCH_ARRAY_OPS - BENCH_ARRAY_APPEND_RESERVED] = {"append_reserved",
+	"append_n", "append_fill", "push", "erase_head", "insert_middle", "remove_middle"};
+
+struct bench_array_config
+{
+	int zero_mem;
+};
+
+static void
+bench_array_report(const struct bench_array_config* config, const size_t elem_bytes, const size_t count,
+	const size_t op, const double ns)
+{
+	if (op < BENCH_ARRAY_APPEND_RESERVED) {
+		printf("%zu,%d,%.2f,%zu,append,%.2f\n", elem_bytes, config->zero_mem, bench_array_grow_factors[op], count, ns);
+	} else {
+		printf("%zu,%d,%.2f,%zu,%s,%.2f\n", elem_bytes, config->zero_mem, BENCH_ARRAY_DEFAULT_GROW_FACTOR, count,
+			bench_array_op_names[op - BENCH_ARRAY_APPEND_RESERVED], ns);
+	}
+}
+
+struct bench_elem16
+{
+	unsigned char bytes[16];
+};
+
+struct bench_elem64
+{
+	unsigned char bytes[64];
+};
+
+struct bench_elem256
+{
+	unsigned char bytes[256];
+};
+
+
+#define TL_T uint8_t
+#define TL_NAME e1_zm
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_T uint8_t
+#define TL_NAME e1_nzm
+#include "array.h"
+
+#define TL_T uint32_t
+#define TL_NAME e4_zm
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_T uint32_t
+#define TL_NAME e4_nzm
+#include "array.h"
+
+#define TL_T uint64_t
+#define TL_NAME e8_zm
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_T uint64_t
+#define TL_NAME e8_nzm
+#include "array.h"
+
+#define TL_T struct bench_elem16
+#define TL_NAME e16_zm
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_T struct bench_elem16
+#define TL_NAME e16_nzm
+#include "array.h"
+
+#define TL_T struct bench_elem64
+#define TL_NAME e64_zm
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_T struct bench_elem64
+#define TL_NAME e64_nzm
+#include "array.h"
+
+#define TL_T struct bench_elem256
+#define TL_NAME e256_zm
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_T struct bench_elem256
+#define TL_NAME e256_nzm
+#include "array.h"
+
+
+#define BENCH_NAME e1_zm
+#define BENCH_T uint8_t
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e1_nzm
+#define BENCH_T uint8_t
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e4_zm
+#define BENCH_T uint32_t
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e4_nzm
+#define BENCH_T uint32_t
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e8_zm
+#define BENCH_T uint64_t
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e8_nzm
+#define BENCH_T uint64_t
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e16_zm
+#define BENCH_T struct bench_elem16
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e16_nzm
+#define BENCH_T struct bench_elem16
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e64_zm
+#define BENCH_T struct bench_elem64
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e64_nzm
+#define BENCH_T struct bench_elem64
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e256_zm
+#define BENCH_T struct bench_elem256
+#include "bench_array_ops.h"
+
+#define BENCH_NAME e256_nzm
+#define BENCH_T struct bench_elem256
+#include "bench_array_ops.h"
+
+
+int
+main(int argc, char** argv)
+{
+	struct bench_options opts = {(size_t)1u << 22u, 3u, 0u};
+	if (bench_parse_options(&opts, argc, argv) != 0)
+		return 1;
+
+	printf("elem_bytes,zero_mem,grow_factor,size,op,ns_per_op\n");
+	for (size_t count = BENCH_MIN_SIZE; count <= opts.max_size; count <<= 2u) {
+		struct bench_array_config config;
+		fprintf(stderr, "%zu elements\n", count);
+
+		if (count * 1u <= BENCH_ARRAY_MAX_BYTES) {
+			config.zero_mem = 1;
+			bench_array_e1_zm(&opts, &config, count);
+			config.zero_mem = 0;
+			bench_array_e1_nzm(&opts, &config, count);
+		}
+
+		if (count * 4u <= BENCH_ARRAY_MAX_BYTES) {
+			config.zero_mem = 1;
+			bench_array_e4_zm(&opts, &config, count);
+			config.zero_mem = 0;
+			bench_array_e4_nzm(&opts, &config, count);
+		}
+
+		if (count * 8u <= BENCH_ARRAY_MAX_BYTES) {
+			config.zero_mem = 1;
+			bench_array_e8_zm(&opts, &config, count);
+			config.zero_mem = 0;
+			bench_array_e8_nzm(&opts, &config, count);
+		}
+
+		if (count * 16u <= BENCH_ARRAY_MAX_BYTES) {
+			config.zero_mem = 1;
+			bench_array_e16_zm(&opts, &config, count);
+			config.zero_mem = 0;
+			bench_array_e16_nzm(&opts, &config, count);
+		}
+
+		if (count * 64u <= BENCH_ARRAY_MAX_BYTES) {
+			config.zero_mem = 1;
+			bench_array_e64_zm(&opts, &config, count);
+			config.zero_mem = 0;
+			bench_array_e64_nzm(&opts, &config, count);
+		}
+
+		if (count * 256u <= BENCH_ARRAY_MAX_BYTES) {
+			config.zero_mem = 1;
+			bench_array_e256_zm(&opts, &config, count);
+			config.zero_mem = 0;
+			bench_array_e256_nzm(&opts, &config, count);
+		}
+		fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * The array workloads, generated for one array.h instantiation. The defines are consumed by the #include.
+ *
+ * Generates:
+ * 	void bench_array_<BENCH_NAME>(const struct bench_options* opts, const struct bench_array_config* config,
+ * 		size_t count)
+ *
+ * Note:
+ * -Must define BENCH_NAME to the TL_NAME of the array
+ * -Must define BENCH_T to the element type of the array
+ */
+
+#ifndef BENCH_NAME
+#error "BENCH_NAME not defined for bench_array_ops.h"
+#endif
+
+#ifndef BENCH_T
+#error "BENCH_T not defined for bench_array_ops.h"
+#endif
+
+#define _BPFX TLSYMBOL(array, BENCH_NAME)
+#define _BFN(name) TLSYMBOL(TLSYMBOL(bench_array, BENCH_NAME), name)
+
+/**
+ * append is for internal use only
+ * Append count elements to an array of capacity 2 and return the time per element. op selects how: one append at a
+ * time (BENCH_ARRAY_APPEND, or BENCH_ARRAY_APPEND_RESERVED to pre-size the array to count first), or append_n /
+ * append_fill of BENCH_ARRAY_BLOCK elements at a time.
+ */
+static inline double
+_BFN(append)(const size_t count, const float grow_factor, const int op, BENCH_T element)
+{
+	struct _BPFX a;
+	BENCH_T block[BENCH_ARRAY_BLOCK];
+	for (size_t i = 0; i < BENCH_ARRAY_BLOCK; i++) {
+		block[i] = element;
+	}
+	if (TLSYMBOL(_BPFX, init_all)(&a, 2u, grow_factor) != TLOK)
+		return -1.0;
+
+	enum tl_status status = TLOK;
+	const uint64_t start = bench_now();
+	if (op == BENCH_ARRAY_APPEND_N || op == BENCH_ARRAY_APPEND_FILL) {
+		for (size_t i = 0; status == TLOK && i < count; i += BENCH_ARRAY_BLOCK) {
+			const size_t n = (count - i < BENCH_ARRAY_BLOCK) ? count - i : BENCH_ARRAY_BLOCK;
+			status = (op == BENCH_ARRAY_APPEND_N) ? TLSYMBOL(_BPFX, append_n)(&a, block, n)
+				: TLSYMBOL(_BPFX, append_fill)(&a, element, n);
+		}
+	} else {
+		if (op == BENCH_ARRAY_APPEND_RESERVED)
+			status = TLSYMBOL(_BPFX, ensure_capacity)(&a, count);
+		for (size_t i = 0; status == TLOK && i < count; i++) {
+			status = TLSYMBOL(_BPFX, append)(&a, element);
+		}
+	}
+	const uint64_t elapsed = bench_now() - start;
+
+	bench_sink += a.size;
+	TLSYMBOL(_BPFX, deinit)(&a);
+	return (status == TLOK) ? (double)elapsed / (double)count : -1.0;
+}
+
+/**
+ * shift is for internal use only
+ * On an array of count elements, time ops pushes, ops erases at the head, ops inserts in the middle and ops removes
+ * from the middle (in that order, so the array is back to count elements after each pair).
+ */
+static inline int
+_BFN(shift)(const size_t count, const size_t ops, BENCH_T element, double* ns)
+{
+	struct _BPFX a;
+	if (TLSYMBOL(_BPFX, init_all)(&a, count + ops + 1u, BENCH_ARRAY_DEFAULT_GROW_FACTOR) != TLOK)
+		return 1;
+	for (size_t i = 0; i < count; i++) {
+		TLSYMBOL(_BPFX, append)(&a, element);
+	}
+
+	uint64_t start = bench_now();
+	for (size_t i = 0; i < ops; i++) {
+		TLSYMBOL(_BPFX, push)(&a, element);
+	}
+	ns[BENCH_ARRAY_PUSH] = (double)(bench_now() - start) / (double)ops;
+
+	start = bench_now();
+	for (size_t i = 0; i < ops; i++) {
+		TLSYMBOL(_BPFX, erase)(&a, 0u);
+	}
+	ns[BENCH_ARRAY_ERASE_HEAD] = (double)(bench_now() - start) / (double)ops;
+
+	start = bench_now();
+	for (size_t i = 0; i < ops; i++) {
+		TLSYMBOL(_BPFX, insert)(&a, a.size / 2u, element);
+	}
+	ns[BENCH_ARRAY_INSERT_MIDDLE] = (double)(bench_now() - start) / (double)ops;
+
+	BENCH_T removed = element;
+	start = bench_now();
+	for (size_t i = 0; i < ops; i++) {
+		removed = TLSYMBOL(_BPFX, remove)(&a, a.size / 2u);
+	}
+	ns[BENCH_ARRAY_REMOVE_MIDDLE] = (double)(bench_now() - start) / (double)ops;
+
+	bench_sink += a.size + ((const unsigned char*)&removed)[0];
+	TLSYMBOL(_BPFX, deinit)(&a);
+	return 0;
+}
+
+/**
+ * bench_array_<BENCH_NAME>
+ * Run every workload over count elements, reporting the fastest of opts->reps runs of each.
+ *
+ * @param opts The benchmark options
+ * @param config What the instantiation looks like, for the report
+ * @param count The number of elements
+ */
+static inline void
+TLSYMBOL(bench_array, BENCH_NAME)(const struct bench_options* opts, const struct bench_array_config* config,
+	const size_t count)
+{
+	/* bound the bytes moved by the shifting operations so that the large arrays run as fast as the small ones */
+	size_t ops = (size_t)BENCH_ARRAY_SHIFT_BYTES / (count * sizeof(BENCH_T));
+	ops = (ops < 16u) ? 16u : ((ops > count) ? count : ops);
+
+	double best[BENCH_ARRAY_OPS];
+	for (size_t op = 0; op < BENCH_ARRAY_OPS; op++) {
+		best[op] = -1.0;
+	}
+
+	BENCH_T element;
+	memset(&element, 0x5a, sizeof(element));
+
+	for (size_t rep = 0; rep < opts->reps; rep++) {
+		double ns[BENCH_ARRAY_OPS];
+
+		for (size_t gf = 0; gf < BENCH_ARRAY_GROW_FACTORS; gf++) {
+			ns[BENCH_ARRAY_APPEND + gf] = _BFN(append)(count, bench_array_grow_factors[gf], BENCH_ARRAY_APPEND,
+				element);
+		}
+		for (int op = BENCH_ARRAY_APPEND_RESERVED; op <= BENCH_ARRAY_APPEND_FILL; op++) {
+			ns[op] = _BFN(append)(count, BENCH_ARRAY_DEFAULT_GROW_FACTOR, op, element);
+		}
+		if (_BFN(shift)(count, ops, element, ns) != 0) {
+			fprintf(stderr, "%zu byte elements: out of memory at %zu elements\n", sizeof(BENCH_T), count);
+			return;
+		}
+
+		for (size_t op = 0; op < BENCH_ARRAY_OPS; op++) {
+			if (best[op] < 0.0 || ns[op] < best[op])
+				best[op] = ns[op];
+		}
+	}
+
+	for (size_t op = 0; op < BENCH_ARRAY_OPS; op++) {
+		bench_array_report(config, sizeof(BENCH_T), count, op, best[op]);
+	}
+}
+
+#undef _BFN
+#undef _BPFX
+#undef BENCH_T
+#undef BENCH_NAME
@@ -0,0 +1,186 @@
+/**
+ * bench_flatmap
+ * Nanoseconds per operation of flatmap.h for insert, hit lookup, miss lookup, erase and a mixed workload.
+ *
+ * Every workload runs over integer (uint64_t), struct (16 bytes) and string (16 characters) keys, with and without
+ * TL_NO_ZERO_MEM, at load factors 50, 70 and 90 and for 1K keys (well inside L1) up to --max keys (by default 4M,
+ * far past the LLC) in steps of 4x.
+ *
+ * Usage:
+ * 	bench_flatmap [--max <count>] [--reps <count>] > flatmap.csv
+ *
+ * Output columns:
+ * 	key,zero_mem,load_factor,size,op,ns_per_op
+ *
+ * The insert starts from an empty map of 2 buckets, so it includes every grow. The erase removes every key.
+ */
+
+#include "bench.h"
+
+enum bench_fmap_op
+{
+	BENCH_FMAP_INSERT,
+	BENCH_FMAP_HIT,
+	BENCH_FMAP_MISS,
+	BENCH_FMAP_MIXED,
+	BENCH_FMAP_ERASE,
+	BENCH_FMAP_OPS
+};
+
+static const char* const bench_fmap_op_names[BENCH_FMAP_OPS] = {"insert", "hit", "miss", "mixed", "erase"};
+
+struct bench_fmap_config
+{
+	const char* key;
+	int zero_mem;
+	size_t load_factor;
+};
+
+static void
+bench_fmap_report(const struct bench_fmap_config* config, const size_t count, const enum bench_fmap_op op,
+	const double ns)
+{
+	printf("%s,%d,%zu,%zu,%s,%.2f\n", config->key, config->zero_mem, config->load_factor, count,
+		bench_fmap_op_names[op], ns);
+}
+
+struct bench_key
+{
+	uint32_t id;
+	uint32_t kind;
+	uint64_t tag;
+};
+
+#define BENCH_STR_LEN 16u
+
+
+#define TL_K uint64_t
+#define TL_V uint64_t
+#define TL_NAME int_zm
+#include "flatmap.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_K uint64_t
+#define TL_V uint64_t
+#define TL_NAME int_nzm
+#include "flatmap.h"
+
+#define fmap_key_equalsfn(left, right) ((left).id == (right).id && (left).kind == (right).kind && (left).tag == (right).tag)
+#define TL_K struct bench_key
+#define TL_V uint64_t
+#define TL_NAME struct_zm
+#include "flatmap.h"
+
+#define fmap_key_equalsfn(left, right) ((left).id == (right).id && (left).kind == (right).kind && (left).tag == (right).tag)
+#define TL_NO_ZERO_MEM
+#define TL_K struct bench_key
+#define TL_V uint64_t
+#define TL_NAME struct_nzm
+#include "flatmap.h"
+
+/* TL_KEY_IS_NT stays defined after flatmap.h, so the string maps come last */
+#define fmap_key_equalsfn(left, right) (strcmp((left), (right)) == 0)
+#define TL_KEY_IS_NT
+#define TL_K char*
+#define TL_V uint64_t
+#define TL_NAME str_zm
+#include "flatmap.h"
+
+#define fmap_key_equalsfn(left, right) (strcmp((left), (right)) == 0)
+#define TL_NO_ZERO_MEM
+#define TL_K char*
+#define TL_V uint64_t
+#define TL_NAME str_nzm
+#include "flatmap.h"
+
+
+#define BENCH_NAME int_zm
+#define BENCH_K uint64_t
+#include "bench_flatmap_ops.h"
+
+#define BENCH_NAME int_nzm
+#define BENCH_K uint64_t
+#include "bench_flatmap_ops.h"
+
+#define BENCH_NAME struct_zm
+#define BENCH_K struct bench_key
+#include "bench_flatmap_ops.h"
+
+#define BENCH_NAME struct_nzm
+#define BENCH_K struct bench_key
+#include "bench_flatmap_ops.h"
+
+#define BENCH_NAME str_zm
+#define BENCH_K char*
+#include "bench_flatmap_ops.h"
+
+#define BENCH_NAME str_nzm
+#define BENCH_K char*
+#include "bench_flatmap_ops.h"
+
+
+int
+main(int argc, char** argv)
+{
+	static const size_t load_factors[] = {50u, 70u, 90u};
+	struct bench_options opts = {(size_t)1u << 22u, 3u, (size_t)1u << 20u};
+	if (bench_parse_options(&opts, argc, argv) != 0)
+		return 1;
+
+	/* keys are the even generated values and misses the odd ones, so every prefix of the arrays is a valid set */
+	const size_t max = opts.max_size;
+	uint64_t* int_keys = malloc(2u * max * sizeof(uint64_t));
+	struct bench_key* struct_keys = malloc(2u * max * sizeof(struct bench_key));
+	char** str_keys = malloc(2u * max * sizeof(char*));
+	char* str_data = malloc(2u * max * (BENCH_STR_LEN + 1u));
+	size_t* order = malloc(max * sizeof(size_t));
+	if (!int_keys || !struct_keys || !str_keys || !str_data || !order) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < 2u * max; i++) {
+		const size_t at = (i >> 1u) + (i & 1u) * max;
+		const uint64_t value = bench_mix64(i);
+
+		int_keys[at] = value;
+		struct_keys[at].id = (uint32_t)value;
+		struct_keys[at].kind = (uint32_t)(value >> 32u);
+		struct_keys[at].tag = ~value;
+		str_keys[at] = str_data + i * (BENCH_STR_LEN + 1u);
+		snprintf(str_keys[at], BENCH_STR_LEN + 1u, "%016llx", (unsigned long long)value);
+	}
+
+	printf("key,zero_mem,load_factor,size,op,ns_per_op\n");
+	for (size_t count = BENCH_MIN_SIZE; count <= max; count <<= 2u) {
+		bench_shuffle(order, count, count);
+		fprintf(stderr, "%zu keys\n", count);
+
+		for (size_t lf = 0; lf < sizeof(load_factors) / sizeof(load_factors[0]); lf++) {
+			struct bench_fmap_config config = {"int", 1, load_factors[lf]};
+			bench_int_zm(&opts, &config, int_keys, int_keys + max, order, count);
+			config.zero_mem = 0;
+			bench_int_nzm(&opts, &config, int_keys, int_keys + max, order, count);
+
+			config.key = "struct";
+			config.zero_mem = 1;
+			bench_struct_zm(&opts, &config, struct_keys, struct_keys + max, order, count);
+			config.zero_mem = 0;
+			bench_struct_nzm(&opts, &config, struct_keys, struct_keys + max, order, count);
+
+			config.key = "string";
+			config.zero_mem = 1;
+			bench_str_zm(&opts, &config, str_keys, str_keys + max, order, count);
+			config.zero_mem = 0;
+			bench_str_nzm(&opts, &config, str_keys, str_keys + max, order, count);
+			fflush(stdout);
+		}
+	}
+
+	free(order);
+	free(str_data);
+	free(str_keys);
+	free(struct_keys);
+	free(int_keys);
+	return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * bench_flatmap_memory
+ * The memory footprint of flatmap.h per key distribution and load factor, for capacity planning.
+ *
+ * A bucket holds log2n(num_buckets) slots and the map grows both at the load factor and when a single bucket
+ * overflows, so the bytes actually spent per entry depend on how well the keys spread. Every configuration inserts
+ * the keys one at a time into a map starting at 2 buckets and reports the shape of the map afterward.
+ *
+ * Distributions:
+ * 	sequential - 0, 1, 2, ...
+ * 	random     - Uniformly random 64 bit values
+ * 	clustered  - Runs of 64 consecutive values at random starting points
+ * 	strings    - "key:<n>" strings (the bytes of the strings themselves are not part of the table)
+ *
+ * The integer distributions run with the default hash (fnv1a) and with TL_KEY_IS_INT (fibhash, high bit buckets).
+ * Each configuration runs in its own process, so its peak RSS is not polluted by the others.
+ *
+ * Usage:
+ * 	bench_flatmap_memory [--max <count>] > flatmap_memory.csv
+ *
+ * Output columns:
+ * 	distribution,hash,load_factor,keys,buckets,capacity,fill,grows,table_bytes,bytes_per_entry,peak_rss_kb,
+ * 	rss_per_entry
+ *
+ * fill is keys / capacity, bytes_per_entry is table_bytes / keys and rss_per_entry is the growth of the peak RSS
+ * over the inserts (this includes the old and new table side by side during the last grow) divided by keys.
+ */
+
+#include "bench.h"
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct bench_memory_stats
+{
+	size_t size;
+	size_t buckets;
+	size_t capacity;
+	size_t grows;
+	size_t table_bytes;
+};
+
+enum bench_distribution
+{
+	BENCH_SEQUENTIAL,
+	BENCH_RANDOM,
+	BENCH_CLUSTERED,
+	BENCH_STRINGS,
+	BENCH_DISTRIBUTIONS
+};
+
+static const char* const bench_distribution_names[BENCH_DISTRIBUTIONS] = {"sequential", "random", "clustered",
+	"strings"};
+
+#define BENCH_CLUSTER 64u
+
+
+#define TL_K uint64_t
+#define TL_V uint64_t
+#define TL_NAME fnv1a
+#include "flatmap.h"
+
+#define TL_KEY_IS_INT
+#define TL_K uint64_t
+#define TL_V uint64_t
+#define TL_NAME fibhash
+#include "flatmap.h"
+
+/* TL_KEY_IS_NT stays defined after flatmap.h, so the string map comes last */
+#define fmap_key_equalsfn(left, right) (strcmp((left), (right)) == 0)
+#define TL_KEY_IS_NT
+#define TL_K char*
+#define TL_V uint64_t
+#define TL_NAME str
+#include "flatmap.h"
+
+
+#define BENCH_NAME fnv1a
+#define BENCH_K uint64_t
+#include "bench_flatmap_memory_ops.h"
+
+#define BENCH_NAME fibhash
+#define BENCH_K uint64_t
+#include "bench_flatmap_memory_ops.h"
+
+#define BENCH_NAME str
+#define BENCH_K char*
+#include "bench_flatmap_memory_ops.h"
+
+
+/**
+ * bench_peak_rss
+ * @return The peak resident set size of this process in kilobytes
+ */
+static size_t
+bench_peak_rss(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (size_t)usage.ru_maxrss;
+}
+
+/**
+ * bench_run
+ * Generate the keys and fill one map, then print the row of the configuration. Runs in the child process.
+ */
+static int
+bench_run(const enum bench_distribution dist, const int int_key, const size_t load_factor, const size_t count)
+{
+	struct bench_memory_stats stats;
+	uint64_t* ints = NULL;
+	char** strs = NULL;
+	char* str_data = NULL;
+	int failed;
+
+	if (dist == BENCH_STRINGS) {
+		strs = malloc(count * sizeof(char*));
+		str_data = malloc(count * 24u);
+		if (!strs || !str_data)
+			return 1;
+		for (size_t i = 0; i < count; i++) {
+			strs[i] = str_data + i * 24u;
+			snprintf(strs[i], 24u, "key:%zu", i);
+		}
+	} else {
+		ints = malloc(count * sizeof(uint64_t));
+		if (!ints)
+			return 1;
+		for (size_t i = 0; i < count; i++) {
+			switch (dist) {
+			case BENCH_SEQUENTIAL:
+				ints[i] = i;
+				break;
+			case BENCH_RANDOM:
+				ints[i] = bench_mix64(i);
+				break;
+			default:
+				ints[i] = (bench_mix64(i / BENCH_CLUSTER) & ~(uint64_t)(BENCH_CLUSTER - 1u)) + i % BENCH_CLUSTER;
+				break;
+			}
+		}
+	}
+
+	const size_t base_rss = bench_peak_rss();
+	if (dist == BENCH_STRINGS) {
+		failed = bench_memory_str(strs, count, load_factor, &stats);
+	} else if (int_key) {
+		failed = bench_memory_fibhash(ints, count, load_factor, &stats);
+	} else {
+		failed = bench_memory_fnv1a(ints, count, load_factor, &stats);
+	}
+	if (failed) {
+		fprintf(stderr, "%s: insert failed at %zu keys\n", bench_distribution_names[dist], count);
+		return 1;
+	}
+	const size_t peak_rss = bench_peak_rss();
+
+	printf("%s,%s,%zu,%zu,%zu,%zu,%.3f,%zu,%zu,%.2f,%zu,%.2f\n", bench_distribution_names[dist],
+		(dist == BENCH_STRINGS) ? "ntfnv1a" : (int_key ? "fibhash" : "fnv1a"), load_factor, stats.size,
+		stats.buckets, stats.capacity, (double)stats.size / (double)stats.capacity, stats.grows, stats.table_bytes,
+		(double)stats.table_bytes / (double)stats.size, peak_rss,
+		(double)(peak_rss - base_rss) * 1024.0 / (double)stats.size);
+	return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	static const size_t load_factors[] = {50u, 70u, 90u};
+	struct bench_options opts = {(size_t)1u << 22u, 1u, 0u};
+	if (bench_parse_options(&opts, argc, argv) != 0)
+		return 1;
+
+	printf("distribution,hash,load_factor,keys,buckets,capacity,fill,grows,table_bytes,bytes_per_entry,peak_rss_kb,"
+		"rss_per_entry\n");
+	for (size_t count = BENCH_MIN_SIZE; count <= opts.max_size; count <<= 2u) {
+		fprintf(stderr, "%zu keys\n", count);
+
+		for (int dist = 0; dist < BENCH_DISTRIBUTIONS; dist++) {
+			for (int int_key = 0; int_key < ((dist == BENCH_STRINGS) ? 1 : 2); int_key++) {
+				for (size_t lf = 0; lf < sizeof(load_factors) / sizeof(load_factors[0]); lf++) {
+					fflush(stdout);
+					const pid_t pid = fork();
+					if (pid < 0) {
+						perror("fork");
+						return 1;
+					}
+					if (pid == 0) {
+						const int ret = bench_run((enum bench_distribution)dist, int_key, load_factors[lf], count);
+						fflush(stdout);
+						_exit(ret);
+					}
+
+					int status = 0;
+					waitpid(pid, &status, 0);
+					if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+						fprintf(stderr, "configuration failed\n");
+				}
+			}
+		}
+	}
+	return 0;
+}
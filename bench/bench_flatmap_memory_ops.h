@@ -0,0 +1,63 @@
+/**
+ * The memory footprint measurement, generated for one flatmap.h instantiation. The defines are consumed by the
+ * #include.
+ *
+ * Generates:
+ * 	int bench_memory_<BENCH_NAME>(BENCH_K* keys, size_t count, size_t load_factor, struct bench_memory_stats* out)
+ *
+ * Note:
+ * -Must define BENCH_NAME to the TL_NAME of the flatmap
+ * -Must define BENCH_K to the key type of the flatmap, the value type must be uint64_t
+ */
+
+#ifndef BENCH_NAME
+#error "BENCH_NAME not defined for bench_flatmap_memory_ops.h"
+#endif
+
+#ifndef BENCH_K
+#error "BENCH_K not defined for bench_flatmap_memory_ops.h"
+#endif
+
+#define _BPFX TLSYMBOL(fmap, BENCH_NAME)
+
+/**
+ * bench_memory_<BENCH_NAME>
+ * Insert count keys one at a time into a map starting at 2 buckets and record its shape. The map is kept (not
+ * released) so that the peak RSS of the process includes it.
+ *
+ * @param keys The keys to insert
+ * @param count The number of keys
+ * @param load_factor The load factor of the map
+ * @param out The shape of the map after the inserts
+ * @return 0 on success, otherwise 1
+ */
+static inline int
+TLSYMBOL(bench_memory, BENCH_NAME)(BENCH_K* keys, const size_t count, const size_t load_factor,
+	struct bench_memory_stats* out)
+{
+	struct _BPFX fm;
+	if (TLSYMBOL(_BPFX, init_all)(&fm, 2u, load_factor) != TLOK)
+		return 1;
+
+	size_t grows = 0;
+	size_t capacity = fm.capacity;
+	for (size_t i = 0; i < count; i++) {
+		if (TLSYMBOL(_BPFX, insert)(&fm, keys[i], (uint64_t)i) != TLOK)
+			return 1;
+		if (fm.capacity != capacity) {
+			capacity = fm.capacity;
+			grows++;
+		}
+	}
+
+	out->size = fm.size;
+	out->buckets = fm.num_buckets;
+	out->capacity = fm.capacity;
+	out->grows = grows;
+	out->table_bytes = fm.capacity * (sizeof(struct TLSYMBOL(_BPFX, node)) + sizeof(enum tl_map_slot_state));
+	return 0;
+}
+
+#undef _BPFX
+#undef BENCH_K
+#undef BENCH_NAME
@@ -0,0 +1,163 @@
+/**
+ * The flatmap workloads, generated for one flatmap.h instantiation. Like the containers it is a template: the defines
+ * are consumed by the #include.
+ *
+ * Generates:
+ * 	void bench_<BENCH_NAME>(const struct bench_options* opts, const struct bench_fmap_config* config,
+ * 		BENCH_K* keys, BENCH_K* misses, const size_t* order, size_t count)
+ *
+ * Note:
+ * -Must define BENCH_NAME to the TL_NAME of the flatmap
+ * -Must define BENCH_K to the key type of the flatmap, the value type must be uint64_t
+ * -keys and misses hold count distinct keys each, no key of misses is in keys
+ * -order is a random permutation of 0..count-1, the lookups and erases visit the keys in that order
+ */
+
+#ifndef BENCH_NAME
+#error "BENCH_NAME not defined for bench_flatmap_ops.h"
+#endif
+
+#ifndef BENCH_K
+#error "BENCH_K not defined for bench_flatmap_ops.h"
+#endif
+
+#define _BPFX TLSYMBOL(fmap, BENCH_NAME)
+
+/**
+ * fill is for internal use only
+ * Insert every key in order of generation, returning the time taken or 0 on failure.
+ */
+static inline uint64_t
+TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), fill)(struct _BPFX* fm, BENCH_K* keys, const size_t count)
+{
+	const uint64_t start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		if (TLSYMBOL(_BPFX, insert)(fm, keys[i], (uint64_t)i) != TLOK)
+			return 0;
+	}
+	return bench_now() - start;
+}
+
+/**
+ * lookup is for internal use only
+ * Look up the keys in the given order, in rounds until at least min_ops lookups ran, returning the time per lookup.
+ */
+static inline double
+TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), lookup)(struct _BPFX* fm, BENCH_K* keys, const size_t* order,
+	const size_t count, const size_t min_ops)
+{
+	const size_t rounds = (min_ops + count - 1u) / count;
+	uint64_t found = 0;
+	uint64_t value = 0;
+
+	const uint64_t start = bench_now();
+	for (size_t r = 0; r < rounds; r++) {
+		for (size_t i = 0; i < count; i++) {
+			found += TLSYMBOL(_BPFX, try_get)(fm, keys[order[i]], &value) == TLOK;
+			found += value;
+		}
+	}
+	const uint64_t elapsed = bench_now() - start;
+	bench_sink += found;
+	return (double)elapsed / (double)(rounds * count);
+}
+
+/**
+ * mixed is for internal use only
+ * Per 4 operations: 2 hit lookups, 1 miss lookup and the erase and insert back of a key, returning the time per
+ * operation. The map is full again afterward.
+ */
+static inline double
+TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), mixed)(struct _BPFX* fm, BENCH_K* keys, BENCH_K* misses,
+	const size_t* order, const size_t count, const size_t min_ops)
+{
+	const size_t ops = (min_ops > count) ? min_ops : count;
+	uint64_t found = 0;
+	uint64_t value = 0;
+
+	const uint64_t start = bench_now();
+	for (size_t i = 0; i < ops; i++) {
+		const size_t at = order[i % count];
+		switch (i & 3u) {
+		case 0:
+			found += TLSYMBOL(_BPFX, erase)(fm, keys[at]) == TLOK;
+			found += TLSYMBOL(_BPFX, insert)(fm, keys[at], (uint64_t)at) == TLOK;
+			break;
+		case 1:
+			found += TLSYMBOL(_BPFX, try_get)(fm, misses[at], &value) == TLOK;
+			break;
+		default:
+			found += TLSYMBOL(_BPFX, try_get)(fm, keys[at], &value) == TLOK;
+			found += value;
+			break;
+		}
+	}
+	const uint64_t elapsed = bench_now() - start;
+	bench_sink += found;
+	return (double)elapsed / (double)(ops + ops / 4u);
+}
+
+/**
+ * bench_<BENCH_NAME>
+ * Run every workload over count keys, reporting the fastest of opts->reps runs of each.
+ *
+ * @param opts The benchmark options
+ * @param config What the instantiation and the table look like, for the report
+ * @param keys The keys to insert
+ * @param misses The keys to look up that are not in the map
+ * @param order The order of the lookups and erases
+ * @param count The number of keys
+ */
+static inline void
+TLSYMBOL(bench, BENCH_NAME)(const struct bench_options* opts, const struct bench_fmap_config* config,
+	BENCH_K* keys, BENCH_K* misses, const size_t* order, const size_t count)
+{
+	double best[BENCH_FMAP_OPS];
+	for (size_t op = 0; op < BENCH_FMAP_OPS; op++) {
+		best[op] = -1.0;
+	}
+
+	for (size_t rep = 0; rep < opts->reps; rep++) {
+		struct _BPFX fm;
+		double ns[BENCH_FMAP_OPS];
+
+		if (TLSYMBOL(_BPFX, init_all)(&fm, 2u, config->load_factor) != TLOK) {
+			fprintf(stderr, "%s: out of memory at %zu keys\n", config->key, count);
+			return;
+		}
+
+		const uint64_t insert_time = TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), fill)(&fm, keys, count);
+		if (insert_time == 0) {
+			fprintf(stderr, "%s: insert failed at %zu keys\n", config->key, count);
+			TLSYMBOL(_BPFX, deinit)(&fm);
+			return;
+		}
+		ns[BENCH_FMAP_INSERT] = (double)insert_time / (double)count;
+		ns[BENCH_FMAP_HIT] = TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), lookup)(&fm, keys, order, count, opts->min_ops);
+		ns[BENCH_FMAP_MISS] = TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), lookup)(&fm, misses, order, count, opts->min_ops);
+		ns[BENCH_FMAP_MIXED] = TLSYMBOL(TLSYMBOL(bench, BENCH_NAME), mixed)(&fm, keys, misses, order, count,
+			opts->min_ops);
+
+		const uint64_t start = bench_now();
+		for (size_t i = 0; i < count; i++) {
+			TLSYMBOL(_BPFX, erase)(&fm, keys[order[i]]);
+		}
+		ns[BENCH_FMAP_ERASE] = (double)(bench_now() - start) / (double)count;
+		bench_sink += fm.size;
+
+		TLSYMBOL(_BPFX, deinit)(&fm);
+
+		for (size_t op = 0; op < BENCH_FMAP_OPS; op++) {
+			if (best[op] < 0.0 || ns[op] < best[op])
+				best[op] = ns[op];
+		}
+	}
+
+	for (size_t op = 0; op < BENCH_FMAP_OPS; op++) {
+		bench_fmap_report(config, count, (enum bench_fmap_op)op, best[op]);
+	}
+}
+
+#undef _BPFX
+#undef BENCH_K
+#undef BENCH_NAME
@@ -0,0 +1,140 @@
+/**
+ * bench_search
+ * Nanoseconds per lookup of array_<T>_lower_bound on a sorted uint64_t array, next to a textbook (branching) binary
+ * search and bsearch over the same data.
+ *
+ * Every size from 1K elements up to --max elements (by default 16M, 128MB) in steps of 4x is looked up with the same
+ * 1M random keys, half of them present. Above the cache sizes nearly every probe of the first steps misses, which is
+ * what the prefetching of lower_bound targets.
+ *
+ * Usage:
+ * 	bench_search [--max <count>] [--reps <count>] > search.csv
+ *
+ * Output columns:
+ * 	size,algorithm,ns_per_lookup
+ */
+
+#include "bench.h"
+
+#define BENCH_SEARCH_LOOKUPS ((size_t)1u << 20u)
+
+enum bench_search_algo
+{
+	BENCH_SEARCH_LOWER_BOUND,
+	BENCH_SEARCH_BRANCHY,
+	BENCH_SEARCH_BSEARCH,
+	BENCH_SEARCH_ALGOS
+};
+
+static const char* const bench_search_algo_names[BENCH_SEARCH_ALGOS] = {"lower_bound", "branchy", "bsearch"};
+
+
+#define TL_NO_ZERO_MEM
+#define array_cmpfn(left, right) (((left) > (right)) - ((left) < (right)))
+#define TL_T uint64_t
+#define TL_NAME u64
+#include "array.h"
+
+
+static int
+bench_u64_compare(const void* left, const void* right)
+{
+	const uint64_t l = *(const uint64_t*)left;
+	const uint64_t r = *(const uint64_t*)right;
+	return (l > r) - (l < r);
+}
+
+/**
+ * bench_branchy
+ * The textbook lower bound, one unpredictable branch per step.
+ */
+static inline size_t
+bench_branchy(const uint64_t* data, const size_t count, const uint64_t value)
+{
+	size_t lo = 0;
+	size_t hi = count;
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (data[mid] < value) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/**
+ * bench_search_run
+ * Time BENCH_SEARCH_LOOKUPS lookups with one algorithm.
+ * @return The nanoseconds per lookup
+ */
+static double
+bench_search_run(const struct array_u64* a, const uint64_t* keys, const enum bench_search_algo algo)
+{
+	uint64_t sum = 0;
+	const uint64_t start = bench_now();
+	for (size_t i = 0; i < BENCH_SEARCH_LOOKUPS; i++) {
+		switch (algo) {
+		case BENCH_SEARCH_LOWER_BOUND:
+			sum += array_u64_lower_bound(a, keys[i]);
+			break;
+		case BENCH_SEARCH_BRANCHY:
+			sum += bench_branchy(a->data, a->size, keys[i]);
+			break;
+		default: {
+			const uint64_t* found = bsearch(&keys[i], a->data, a->size, sizeof(uint64_t), &bench_u64_compare);
+			sum += (found != NULL) ? (uint64_t)(found - a->data) : 0u;
+			break;
+		}
+		}
+	}
+	const uint64_t elapsed = bench_now() - start;
+
+	bench_sink += sum;
+	return (double)elapsed / (double)BENCH_SEARCH_LOOKUPS;
+}
+
+int
+main(int argc, char** argv)
+{
+	struct bench_options opts = {(size_t)1u << 24u, 3u, 0u};
+	if (bench_parse_options(&opts, argc, argv) != 0)
+		return 1;
+
+	struct array_u64 a;
+	uint64_t* keys = malloc(BENCH_SEARCH_LOOKUPS * sizeof(uint64_t));
+	if (!keys || array_u64_init_all(&a, opts.max_size, 2.0f) != TLOK) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	printf("size,algorithm,ns_per_lookup\n");
+	for (size_t count = BENCH_MIN_SIZE; count <= opts.max_size; count <<= 2u) {
+		fprintf(stderr, "%zu elements\n", count);
+
+		/* the even numbers, looked up with random values of twice the range */
+		a.size = count;
+		for (size_t i = 0; i < count; i++) {
+			a.data[i] = (uint64_t)i * 2u;
+		}
+		for (size_t i = 0; i < BENCH_SEARCH_LOOKUPS; i++) {
+			keys[i] = bench_mix64(i) % ((uint64_t)count * 2u);
+		}
+
+		for (int algo = 0; algo < BENCH_SEARCH_ALGOS; algo++) {
+			double best = -1.0;
+			for (size_t rep = 0; rep < opts.reps; rep++) {
+				const double ns = bench_search_run(&a, keys, (enum bench_search_algo)algo);
+				if (best < 0.0 || ns < best)
+					best = ns;
+			}
+			printf("%zu,%s,%.2f\n", count, bench_search_algo_names[algo], best);
+		}
+		fflush(stdout);
+	}
+
+	array_u64_deinit(&a);
+	free(keys);
+	return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * bench_sort
+ * Nanoseconds per element of array_<T>_sort, array_<T>_radix_sort, array_<T>_par_sort and array_<T>_par_stable_sort
+ * (on every online processor), next to qsort over the same data.
+ *
+ * Element types:
+ * 	u64   - uint64_t
+ * 	f64   - double
+ * 	rec16 - A 16 byte record sorted by its uint64_t key
+ *
+ * Patterns:
+ * 	random - Uniformly random values
+ * 	sorted - Already in order
+ * 	few    - 16 distinct values in random order
+ *
+ * Every type and pattern runs for 1K elements up to --max elements (by default 16M) in steps of 4x. The data is
+ * generated again before every run, outside of the timing.
+ *
+ * Usage:
+ * 	bench_sort [--max <count>] [--reps <count>] > sort.csv
+ *
+ * Output columns:
+ * 	type,size,pattern,algorithm,ns_per_element
+ */
+
+#include "bench.h"
+
+#define BENCH_SORT_FEW_VALUES 16u
+
+enum bench_sort_pattern
+{
+	BENCH_SORT_RANDOM,
+	BENCH_SORT_SORTED,
+	BENCH_SORT_FEW,
+	BENCH_SORT_PATTERNS
+};
+
+static const char* const bench_sort_pattern_names[BENCH_SORT_PATTERNS] = {"random", "sorted", "few"};
+
+enum bench_sort_algo
+{
+	BENCH_SORT_ARRAY,
+	BENCH_SORT_RADIX,
+	BENCH_SORT_PARALLEL,
+	BENCH_SORT_PARALLEL_STABLE,
+	BENCH_SORT_QSORT,
+	BENCH_SORT_ALGOS
+};
+
+static const char* const bench_sort_algo_names[BENCH_SORT_ALGOS] = {"sort", "radix_sort", "par_sort",
+	"par_stable_sort", "qsort"};
+
+struct bench_rec16
+{
+	uint64_t key;
+	uint64_t payload;
+};
+
+
+static int
+bench_u64_compare(const void* left, const void* right)
+{
+	const uint64_t l = *(const uint64_t*)left;
+	const uint64_t r = *(const uint64_t*)right;
+	return (l > r) - (l < r);
+}
+
+static int
+bench_f64_compare(const void* left, const void* right)
+{
+	const double l = *(const double*)left;
+	const double r = *(const double*)right;
+	return (l > r) - (l < r);
+}
+
+static int
+bench_rec16_compare(const void* left, const void* right)
+{
+	const uint64_t l = ((const struct bench_rec16*)left)->key;
+	const uint64_t r = ((const struct bench_rec16*)right)->key;
+	return (l > r) - (l < r);
+}
+
+static inline struct bench_rec16
+bench_rec16_make(const uint64_t key)
+{
+	struct bench_rec16 rec;
+	rec.key = key;
+	rec.payload = ~key;
+	return rec;
+}
+
+
+#define TL_THREADS
+#define TL_NO_ZERO_MEM
+#define array_cmpfn(left, right) (((left) > (right)) - ((left) < (right)))
+#define array_radix_keyfn(element) (element)
+#define TL_T uint64_t
+#define TL_NAME u64
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define array_cmpfn(left, right) (((left) > (right)) - ((left) < (right)))
+#define array_radix_keyfn(element) tlradix_key_f64((element))
+#define TL_T double
+#define TL_NAME f64
+#include "array.h"
+
+#define TL_NO_ZERO_MEM
+#define array_cmpfn(left, right) (((left).key > (right).key) - ((left).key < (right).key))
+#define array_radix_keyfn(element) ((element).key)
+#define TL_T struct bench_rec16
+#define TL_NAME rec16
+#include "array.h"
+
+
+#define BENCH_NAME u64
+#define BENCH_T uint64_t
+#define BENCH_GEN(value) (value)
+#define BENCH_QCMP bench_u64_compare
+#include "bench_sort_ops.h"
+
+#define BENCH_NAME f64
+#define BENCH_T double
+#define BENCH_GEN(value) ((double)(int64_t)(value) * 0x1p-32)
+#define BENCH_QCMP bench_f64_compare
+#include "bench_sort_ops.h"
+
+#define BENCH_NAME rec16
+#define BENCH_T struct bench_rec16
+#define BENCH_GEN(value) bench_rec16_make(value)
+#define BENCH_QCMP bench_rec16_compare
+#include "bench_sort_ops.h"
+
+
+int
+main(int argc, char** argv)
+{
+	struct bench_options opts = {(size_t)1u << 24u, 3u, 0u};
+	if (bench_parse_options(&opts, argc, argv) != 0)
+		return 1;
+
+	printf("type,size,pattern,algorithm,ns_per_element\n");
+	for (size_t count = BENCH_MIN_SIZE; count <= opts.max_size; count <<= 2u) {
+		fprintf(stderr, "%zu elements\n", count);
+		bench_sort_u64(&opts, "u64", count);
+		bench_sort_f64(&opts, "f64", count);
+		bench_sort_rec16(&opts, "rec16", count);
+		fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * The sort workloads, generated for one array.h instantiation with array_cmpfn, array_radix_keyfn and TL_THREADS. The
+ * defines are consumed by the #include.
+ *
+ * Generates:
+ * 	void bench_sort_<BENCH_NAME>(const struct bench_options* opts, const char* type, size_t count)
+ *
+ * Note:
+ * -Must define BENCH_NAME to the TL_NAME of the array
+ * -Must define BENCH_T to the element type of the array
+ * -Must define BENCH_GEN(value) to build an element from a uint64_t
+ * -Must define BENCH_QCMP to the qsort comparator matching array_cmpfn
+ */
+
+#ifndef BENCH_NAME
+#error "BENCH_NAME not defined for bench_sort_ops.h"
+#endif
+
+#ifndef BENCH_T
+#error "BENCH_T not defined for bench_sort_ops.h"
+#endif
+
+#ifndef BENCH_GEN
+#error "BENCH_GEN not defined for bench_sort_ops.h"
+#endif
+
+#ifndef BENCH_QCMP
+#error "BENCH_QCMP not defined for bench_sort_ops.h"
+#endif
+
+#define _BPFX TLSYMBOL(array, BENCH_NAME)
+#define _BFN(name) TLSYMBOL(TLSYMBOL(bench_sort, BENCH_NAME), name)
+
+/**
+ * fill is for internal use only
+ * Reset the array to count elements of the given pattern.
+ */
+static inline void
+_BFN(fill)(struct _BPFX* a, const size_t count, const enum bench_sort_pattern pattern)
+{
+	a->size = count;
+	for (size_t i = 0; i < count; i++) {
+		uint64_t value;
+		switch (pattern) {
+		case BENCH_SORT_SORTED:
+			value = i;
+			break;
+		case BENCH_SORT_FEW:
+			value = bench_mix64(i) % BENCH_SORT_FEW_VALUES;
+			break;
+		default:
+			value = bench_mix64(i);
+			break;
+		}
+		a->data[i] = BENCH_GEN(value);
+	}
+}
+
+/**
+ * run is for internal use only
+ * Time one sort of count elements.
+ * @return The nanoseconds per element
+ */
+static inline double
+_BFN(run)(struct _BPFX* a, const size_t count, const enum bench_sort_pattern pattern, const enum bench_sort_algo algo)
+{
+	_BFN(fill)(a, count, pattern);
+
+	const uint64_t start = bench_now();
+	switch (algo) {
+	case BENCH_SORT_RADIX:
+		if (TLSYMBOL(_BPFX, radix_sort)(a) != TLOK)
+			return -1.0;
+		break;
+	case BENCH_SORT_PARALLEL:
+		TLSYMBOL(_BPFX, par_sort)(a, 0u);
+		break;
+	case BENCH_SORT_PARALLEL_STABLE:
+		if (TLSYMBOL(_BPFX, par_stable_sort)(a, 0u) != TLOK)
+			return -1.0;
+		break;
+	case BENCH_SORT_QSORT:
+		qsort(a->data, a->size, sizeof(BENCH_T), &BENCH_QCMP);
+		break;
+	default:
+		TLSYMBOL(_BPFX, sort)(a);
+		break;
+	}
+	const uint64_t elapsed = bench_now() - start;
+
+	bench_sink += ((const unsigned char*)&a->data[count / 2])[0];
+	return (double)elapsed / (double)count;
+}
+
+/**
+ * bench_sort_<BENCH_NAME>
+ * Run every algorithm over every pattern of count elements, reporting the fastest of opts->reps runs of each.
+ *
+ * @param opts The benchmark options
+ * @param type The name of the element type, for the report
+ * @param count The number of elements
+ */
+static inline void
+TLSYMBOL(bench_sort, BENCH_NAME)(const struct bench_options* opts, const char* type, const size_t count)
+{
+	struct _BPFX a;
+	if (TLSYMBOL(_BPFX, init_all)(&a, count, 2.0f) != TLOK) {
+		fprintf(stderr, "%s: out of memory at %zu elements\n", type, count);
+		return;
+	}
+
+	for (int pattern = 0; pattern < BENCH_SORT_PATTERNS; pattern++) {
+		for (int algo = 0; algo < BENCH_SORT_ALGOS; algo++) {
+			double best = -1.0;
+			for (size_t rep = 0; rep < opts->reps; rep++) {
+				const double ns = _BFN(run)(&a, count, (enum bench_sort_pattern)pattern, (enum bench_sort_algo)algo);
+				if (best < 0.0 || ns < best)
+					best = ns;
+			}
+			printf("%s,%zu,%s,%s,%.2f\n", type, count, bench_sort_pattern_names[pattern],
+				bench_sort_algo_names[algo], best);
+		}
+	}
+
+	TLSYMBOL(_BPFX, deinit)(&a);
+}
+
+#undef _BFN
+#undef _BPFX
+#undef BENCH_QCMP
+#undef BENCH_GEN
+#undef BENCH_T
+#undef BENCH_NAME
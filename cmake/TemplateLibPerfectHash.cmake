@@ -0,0 +1,32 @@
+#
+# tl_perfect_hash(<target> NAME <name> KEYS <keys file> [VALUE_TYPE <type>])
+#
+# Generates phash_<name>.h from a key list with tl_phgen at build time and makes it includable by <target>. See
+# tools/phgen.c for the key file format and the generated symbols.
+#
+function(tl_perfect_hash TARGET)
+	cmake_parse_arguments(PHASH "" "NAME;KEYS;VALUE_TYPE" "" ${ARGN})
+
+	if(NOT PHASH_NAME OR NOT PHASH_KEYS)
+		message(FATAL_ERROR "tl_perfect_hash requires NAME and KEYS")
+	endif()
+	if(NOT TARGET tl_phgen)
+		message(FATAL_ERROR "tl_perfect_hash requires the tl_phgen tool (enable TL_TOOLS)")
+	endif()
+
+	get_filename_component(PHASH_KEYS "${PHASH_KEYS}" ABSOLUTE)
+	set(PHASH_DIR "${CMAKE_CURRENT_BINARY_DIR}/tl_generated")
+	set(PHASH_HEADER "${PHASH_DIR}/phash_${PHASH_NAME}.h")
+
+	add_custom_command(
+		OUTPUT "${PHASH_HEADER}"
+		COMMAND ${CMAKE_COMMAND} -E make_directory "${PHASH_DIR}"
+		COMMAND tl_phgen "${PHASH_NAME}" "${PHASH_KEYS}" "${PHASH_HEADER}" ${PHASH_VALUE_TYPE}
+		DEPENDS tl_phgen "${PHASH_KEYS}"
+		COMMENT "Generating perfect hash phash_${PHASH_NAME}.h"
+		VERBATIM
+	)
+
+	target_sources(${TARGET} PRIVATE "${PHASH_HEADER}")
+	target_include_directories(${TARGET} PRIVATE "${PHASH_DIR}")
+endfunction()
@@ -3,6 +3,15 @@
  *
  * Options:
  * Define TL_NO_ZERO_MEM to prevent zeroing of memory when not necessary for array to function.
+ * Define TL_HUGE_PAGES to back large arrays with huge pages (see private/allocator.h).
+ * Define array_cmpfn(left, right) to a qsort style comparison of two elements to generate array_<TL_NAME>_sort and
+ * the searches of sorted arrays (lower_bound, upper_bound, equal_range, contains_sorted and insert_sorted).
+ * Define array_radix_keyfn(element) to the uint64_t sort key of an element to generate array_<TL_NAME>_radix_sort.
+ * Define TL_THREADS (and link pthreads) along with array_cmpfn to generate array_<TL_NAME>_par_sort and
+ * array_<TL_NAME>_par_stable_sort, which sort arrays of at least TL_ARRAY_PARALLEL_THRESHOLD elements on multiple
+ * threads.
+ * Define TL_ARRAY_PFX to the full symbol prefix to use instead of array_<TL_NAME>. TL_NAME and TL_NO_ZERO_MEM are then
+ * left defined, which lets another template (see indexmap.h) instantiate an array for itself.
  *
  * Note:
  * All defined are consumed by array.h and will need to be redefined if including again, or including another template.
@@ -39,6 +48,14 @@
 
 #include "private/common.h"
 
+#ifdef TL_THREADS
+#include "private/threads.h"
+
+#ifndef TL_ARRAY_PARALLEL_THRESHOLD
+#define TL_ARRAY_PARALLEL_THRESHOLD 100000u
+#endif
+#endif
+
 #ifndef TL_T
 #error "TL_T macro is required for array.h. Define to a type of choice"
 #endif
@@ -47,15 +64,21 @@
  * note that this will not work with structs or enums unless they're typedef'd. Hence why this
  * is optionally provided
  */
+#ifndef TL_ARRAY_PFX
 #ifndef TL_NAME
 #define TL_NAME TL_T
 #endif
+#endif
 
 #define TLARRAY_DEFAULT_CAPACITY 20
 #define TLARRAY_DEFAULT_GROW_FACTOR 2.0f
 
 
+#ifdef TL_ARRAY_PFX
+#define _PFX TL_ARRAY_PFX
+#else
 #define _PFX TLSYMBOL(array, TL_NAME)
+#endif
 
 struct _PFX
 {
@@ -77,12 +100,12 @@ struct _PFX
  * 	TLOK on initialization success
  */
 static inline enum tl_status
-TLSYMBOL(_PFX, init_all)(struct _PFX* a, const size_t capacity, const size_t grow_factor)
+TLSYMBOL(_PFX, init_all)(struct _PFX* a, const size_t capacity, const float grow_factor)
 {
 	assert(a != NULL);
 	assert(capacity > 1);
 	assert(grow_factor > 1.0f);
-	TL_T* tmp = tlmalloc(capacity * sizeof(TL_T));
+	TL_T* tmp = tlmalloc_large(capacity * sizeof(TL_T));
 	if (!tmp) return TL_ERR_MEM;
 
 	a->capacity = capacity;
@@ -130,13 +153,14 @@ TLSYMBOL(_PFX, deinit)(struct _PFX* a)
 {
 	assert(a != NULL);
 	assert(a->data != NULL);
+	const size_t bytes = a->capacity * sizeof(TL_T);
 #ifndef TL_NO_ZERO_MEM
 	tlmemset(a->data, TL_INIT_VAL, a->size * sizeof(TL_T));
 	a->capacity = 0;
 	a->size = 0;
 	a->grow_factor = 0.0f;
 #endif
-	tlfree(a->data);
+	tlfree_large(a->data, bytes);
 	a->data = NULL;
 }
 
@@ -237,7 +261,7 @@ TLSYMBOL(_PFX, grow)(struct _PFX* a)
 	if (new_capacity == old_capacity) new_capacity += 10;
 	if (new_capacity < old_capacity) return TL_ERR_MEM;
 
-	TL_T* tmp = tlrealloc(a->data, new_capacity * sizeof(TL_T));
+	TL_T* tmp = tlrealloc_large(a->data, old_capacity * sizeof(TL_T), new_capacity * sizeof(TL_T));
 	if (!tmp) return TL_ERR_MEM;
 
 #ifndef TL_NO_ZERO_MEM
@@ -249,6 +273,44 @@ TLSYMBOL(_PFX, grow)(struct _PFX* a)
 }
 
 
+/**
+ * array_<TL_NAME>_grow_n
+ * This function should normally not be called by a user.
+ *
+ * Grow the backing array once so that it can hold count more elements. The new capacity is the larger of
+ * (a->capacity * a->grow_factor) and (a->size + count), so a stream of bulk appends stays amortized like append.
+ *
+ * OPTIONS:
+ * -Define TL_NO_ZERO_MEM to stop initializing of the new portion of the backing array to 0.
+ *
+ * @param a The array to resize the backing memory allocation.
+ * @param count The number of elements that must fit after a->size.
+ * @return
+ * 	TL_ERR_MEM if the required capacity overflows or the reallocation fails
+ * 	TLOK on success, including when the array already had the room
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, grow_n)(struct _PFX* a, const size_t count)
+{
+	if (count <= a->capacity - a->size) return TLOK;
+	if (count > SIZE_MAX / sizeof(TL_T) - a->size) return TL_ERR_MEM;
+
+	const size_t needed = a->size + count;
+	size_t new_capacity = a->capacity * a->grow_factor;
+	if (new_capacity < needed) new_capacity = needed;
+
+	TL_T* tmp = tlrealloc_large(a->data, a->capacity * sizeof(TL_T), new_capacity * sizeof(TL_T));
+	if (!tmp) return TL_ERR_MEM;
+
+#ifndef TL_NO_ZERO_MEM
+	memset(tmp + a->capacity, TL_INIT_VAL, (new_capacity - a->capacity) * sizeof(TL_T));
+#endif
+	a->data = tmp;
+	a->capacity = new_capacity;
+	return TLOK;
+}
+
+
 
 
 /**
@@ -283,6 +345,109 @@ TLSYMBOL(_PFX, append)(struct _PFX* a, TL_T element)
 }
 
 
+/**
+ * array_<TL_NAME>_append_n
+ * Add count elements to the end of the array, copied from elements. The backing array is grown at most once and the
+ * elements are copied with a single memcpy, which beats count calls to append for bulk loads.
+ *
+ * OPTIONS:
+ * Define TL_NO_ZERO_MEM to prevent zeroing memory at end of array if it grows.
+ *
+ * NOTE:
+ * -elements may point into the array itself, the range is located again after a reallocation.
+ *
+ * @param a The array_<TL_NAME> to add the elements to.
+ * @param elements The elements to add, may be NULL if count is 0.
+ * @param count The number of elements to add.
+ * @return
+ * 	TL_ERR_MEM if the elements could not be added (reallocation failed), the array is left unchanged
+ * 	TLOK on success
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, append_n)(struct _PFX* a, const TL_T* elements, const size_t count)
+{
+	assert(a != NULL);
+	assert(a->data != NULL);
+	assert(elements != NULL || count == 0);
+
+	if (count == 0) return TLOK;
+
+	/* compare the addresses as integers, relational operators on unrelated pointers are undefined */
+	const uintptr_t from = (uintptr_t)elements;
+	const uintptr_t base = (uintptr_t)a->data;
+	const int inside = (from >= base && from < base + a->size * sizeof(TL_T));
+	const size_t offset = (size_t)(from - base) / sizeof(TL_T);
+
+	if (TLSYMBOL(_PFX, grow_n)(a, count) != TLOK) {
+		return TL_ERR_MEM;
+	}
+	if (inside) elements = a->data + offset;
+
+	memcpy(a->data + a->size, elements, count * sizeof(TL_T));
+	a->size += count;
+	return TLOK;
+}
+
+
+/**
+ * array_<TL_NAME>_extend
+ * Add every element of other to the end of the array, see array_<TL_NAME>_append_n.
+ *
+ * OPTIONS:
+ * Define TL_NO_ZERO_MEM to prevent zeroing memory at end of array if it grows.
+ *
+ * NOTE:
+ * -other may be a itself, which doubles the array.
+ *
+ * @param a The array_<TL_NAME> to add the elements to.
+ * @param other The array_<TL_NAME> to copy the elements from.
+ * @return
+ * 	TL_ERR_MEM if the elements could not be added (reallocation failed), the array is left unchanged
+ * 	TLOK on success
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, extend)(struct _PFX* a, const struct _PFX* other)
+{
+	assert(other != NULL);
+	return TLSYMBOL(_PFX, append_n)(a, other->data, other->size);
+}
+
+
+/**
+ * array_<TL_NAME>_append_fill
+ * Add count copies of element to the end of the array. The backing array is grown at most once and the copies are
+ * written by a single loop without any capacity check, which the compiler turns into a memset or vector stores.
+ *
+ * OPTIONS:
+ * Define TL_NO_ZERO_MEM to prevent zeroing memory at end of array if it grows.
+ *
+ * @param a The array_<TL_NAME> to add the elements to.
+ * @param element The element to add count times.
+ * @param count The number of copies to add.
+ * @return
+ * 	TL_ERR_MEM if the elements could not be added (reallocation failed), the array is left unchanged
+ * 	TLOK on success
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, append_fill)(struct _PFX* a, TL_T element, const size_t count)
+{
+	assert(a != NULL);
+	assert(a->data != NULL);
+
+	if (count == 0) return TLOK;
+	if (TLSYMBOL(_PFX, grow_n)(a, count) != TLOK) {
+		return TL_ERR_MEM;
+	}
+
+	TL_T* dst = a->data + a->size;
+	for (size_t i = 0; i < count; i++) {
+		dst[i] = element;
+	}
+	a->size += count;
+	return TLOK;
+}
+
+
 /**
  * array_<TL_NAME>_push
  * Add an element to the front of the array, moving all other elements over by one slot. If the backing array is too
@@ -501,7 +666,7 @@ TLSYMBOL(_PFX, shrink_to_fit)(struct _PFX* a)
 	assert(a != NULL);
 	assert(a->data != NULL);
 	assert(a->size > 0);
-	TL_T *ptr = tlrealloc(a->data, a->size * sizeof(TL_T));
+	TL_T *ptr = tlrealloc_large(a->data, a->capacity * sizeof(TL_T), a->size * sizeof(TL_T));
 	if (!ptr) return TL_ERR_MEM;
 
 	a->data = ptr;
@@ -531,7 +696,7 @@ TLSYMBOL(_PFX, ensure_capacity)(struct _PFX* a, size_t capacity)
 	if (capacity <= a->capacity) {
 		return 1;
 	}
-	TL_T* ptr = tlrealloc(a->data, capacity * sizeof(TL_T));
+	TL_T* ptr = tlrealloc_large(a->data, a->capacity * sizeof(TL_T), capacity * sizeof(TL_T));
 	if (!ptr) return TL_ERR_MEM;
 
 #ifndef TL_NO_ZERO_MEM
@@ -568,9 +733,1097 @@ TLSYMBOL(_PFX, clear)(struct _PFX* a)
 
 
 
+#ifdef array_cmpfn
+
+#define TLARRAY_SORT_INSERTION 24
+#define TLARRAY_SORT_NINTHER 128
+#define TLARRAY_SORT_PARTIAL_MOVES 8
+#define TLARRAY_SORT_BLOCK 64
+#define TLARRAY_SORT_BLOCK_BYTES 16
+#define _TLSORT_LESS(left, right) (array_cmpfn((left), (right)) < 0)
+
+/**
+ * sort_swap is for internal use only
+ * Exchange two elements.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_swap)(TL_T* left, TL_T* right)
+{
+	TL_T tmp = *left;
+	*left = *right;
+	*right = tmp;
+}
+
+/**
+ * sort_cswap is for internal use only
+ * Compare and exchange, leaving the smaller element in left. The building block of the sorting networks.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_cswap)(TL_T* left, TL_T* right)
+{
+	if (_TLSORT_LESS(*right, *left)) {
+		TLSYMBOL(_PFX, sort_swap)(left, right);
+	}
+}
+
+/**
+ * sort3 is for internal use only
+ * Sort three elements in place so that *x <= *y <= *z.
+ */
+static inline void
+TLSYMBOL(_PFX, sort3)(TL_T* x, TL_T* y, TL_T* z)
+{
+	TLSYMBOL(_PFX, sort_cswap)(x, y);
+	TLSYMBOL(_PFX, sort_cswap)(y, z);
+	TLSYMBOL(_PFX, sort_cswap)(x, y);
+}
+
+/**
+ * sort_network is for internal use only
+ * Sort at most 5 elements with an optimal sorting network, a fixed sequence of compare and exchanges.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_network)(TL_T* d, const size_t count)
+{
+	switch (count) {
+	case 2:
+		TLSYMBOL(_PFX, sort_cswap)(d, d + 1);
+		break;
+	case 3:
+		TLSYMBOL(_PFX, sort3)(d, d + 1, d + 2);
+		break;
+	case 4:
+		TLSYMBOL(_PFX, sort_cswap)(d, d + 1);
+		TLSYMBOL(_PFX, sort_cswap)(d + 2, d + 3);
+		TLSYMBOL(_PFX, sort_cswap)(d, d + 2);
+		TLSYMBOL(_PFX, sort_cswap)(d + 1, d + 3);
+		TLSYMBOL(_PFX, sort_cswap)(d + 1, d + 2);
+		break;
+	case 5:
+		TLSYMBOL(_PFX, sort_cswap)(d, d + 1);
+		TLSYMBOL(_PFX, sort_cswap)(d + 3, d + 4);
+		TLSYMBOL(_PFX, sort_cswap)(d + 2, d + 4);
+		TLSYMBOL(_PFX, sort_cswap)(d + 2, d + 3);
+		TLSYMBOL(_PFX, sort_cswap)(d, d + 3);
+		TLSYMBOL(_PFX, sort_cswap)(d, d + 2);
+		TLSYMBOL(_PFX, sort_cswap)(d + 1, d + 4);
+		TLSYMBOL(_PFX, sort_cswap)(d + 1, d + 3);
+		TLSYMBOL(_PFX, sort_cswap)(d + 1, d + 2);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * sort_insertion is for internal use only
+ * Insertion sort [begin, end). When unguarded, the element before begin must not be greater than any element of the
+ * range, which lets the inner loop drop its bounds check.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_insertion)(TL_T* begin, TL_T* end, const int unguarded)
+{
+	for (TL_T* cur = begin + 1; cur < end; cur++) {
+		if (!_TLSORT_LESS(*cur, *(cur - 1)))
+			continue;
+
+		TL_T tmp = *cur;
+		TL_T* sift = cur;
+		do {
+			*sift = *(sift - 1);
+			sift--;
+		} while ((unguarded || sift != begin) && _TLSORT_LESS(tmp, *(sift - 1)));
+		*sift = tmp;
+	}
+}
+
+/**
+ * sort_partial_insertion is for internal use only
+ * Insertion sort [begin, end) giving up after TLARRAY_SORT_PARTIAL_MOVES displaced elements.
+ * @return 1 if the range is now sorted, otherwise 0
+ */
+static inline int
+TLSYMBOL(_PFX, sort_partial_insertion)(TL_T* begin, TL_T* end)
+{
+	size_t moves = 0;
+	for (TL_T* cur = begin + 1; cur < end; cur++) {
+		if (!_TLSORT_LESS(*cur, *(cur - 1)))
+			continue;
+
+		TL_T tmp = *cur;
+		TL_T* sift = cur;
+		do {
+			*sift = *(sift - 1);
+			sift--;
+		} while (sift != begin && _TLSORT_LESS(tmp, *(sift - 1)));
+		*sift = tmp;
+		moves += (size_t)(cur - sift);
+		if (moves > TLARRAY_SORT_PARTIAL_MOVES)
+			return cur + 1 == end;
+	}
+	return 1;
+}
+
+/**
+ * sort_heap is for internal use only
+ * Heapsort [begin, begin + count), the O(n log n) fallback when the partitions keep coming out unbalanced.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_heap)(TL_T* begin, const size_t count)
+{
+	for (size_t end = count, i = count / 2; end > 1;) {
+		if (i > 0) {
+			i--;
+		} else {
+			end--;
+			TLSYMBOL(_PFX, sort_swap)(begin, begin + end);
+		}
+
+		TL_T tmp = begin[i];
+		size_t parent = i;
+		size_t child = 2 * parent + 1;
+		while (child < end) {
+			if (child + 1 < end && _TLSORT_LESS(begin[child], begin[child + 1]))
+				child++;
+			if (!_TLSORT_LESS(tmp, begin[child]))
+				break;
+			begin[parent] = begin[child];
+			parent = child;
+			child = 2 * parent + 1;
+		}
+		begin[parent] = tmp;
+	}
+}
+
+/**
+ * sort_partition_right is for internal use only
+ * Partition [begin, end) around the pivot *begin: elements less than the pivot go left of it, the others right. The
+ * range must hold an element not less than the pivot after begin (the pivot selection guarantees it).
+ * @return The final position of the pivot, *already is set when no element had to move
+ */
+static inline TL_T*
+TLSYMBOL(_PFX, sort_partition_right)(TL_T* begin, TL_T* end, int* already)
+{
+	TL_T pivot = *begin;
+	TL_T* first = begin;
+	TL_T* last = end;
+
+	/* array_cmpfn may expand its arguments more than once, so the pointers move outside of it */
+	do {
+		first++;
+	} while (_TLSORT_LESS(*first, pivot));
+	if (first - 1 == begin) {
+		while (first < last) {
+			last--;
+			if (_TLSORT_LESS(*last, pivot))
+				break;
+		}
+	} else {
+		do {
+			last--;
+		} while (!_TLSORT_LESS(*last, pivot));
+	}
+
+	*already = first >= last;
+	while (first < last) {
+		TLSYMBOL(_PFX, sort_swap)(first, last);
+		do {
+			first++;
+		} while (_TLSORT_LESS(*first, pivot));
+		do {
+			last--;
+		} while (!_TLSORT_LESS(*last, pivot));
+	}
+
+	TL_T* pivot_pos = first - 1;
+	*begin = *pivot_pos;
+	*pivot_pos = pivot;
+	return pivot_pos;
+}
+
+/**
+ * sort_swap_offsets is for internal use only
+ * Exchange the num elements at left + offsets_l[i] with those at right - offsets_r[i]. Unless the two blocks hold the
+ * same count, a cyclic permutation is used instead, which moves every element once instead of swapping.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_swap_offsets)(TL_T* left, TL_T* right, const unsigned char* offsets_l,
+	const unsigned char* offsets_r, const size_t num, const int use_swaps)
+{
+	if (use_swaps) {
+		for (size_t i = 0; i < num; i++) {
+			TLSYMBOL(_PFX, sort_swap)(left + offsets_l[i], right - offsets_r[i]);
+		}
+	} else if (num > 0) {
+		TL_T* l = left + offsets_l[0];
+		TL_T* r = right - offsets_r[0];
+		TL_T tmp = *l;
+		*l = *r;
+		for (size_t i = 1; i < num; i++) {
+			l = left + offsets_l[i];
+			*r = *l;
+			r = right - offsets_r[i];
+			*l = *r;
+		}
+		*r = tmp;
+	}
+}
+
+/**
+ * sort_partition_blocks is for internal use only
+ * sort_partition_right for small elements, after BlockQuicksort: the comparisons of a block of
+ * TLARRAY_SORT_BLOCK elements from each end are turned into offsets without any branch, then the misplaced elements
+ * are swapped. This avoids the branch mispredictions that dominate the partitioning of random data.
+ * @return The final position of the pivot, *already is set when no element had to move
+ */
+static inline TL_T*
+TLSYMBOL(_PFX, sort_partition_blocks)(TL_T* begin, TL_T* end, int* already)
+{
+	TL_T pivot = *begin;
+	TL_T* first = begin;
+	TL_T* last = end;
+
+	do {
+		first++;
+	} while (_TLSORT_LESS(*first, pivot));
+	if (first - 1 == begin) {
+		while (first < last) {
+			last--;
+			if (_TLSORT_LESS(*last, pivot))
+				break;
+		}
+	} else {
+		do {
+			last--;
+		} while (!_TLSORT_LESS(*last, pivot));
+	}
+
+	*already = first >= last;
+	if (!*already) {
+		unsigned char offsets_l[TLARRAY_SORT_BLOCK];
+		unsigned char offsets_r[TLARRAY_SORT_BLOCK];
+		size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+		TLSYMBOL(_PFX, sort_swap)(first, last);
+		first++;
+		TL_T* base_l = first;
+		TL_T* base_r = last;
+
+		while (first < last) {
+			/* split the unknown elements between the blocks that need refilling */
+			const size_t num_unknown = (size_t)(last - first);
+			const size_t left_split = (num_l == 0) ? ((num_r == 0) ? num_unknown / 2 : num_unknown) : 0;
+			const size_t right_split = (num_r == 0) ? (num_unknown - left_split) : 0;
+
+			const size_t fill_l = (left_split < TLARRAY_SORT_BLOCK) ? left_split : TLARRAY_SORT_BLOCK;
+			for (size_t i = 0; i < fill_l; i++) {
+				offsets_l[num_l] = (unsigned char)i;
+				num_l += !_TLSORT_LESS(*first, pivot);
+				first++;
+			}
+			const size_t fill_r = (right_split < TLARRAY_SORT_BLOCK) ? right_split : TLARRAY_SORT_BLOCK;
+			for (size_t i = 0; i < fill_r;) {
+				last--;
+				offsets_r[num_r] = (unsigned char)++i;
+				num_r += _TLSORT_LESS(*last, pivot);
+			}
+
+			const size_t num = (num_l < num_r) ? num_l : num_r;
+			TLSYMBOL(_PFX, sort_swap_offsets)(base_l, base_r, offsets_l + start_l, offsets_r + start_r, num,
+				num_l == num_r);
+			num_l -= num;
+			num_r -= num;
+			start_l += num;
+			start_r += num;
+			if (num_l == 0) {
+				start_l = 0;
+				base_l = first;
+			}
+			if (num_r == 0) {
+				start_r = 0;
+				base_r = last;
+			}
+		}
+
+		/* one block may still hold misplaced elements, they go next to the partition boundary */
+		if (num_l) {
+			while (num_l--) {
+				last--;
+				TLSYMBOL(_PFX, sort_swap)(base_l + offsets_l[start_l + num_l], last);
+			}
+			first = last;
+		}
+		if (num_r) {
+			while (num_r--) {
+				TLSYMBOL(_PFX, sort_swap)(base_r - offsets_r[start_r + num_r], first);
+				first++;
+			}
+		}
+	}
+
+	TL_T* pivot_pos = first - 1;
+	*begin = *pivot_pos;
+	*pivot_pos = pivot;
+	return pivot_pos;
+}
+
+/**
+ * sort_partition_left is for internal use only
+ * Partition [begin, end) around the pivot *begin, keeping the elements equal to the pivot on the left. Used when the
+ * element before the range equals the pivot, so that runs of equal elements are done in a single pass.
+ * @return The final position of the pivot
+ */
+static inline TL_T*
+TLSYMBOL(_PFX, sort_partition_left)(TL_T* begin, TL_T* end)
+{
+	TL_T pivot = *begin;
+	TL_T* first = begin;
+	TL_T* last = end;
+
+	do {
+		last--;
+	} while (_TLSORT_LESS(pivot, *last));
+	if (last + 1 == end) {
+		while (first < last) {
+			first++;
+			if (_TLSORT_LESS(pivot, *first))
+				break;
+		}
+	} else {
+		do {
+			first++;
+		} while (!_TLSORT_LESS(pivot, *first));
+	}
+
+	while (first < last) {
+		TLSYMBOL(_PFX, sort_swap)(first, last);
+		do {
+			last--;
+		} while (_TLSORT_LESS(pivot, *last));
+		do {
+			first++;
+		} while (!_TLSORT_LESS(pivot, *first));
+	}
+
+	*begin = *last;
+	*last = pivot;
+	return last;
+}
+
+/**
+ * sort_loop is for internal use only
+ * Pattern defeating quicksort of [begin, end). Recurses into the smaller partition and loops on the larger one, so the
+ * stack depth stays within log2(n). Unless leftmost, the element before begin is not greater than the range.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_loop)(TL_T* begin, TL_T* end, size_t bad_allowed, int leftmost)
+{
+	for (;;) {
+		const size_t size = (size_t)(end - begin);
+		if (size <= 5) {
+			TLSYMBOL(_PFX, sort_network)(begin, size);
+			return;
+		}
+		if (size < TLARRAY_SORT_INSERTION) {
+			TLSYMBOL(_PFX, sort_insertion)(begin, end, !leftmost);
+			return;
+		}
+
+		/* move the median of 3 (or the pseudo median of 9) to begin, this leaves an element >= pivot at the end */
+		const size_t s2 = size / 2;
+		if (size > TLARRAY_SORT_NINTHER) {
+			TLSYMBOL(_PFX, sort3)(begin, begin + s2, end - 1);
+			TLSYMBOL(_PFX, sort3)(begin + 1, begin + (s2 - 1), end - 2);
+			TLSYMBOL(_PFX, sort3)(begin + 2, begin + (s2 + 1), end - 3);
+			TLSYMBOL(_PFX, sort3)(begin + (s2 - 1), begin + s2, begin + (s2 + 1));
+			TLSYMBOL(_PFX, sort_swap)(begin, begin + s2);
+		} else {
+			TLSYMBOL(_PFX, sort3)(begin + s2, begin, end - 1);
+		}
+
+		if (!leftmost && !_TLSORT_LESS(*(begin - 1), *begin)) {
+			begin = TLSYMBOL(_PFX, sort_partition_left)(begin, end) + 1;
+			continue;
+		}
+
+		int already = 0;
+		TL_T* pivot = (sizeof(TL_T) <= TLARRAY_SORT_BLOCK_BYTES)
+			? TLSYMBOL(_PFX, sort_partition_blocks)(begin, end, &already)
+			: TLSYMBOL(_PFX, sort_partition_right)(begin, end, &already);
+		const size_t left_size = (size_t)(pivot - begin);
+		const size_t right_size = (size_t)(end - (pivot + 1));
+
+		if (left_size < size / 8 || right_size < size / 8) {
+			if (--bad_allowed == 0) {
+				TLSYMBOL(_PFX, sort_heap)(begin, size);
+				return;
+			}
+			/* break up the pattern that produced the bad pivot */
+			if (left_size >= TLARRAY_SORT_INSERTION) {
+				TLSYMBOL(_PFX, sort_swap)(begin, begin + left_size / 4);
+				TLSYMBOL(_PFX, sort_swap)(pivot - 1, pivot - left_size / 4);
+			}
+			if (right_size >= TLARRAY_SORT_INSERTION) {
+				TLSYMBOL(_PFX, sort_swap)(pivot + 1, pivot + 1 + right_size / 4);
+				TLSYMBOL(_PFX, sort_swap)(end - 1, end - right_size / 4);
+			}
+		} else if (already && TLSYMBOL(_PFX, sort_partial_insertion)(begin, pivot)
+			&& TLSYMBOL(_PFX, sort_partial_insertion)(pivot + 1, end)) {
+			return;
+		}
+
+		if (left_size < right_size) {
+			TLSYMBOL(_PFX, sort_loop)(begin, pivot, bad_allowed, leftmost);
+			begin = pivot + 1;
+			leftmost = 0;
+		} else {
+			TLSYMBOL(_PFX, sort_loop)(pivot + 1, end, bad_allowed, 0);
+			end = pivot;
+		}
+	}
+}
+
+/**
+ * sort_range is for internal use only
+ * Sort count elements, allowing about log2(count) bad partitions before heapsort takes over.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_range)(TL_T* data, const size_t count)
+{
+	size_t bad_allowed = 1;
+	for (size_t n = count; n > 1; n >>= 1) {
+		bad_allowed++;
+	}
+	TLSYMBOL(_PFX, sort_loop)(data, data + count, bad_allowed, 1);
+}
+
+/**
+ * array_<TL_NAME>_sort
+ * Sort the elements of the array in ascending order of array_cmpfn. The comparison is expanded inline, unlike qsort
+ * which calls through a function pointer for every compare.
+ *
+ * The sort is a pattern defeating quicksort (introsort family): median of 3 or pseudo median of 9 pivots, a single
+ * pass for runs of equal elements, detection of already sorted partitions, insertion sort below 24 elements and
+ * sorting networks below 6. Unbalanced partitions fall back to heapsort, so the worst case is O(n log n).
+ *
+ * NOTE:
+ * -Only generated when array_cmpfn(left, right) is defined, to an expression that is negative, zero or positive
+ * 	when left is respectively less than, equal to or greater than right (like a qsort comparator, on elements).
+ * -The sort is not stable.
+ *
+ * @param a The array to sort
+ */
+static inline void
+TLSYMBOL(_PFX, sort)(struct _PFX* a)
+{
+	assert(a != NULL);
+	if (a->size < 2)
+		return;
+
+	TLSYMBOL(_PFX, sort_range)(a->data, a->size);
+}
+
+
+/**
+ * sort_search is for internal use only
+ * Branchless binary search of count sorted elements: the index of the first element not less than value (or greater
+ * than value when upper). Each step halves the range with a conditional move instead of a branch, so there is no
+ * misprediction to pay, and prefetches both midpoints the next step may probe, so the cache misses of a cold array
+ * overlap with the current step instead of following it.
+ */
+static inline size_t
+TLSYMBOL(_PFX, sort_search)(const TL_T* data, size_t count, TL_T value, const int upper)
+{
+	if (count == 0)
+		return 0;
+
+	const TL_T* base = data;
+	while (count > 1) {
+		const size_t half = count / 2;
+		TL_PREFETCH(base + (count - half) / 2);
+		TL_PREFETCH(base + half + (count - half) / 2);
+		const int right = upper ? !_TLSORT_LESS(value, base[half]) : _TLSORT_LESS(base[half], value);
+		base = right ? base + half : base;
+		count -= half;
+	}
+	const int after = upper ? !_TLSORT_LESS(value, *base) : _TLSORT_LESS(*base, value);
+	return (size_t)(base - data) + (size_t)after;
+}
+
+/**
+ * array_<TL_NAME>_lower_bound
+ * Find the first element of a sorted array that is not less than value (by array_cmpfn).
+ *
+ * NOTE:
+ * -Only generated when array_cmpfn is defined. The array must be sorted by it, see array_<TL_NAME>_sort.
+ *
+ * @param a The sorted array to search
+ * @param value The value to search for
+ * @return The index of the first element not less than value, a->size if there is none
+ */
+static inline size_t
+TLSYMBOL(_PFX, lower_bound)(const struct _PFX* a, TL_T value)
+{
+	assert(a != NULL);
+	return TLSYMBOL(_PFX, sort_search)(a->data, a->size, value, 0);
+}
+
+/**
+ * array_<TL_NAME>_upper_bound
+ * Find the first element of a sorted array that is greater than value (by array_cmpfn).
+ *
+ * NOTE:
+ * -Only generated when array_cmpfn is defined. The array must be sorted by it, see array_<TL_NAME>_sort.
+ *
+ * @param a The sorted array to search
+ * @param value The value to search for
+ * @return The index of the first element greater than value, a->size if there is none
+ */
+static inline size_t
+TLSYMBOL(_PFX, upper_bound)(const struct _PFX* a, TL_T value)
+{
+	assert(a != NULL);
+	return TLSYMBOL(_PFX, sort_search)(a->data, a->size, value, 1);
+}
+
+/**
+ * array_<TL_NAME>_equal_range
+ * Find the elements of a sorted array that compare equal to value: [*first, *last) is
+ * [array_<TL_NAME>_lower_bound, array_<TL_NAME>_upper_bound). The upper bound is only searched past the lower one.
+ *
+ * NOTE:
+ * -Only generated when array_cmpfn is defined. The array must be sorted by it, see array_<TL_NAME>_sort.
+ *
+ * @param a The sorted array to search
+ * @param value The value to search for
+ * @param first Set to the index of the first element equal to value
+ * @param last Set to the index past the last element equal to value, equal to *first when there is none
+ */
+static inline void
+TLSYMBOL(_PFX, equal_range)(const struct _PFX* a, TL_T value, size_t* first, size_t* last)
+{
+	assert(a != NULL);
+	assert(first != NULL && last != NULL);
+	*first = TLSYMBOL(_PFX, sort_search)(a->data, a->size, value, 0);
+	*last = *first + TLSYMBOL(_PFX, sort_search)(a->data + *first, a->size - *first, value, 1);
+}
+
+/**
+ * array_<TL_NAME>_contains_sorted
+ * Check whether a sorted array holds an element equal to value (by array_cmpfn) with a binary search.
+ *
+ * NOTE:
+ * -Only generated when array_cmpfn is defined. The array must be sorted by it, see array_<TL_NAME>_sort.
+ *
+ * @param a The sorted array to search
+ * @param value The value to search for
+ * @return 1 if an element equal to value exists, otherwise 0
+ */
+static inline int
+TLSYMBOL(_PFX, contains_sorted)(const struct _PFX* a, TL_T value)
+{
+	assert(a != NULL);
+	const size_t at = TLSYMBOL(_PFX, sort_search)(a->data, a->size, value, 0);
+	return at < a->size && !_TLSORT_LESS(value, a->data[at]);
+}
+
+/**
+ * array_<TL_NAME>_insert_sorted
+ * Insert value into a sorted array, after the elements equal to it, so that the array stays sorted. The elements
+ * after it move back by one, see array_<TL_NAME>_insert.
+ *
+ * NOTE:
+ * -Only generated when array_cmpfn is defined. The array must be sorted by it, see array_<TL_NAME>_sort.
+ *
+ * @param a The sorted array to insert into
+ * @param value The value to insert
+ * @return
+ * 	TL_ERR_MEM if the value could not be inserted (reallocation failed)
+ * 	TLOK on success
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, insert_sorted)(struct _PFX* a, TL_T value)
+{
+	assert(a != NULL);
+	const size_t at = TLSYMBOL(_PFX, sort_search)(a->data, a->size, value, 1);
+	return (enum tl_status)TLSYMBOL(_PFX, insert)(a, at, value);
+}
+
+
+#ifdef TL_THREADS
+
+#define TLARRAY_STABLE_RUN 32
+#define TL_ARRAY_SORT_CHUNK 0
+#define TL_ARRAY_SORT_MERGE 1
+#define TL_ARRAY_SORT_COPY 2
+
+/**
+ * sort_merge is for internal use only
+ * Merge the sorted runs [left, left_end) and [right, right_end) into out. On ties the element of the left run goes
+ * first, which keeps the merge stable.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_merge)(const TL_T* left, const TL_T* left_end, const TL_T* right, const TL_T* right_end,
+	TL_T* out)
+{
+	while (left < left_end && right < right_end) {
+		if (_TLSORT_LESS(*right, *left)) {
+			*out++ = *right++;
+		} else {
+			*out++ = *left++;
+		}
+	}
+	if (left < left_end) {
+		memcpy(out, left, (size_t)(left_end - left) * sizeof(TL_T));
+	} else if (right < right_end) {
+		memcpy(out, right, (size_t)(right_end - right) * sizeof(TL_T));
+	}
+}
+
+/**
+ * sort_merge_path is for internal use only
+ * Binary search the merge path: how many of the first k elements of the stable merge of left (left_count elements)
+ * and right (right_count elements) come from left. Lets every thread merge its own slice of the output.
+ */
+static inline size_t
+TLSYMBOL(_PFX, sort_merge_path)(const TL_T* left, const size_t left_count, const TL_T* right,
+	const size_t right_count, const size_t k)
+{
+	size_t lo = (k > right_count) ? k - right_count : 0;
+	size_t hi = (k < left_count) ? k : left_count;
+	while (lo < hi) {
+		const size_t i = lo + (hi - lo) / 2;
+		/* left[i] is among the first k when it does not come after right[k - i - 1] */
+		if (!_TLSORT_LESS(right[k - i - 1], left[i])) {
+			lo = i + 1;
+		} else {
+			hi = i;
+		}
+	}
+	return lo;
+}
+
+/**
+ * sort_stable_range is for internal use only
+ * Stable bottom up merge sort of count elements: insertion sorted runs of TLARRAY_STABLE_RUN elements, then merge
+ * passes back and forth with scratch (count elements). The result always ends in data.
+ */
+static inline void
+TLSYMBOL(_PFX, sort_stable_range)(TL_T* data, TL_T* scratch, const size_t count)
+{
+	for (size_t begin = 0; begin < count; begin += TLARRAY_STABLE_RUN) {
+		const size_t end = (count - begin < TLARRAY_STABLE_RUN) ? count : begin + TLARRAY_STABLE_RUN;
+		TLSYMBOL(_PFX, sort_insertion)(data + begin, data + end, 0);
+	}
+
+	TL_T* src = data;
+	TL_T* dst = scratch;
+	for (size_t width = TLARRAY_STABLE_RUN; width < count; width *= 2) {
+		for (size_t begin = 0; begin < count; begin += 2 * width) {
+			const size_t mid = (count - begin < width) ? count : begin + width;
+			const size_t end = (count - mid < width) ? count : mid + width;
+			if (mid < end && _TLSORT_LESS(src[mid], src[mid - 1])) {
+				TLSYMBOL(_PFX, sort_merge)(src + begin, src + mid, src + mid, src + end, dst + begin);
+			} else {
+				/* the runs are already in order (or there is no second run) */
+				memcpy(dst + begin, src + begin, (end - begin) * sizeof(TL_T));
+			}
+		}
+		TL_T* tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != data) {
+		memcpy(data, src, count * sizeof(TL_T));
+	}
+}
+
+struct TLSYMBOL(_PFX, sort_task)
+{
+	TL_T* data;
+	TL_T* scratch;
+	const size_t* bounds;
+	size_t index;
+	size_t nchunks;
+	size_t width;
+	int src_is_data;
+	int stable;
+	int phase;
+};
+
+/**
+ * sort_run is for internal use only
+ * The body of a parallel sort thread. The array is cut into nchunks chunks at bounds. First each thread sorts its
+ * chunk, then every merge round merges pairs of runs of width chunks, each thread writing the slice of the output
+ * that lies over its own chunk. The last phase copies the slice back into the array when the rounds ended in scratch.
+ */
+static inline void*
+TLSYMBOL(_PFX, sort_run)(void* arg)
+{
+	struct TLSYMBOL(_PFX, sort_task)* task = arg;
+	const size_t* bounds = task->bounds;
+	const size_t begin = bounds[task->index];
+	const size_t end = bounds[task->index + 1];
+
+	switch (task->phase) {
+	case TL_ARRAY_SORT_CHUNK:
+		if (task->stable) {
+			TLSYMBOL(_PFX, sort_stable_range)(task->data + begin, task->scratch + begin, end - begin);
+		} else {
+			TLSYMBOL(_PFX, sort_range)(task->data + begin, end - begin);
+		}
+		break;
+	case TL_ARRAY_SORT_MERGE: {
+		const TL_T* src = task->src_is_data ? task->data : task->scratch;
+		TL_T* dst = task->src_is_data ? task->scratch : task->data;
+		const size_t group = task->index / (2 * task->width) * (2 * task->width);
+		const size_t left = bounds[group];
+		const size_t mid = bounds[(group + task->width < task->nchunks) ? group + task->width : task->nchunks];
+		const size_t right = bounds[(group + 2 * task->width < task->nchunks) ? group + 2 * task->width
+			: task->nchunks];
+
+		/* the slice [begin, end) of the merge of [left, mid) and [mid, right) */
+		const size_t i0 = TLSYMBOL(_PFX, sort_merge_path)(src + left, mid - left, src + mid, right - mid,
+			begin - left);
+		const size_t i1 = TLSYMBOL(_PFX, sort_merge_path)(src + left, mid - left, src + mid, right - mid,
+			end - left);
+		TLSYMBOL(_PFX, sort_merge)(src + left + i0, src + left + i1, src + mid + (begin - left - i0),
+			src + mid + (end - left - i1), dst + begin);
+		break;
+	}
+	default:
+		memcpy(task->data + begin, task->scratch + begin, (end - begin) * sizeof(TL_T));
+		break;
+	}
+	return NULL;
+}
+
+/**
+ * sort_parallel is for internal use only
+ * Sort a on nthreads threads, see array_<TL_NAME>_par_sort.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, sort_parallel)(struct _PFX* a, size_t nthreads, const int stable)
+{
+	const size_t count = a->size;
+	if (nthreads == 0) nthreads = tl_thread_count();
+	if (nthreads > TL_MAX_THREADS) nthreads = TL_MAX_THREADS;
+	if (count < TL_ARRAY_PARALLEL_THRESHOLD) nthreads = 1;
+
+	if (!stable && nthreads == 1) {
+		TLSYMBOL(_PFX, sort_range)(a->data, count);
+		return TLOK;
+	}
+	if (count < 2)
+		return TLOK;
+
+	TL_T* scratch = tlmalloc_large(count * sizeof(TL_T));
+	if (!scratch) {
+		if (stable)
+			return TL_ERR_MEM;
+		TLSYMBOL(_PFX, sort_range)(a->data, count);
+		return TLOK;
+	}
+
+	size_t bounds[TL_MAX_THREADS + 1];
+	struct TLSYMBOL(_PFX, sort_task) tasks[TL_MAX_THREADS];
+	for (size_t i = 0; i <= nthreads; i++) {
+		bounds[i] = count / nthreads * i + ((count % nthreads) * i) / nthreads;
+	}
+	for (size_t i = 0; i < nthreads; i++) {
+		tasks[i].data = a->data;
+		tasks[i].scratch = scratch;
+		tasks[i].bounds = bounds;
+		tasks[i].index = i;
+		tasks[i].nchunks = nthreads;
+		tasks[i].width = 1;
+		tasks[i].src_is_data = 1;
+		tasks[i].stable = stable;
+		tasks[i].phase = TL_ARRAY_SORT_CHUNK;
+	}
+	tl_thread_run(nthreads, &TLSYMBOL(_PFX, sort_run), tasks, sizeof(tasks[0]));
+
+	int src_is_data = 1;
+	for (size_t width = 1; width < nthreads; width *= 2) {
+		for (size_t i = 0; i < nthreads; i++) {
+			tasks[i].width = width;
+			tasks[i].src_is_data = src_is_data;
+			tasks[i].phase = TL_ARRAY_SORT_MERGE;
+		}
+		tl_thread_run(nthreads, &TLSYMBOL(_PFX, sort_run), tasks, sizeof(tasks[0]));
+		src_is_data = !src_is_data;
+	}
+
+	if (!src_is_data) {
+		for (size_t i = 0; i < nthreads; i++) {
+			tasks[i].phase = TL_ARRAY_SORT_COPY;
+		}
+		tl_thread_run(nthreads, &TLSYMBOL(_PFX, sort_run), tasks, sizeof(tasks[0]));
+	}
+
+	tlfree_large(scratch, count * sizeof(TL_T));
+	return TLOK;
+}
+
+/**
+ * array_<TL_NAME>_par_sort
+ * Sort the elements of the array in ascending order of array_cmpfn on multiple threads. The array is cut into one
+ * chunk per thread and every chunk is sorted like array_<TL_NAME>_sort. The sorted chunks are then merged pairwise in
+ * log2(nthreads) rounds. Each round splits the output evenly between the threads, and each thread finds where its
+ * slice starts in both runs with a binary search of the merge path.
+ *
+ * The result only depends on the input and nthreads, not on the scheduling of the threads.
+ *
+ * NOTE:
+ * -Only generated when both TL_THREADS and array_cmpfn are defined
+ * -Arrays smaller than TL_ARRAY_PARALLEL_THRESHOLD (default 100000) are sorted on the calling thread
+ * -The merge needs a scratch array of a->size elements (from tlmalloc_large). Without it the array is sorted on the
+ * 	calling thread instead.
+ * -The sort is not stable, see array_<TL_NAME>_par_stable_sort
+ *
+ * @param a The array to sort
+ * @param nthreads The number of threads to use, 0 for one per online processor (at most TL_MAX_THREADS)
+ * @return
+ * 	TLOK, the array is sorted
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, par_sort)(struct _PFX* a, const size_t nthreads)
+{
+	assert(a != NULL);
+	return TLSYMBOL(_PFX, sort_parallel)(a, nthreads, 0);
+}
+
+/**
+ * array_<TL_NAME>_par_stable_sort
+ * array_<TL_NAME>_par_sort keeping equal elements in their original order. The chunks are sorted with a merge sort
+ * instead, so the result does not depend on nthreads either. With nthreads 1 (or below TL_ARRAY_PARALLEL_THRESHOLD)
+ * it is a sequential stable sort.
+ *
+ * NOTE:
+ * -Only generated when both TL_THREADS and array_cmpfn are defined
+ *
+ * @param a The array to sort
+ * @param nthreads The number of threads to use, 0 for one per online processor (at most TL_MAX_THREADS)
+ * @return
+ * 	TL_ERR_MEM if the scratch array of a->size elements could not be allocated, the array is left unchanged
+ * 	TLOK on success
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, par_stable_sort)(struct _PFX* a, const size_t nthreads)
+{
+	assert(a != NULL);
+	return TLSYMBOL(_PFX, sort_parallel)(a, nthreads, 1);
+}
+
+#undef TL_ARRAY_SORT_COPY
+#undef TL_ARRAY_SORT_MERGE
+#undef TL_ARRAY_SORT_CHUNK
+#undef TLARRAY_STABLE_RUN
+
+#endif /* TL_THREADS */
+
+#undef _TLSORT_LESS
+#undef TLARRAY_SORT_BLOCK_BYTES
+#undef TLARRAY_SORT_BLOCK
+#undef TLARRAY_SORT_PARTIAL_MOVES
+#undef TLARRAY_SORT_NINTHER
+#undef TLARRAY_SORT_INSERTION
+
+#endif /* array_cmpfn */
+
+
+#ifdef array_radix_keyfn
+
+#include "private/radix.h"
+
+#define TLARRAY_RADIX_INSERTION 64
+#define TLARRAY_RADIX_MSD ((size_t)1u << 16u)
+
+/**
+ * radix_insertion is for internal use only
+ * Stable insertion sort by radix key, for the ranges too small to pay for the histograms.
+ */
+static inline void
+TLSYMBOL(_PFX, radix_insertion)(TL_T* data, const size_t count)
+{
+	for (size_t i = 1; i < count; i++) {
+		TL_T tmp = data[i];
+		const uint64_t key = array_radix_keyfn(tmp);
+		size_t j = i;
+		while (j > 0 && key < (uint64_t)array_radix_keyfn(data[j - 1])) {
+			data[j] = data[j - 1];
+			j--;
+		}
+		data[j] = tmp;
+	}
+}
+
+/**
+ * radix_histograms is for internal use only
+ * Count the digits [0, passes) of the keys of count elements, every digit in the same pass over the elements.
+ */
+static inline void
+TLSYMBOL(_PFX, radix_histograms)(const TL_T* data, const size_t count, const unsigned passes,
+	size_t (*histograms)[TLRADIX_BUCKETS])
+{
+	memset(histograms, 0, passes * sizeof(*histograms));
+	for (size_t i = 0; i < count; i++) {
+		const uint64_t key = array_radix_keyfn(data[i]);
+		for (unsigned pass = 0; pass < passes; pass++) {
+			histograms[pass][(key >> (pass * TLRADIX_DIGIT_BITS)) & (TLRADIX_BUCKETS - 1u)]++;
+		}
+	}
+}
+
+/**
+ * radix_lsd is for internal use only
+ * LSD radix sort of count elements by the digits [0, passes) of their keys, scattering back and forth between src and
+ * dst. The digits that are the same for every element are skipped. histograms are the counts of radix_histograms and
+ * are consumed.
+ * @return src or dst, whichever holds the sorted elements
+ */
+static inline TL_T*
+TLSYMBOL(_PFX, radix_lsd)(TL_T* src, TL_T* dst, const size_t count, const unsigned passes,
+	size_t (*histograms)[TLRADIX_BUCKETS])
+{
+	const uint64_t first_key = array_radix_keyfn(src[0]);
+	for (unsigned pass = 0; pass < passes; pass++) {
+		const unsigned shift = pass * TLRADIX_DIGIT_BITS;
+		size_t* offsets = histograms[pass];
+
+		/* every element has the digit of the first one, the pass would not move anything */
+		if (offsets[(first_key >> shift) & (TLRADIX_BUCKETS - 1u)] == count)
+			continue;
+
+		size_t sum = 0;
+		for (unsigned bucket = 0; bucket < TLRADIX_BUCKETS; bucket++) {
+			const size_t bucket_count = offsets[bucket];
+			offsets[bucket] = sum;
+			sum += bucket_count;
+		}
+		for (size_t i = 0; i < count; i++) {
+			const uint64_t key = array_radix_keyfn(src[i]);
+			dst[offsets[(key >> shift) & (TLRADIX_BUCKETS - 1u)]++] = src[i];
+		}
+
+		TL_T* tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	return src;
+}
+
+/**
+ * array_<TL_NAME>_radix_sort
+ * Sort the elements of the array in ascending order of their radix key with a radix sort of 8 bit digits. Unlike
+ * array_<TL_NAME>_sort this runs in O(n) and is stable.
+ *
+ * The histograms of every digit are counted in a single pass over the array and the digits that are the same for all
+ * the elements are skipped: a 64 bit key takes at most 8 passes, keys using fewer bits (32 bit ids, small ranges)
+ * take fewer. Up to TLARRAY_RADIX_MSD elements every digit is an LSD pass over the whole array. Larger arrays are
+ * first split on their most significant digit, then each of the 256 parts is LSD sorted on the remaining digits while
+ * it is still in cache, instead of scattering the whole array over 256 far apart destinations on every pass.
+ *
+ * NOTE:
+ * -Only generated when array_radix_keyfn(element) is defined, to an expression giving the uint64_t key of element.
+ * 	Unsigned integers are their own key, private/radix.h has the keys of signed integers (tlradix_key_i64,
+ * 	tlradix_key_i32) and floats (tlradix_key_f64, tlradix_key_f32). A struct is sorted by a field by returning the key
+ * 	of the field: #define array_radix_keyfn(element) ((element).id)
+ * -The scratch array holds a->size elements and comes from tlmalloc_large.
+ *
+ * @param a The array to sort
+ * @return
+ * 	TL_ERR_MEM if the scratch array could not be allocated, the array is left unchanged
+ * 	TLOK on success
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, radix_sort)(struct _PFX* a)
+{
+	assert(a != NULL);
+	TL_T* data = a->data;
+	const size_t count = a->size;
+	if (count < TLARRAY_RADIX_INSERTION) {
+		TLSYMBOL(_PFX, radix_insertion)(data, count);
+		return TLOK;
+	}
+
+	size_t histograms[TLRADIX_PASSES][TLRADIX_BUCKETS];
+	TLSYMBOL(_PFX, radix_histograms)(data, count, TLRADIX_PASSES, histograms);
+
+	/* the passes above the most significant varying digit are all skipped */
+	const uint64_t first_key = array_radix_keyfn(data[0]);
+	unsigned passes = TLRADIX_PASSES;
+	while (passes > 0) {
+		const unsigned digit = (unsigned)(first_key >> ((passes - 1u) * TLRADIX_DIGIT_BITS)) & (TLRADIX_BUCKETS - 1u);
+		if (histograms[passes - 1u][digit] != count)
+			break;
+		passes--;
+	}
+	if (passes == 0)
+		return TLOK;
+
+	TL_T* scratch = tlmalloc_large(count * sizeof(TL_T));
+	if (!scratch) return TL_ERR_MEM;
+
+	if (count <= TLARRAY_RADIX_MSD || passes == 1) {
+		TL_T* sorted = TLSYMBOL(_PFX, radix_lsd)(data, scratch, count, passes, histograms);
+		if (sorted != data) {
+			memcpy(data, sorted, count * sizeof(TL_T));
+		}
+	} else {
+		/* split on the most significant digit into scratch, then sort each part back into place */
+		const unsigned top = passes - 1u;
+		const unsigned shift = top * TLRADIX_DIGIT_BITS;
+		size_t starts[TLRADIX_BUCKETS + 1u];
+		size_t* offsets = histograms[top];
+
+		size_t sum = 0;
+		for (unsigned bucket = 0; bucket < TLRADIX_BUCKETS; bucket++) {
+			starts[bucket] = sum;
+			sum += offsets[bucket];
+			offsets[bucket] = starts[bucket];
+		}
+		starts[TLRADIX_BUCKETS] = count;
+		for (size_t i = 0; i < count; i++) {
+			const uint64_t key = array_radix_keyfn(data[i]);
+			scratch[offsets[(key >> shift) & (TLRADIX_BUCKETS - 1u)]++] = data[i];
+		}
+
+		for (unsigned bucket = 0; bucket < TLRADIX_BUCKETS; bucket++) {
+			TL_T* part = scratch + starts[bucket];
+			TL_T* out = data + starts[bucket];
+			const size_t part_count = starts[bucket + 1u] - starts[bucket];
+			if (part_count < TLARRAY_RADIX_INSERTION) {
+				TLSYMBOL(_PFX, radix_insertion)(part, part_count);
+			} else {
+				TLSYMBOL(_PFX, radix_histograms)(part, part_count, top, histograms);
+				part = TLSYMBOL(_PFX, radix_lsd)(part, out, part_count, top, histograms);
+			}
+			if (part != out && part_count > 0) {
+				memcpy(out, part, part_count * sizeof(TL_T));
+			}
+		}
+	}
+
+	tlfree_large(scratch, count * sizeof(TL_T));
+	return TLOK;
+}
+
+#undef TLARRAY_RADIX_MSD
+#undef TLARRAY_RADIX_INSERTION
+
+#endif /* array_radix_keyfn */
+
+
 #undef _PFX
 #undef TLARRAY_DEFAULT_CAPACITY
 #undef TLARRAY_DEFAULT_GROW_FACTOR
+#ifdef TL_ARRAY_PFX
+#undef TL_ARRAY_PFX
+#else
 #undef TL_NO_ZERO_MEM
 #undef TL_NAME
+#endif
 #undef TL_T
+#undef array_cmpfn
+#undef array_radix_keyfn
@@ -14,9 +14,11 @@
  * |(1)(2)(3)(4)|(1)(2)(3)(4)|....
  * Slot 1 of a given bucket is the fastest to acquire.
  *
- * We also provide 2 hashing functions by default:
+ * We also provide 4 hashing functions by default:
  * tlhash_ntfnv1a(key)		- Hash till reaching a null terminator value (good for c strings)
  * fmap_<TL_NAME>_fnv1a(key)	- Hash for the sizeof(TL_K)
+ * tlhash_ntwy(key)		- Word at a time tlhash_ntfnv1a, much faster on anything but the shortest strings
+ * fmap_<TL_NAME>_wyhash(key)	- Word at a time fmap_<TL_NAME>_fnv1a, much faster for keys of 4 bytes or more
  *
  * If you need any other hashing behavior, it is up to the user to provide it and define fmap_hashfn(key).
  *
@@ -31,10 +33,35 @@
  * 	-Default behavior is a simple equality operator
  * -Define fmap_hashfn(key) to provide your own hashing function (must accept key type and return size_t)
  * 	-Default is provided fmap_<TL_NAME>_fnv1a
+ * -Define fmap_key_copyfn(key) and/or fmap_value_copyfn(value) to deep copy keys/values in fmap_<TL_NAME>_clone
+ * 	-Default is a shallow copy
  * -Define TL_NAME to set the provided name
  * 	-Default is to concatenate the TL_K and TL_V values
+ * -Define TL_FMAP_PFX to the full symbol prefix to use instead of fmap_<TL_NAME>. TL_NAME and TL_NO_ZERO_MEM are then
+ * 	left defined, which lets another template (see ttlcache.h) instantiate a flatmap for itself.
  * -Define TL_NO_ZERO_MEM to stop the zeroing of memory in non-critical code
  * -Define TL_KEY_IS_NT to use the provided tlhash_ntfnv1a(key) instead of fmap_<TL_NAME>_fnv1a(key)
+ * -Define TL_KEY_IS_INT when TL_K is an integer type to use the provided fmap_<TL_NAME>_fibhash(key) instead of
+ * 	fmap_<TL_NAME>_fnv1a(key), and to take the bucket from the high bits of the hash instead of the low bits.
+ * 	fmap_<TL_NAME>_murmurhash(key) is generated as well, for keys that only differ in their high bits.
+ * -Define TL_SEEDED_HASH to give every map its own random key (see tlhash_seed) and hash keys with a keyed hash, so
+ * 	that keys colliding in one map cannot be chosen in advance to force it to grow
+ * 	-Default is fmap_<TL_NAME>_siphash(key, seed), or tlhash_ntsip13(key, seed) with TL_KEY_IS_NT
+ * 	-Define fmap_seeded_hashfn(key,seed) to provide your own keyed hashing function (seed points to 2 uint64_t)
+ * -Define TL_NO_SIMD to build only the portable variant of the runtime selected SIMD kernels (see private/cpu.h)
+ * -Define TL_HUGE_PAGES to back large tables with huge pages (see private/allocator.h)
+ * -Define TL_THREADS (and link pthreads) to build tables of at least TL_FMAP_PARALLEL_THRESHOLD rows on multiple
+ * 	threads in fmap_<TL_NAME>_insert_n
+ * 	-Default threshold is 10000000
+ * -Define TL_FMAP_SMALL to a number of elements (e.g. 8) to store that many elements inline in struct fmap_<TL_NAME>.
+ * 	fmap_<TL_NAME>_init and fmap_<TL_NAME>_new then allocate nothing and the map is searched linearly without hashing
+ * 	until it grows past TL_FMAP_SMALL elements, at which point it moves to the hashed layout on the heap.
+ * 	-A map holding its elements inline points into itself. Use fmap_<TL_NAME>_clone rather than copying the struct.
+ * -Define TL_FMAP_HASH_QUALITY to generate fmap_<TL_NAME>_hash_quality, which reports how well the hash spreads a
+ * 	sample of keys over the buckets and which num_buckets and load factor to initialize the map with (see
+ * 	private/hash_quality.h, and tools/hashq.c for the same report from the command line)
+ * -Define TL_FMAP_KEY_ARRAY and/or TL_FMAP_VALUE_ARRAY to the struct name of an array.h instantiation of TL_K/TL_V
+ * 	(e.g. array_int) to generate the array column functions. The array must be included first.
  *
  *
  * Examples:
@@ -78,15 +105,21 @@
 #error "TL_V not defined for flatmap.h"
 #endif
 
+#include <stdint.h>
+
 #include "private/common.h"
 #include "private/utility.h"
 #include "private/map_slot_state.h"
+#include "private/map_scan.h"
 
+#ifdef TL_FMAP_PFX
+#define _PFX TL_FMAP_PFX
+#else
 #ifndef TL_NAME
 #define TL_NAME TLCONCAT(TL_K,TL_V)
 #endif
-
 #define _PFX TLSYMBOL(fmap,TL_NAME)
+#endif
 
 /**
  * Enable user provided key equality function
@@ -95,18 +128,55 @@
 #define fmap_key_equalsfn(left, right) (left) == (right)
 #endif
 
+#include "private/hash_algorithm.h"
+
+#ifdef TL_FMAP_HASH_QUALITY
+#include "private/hash_quality.h"
+#endif
+
 /**
  * Enable user provided hash function
  */
 #ifndef fmap_hashfn
-
-#include "private/hash_algorithm.h"
-
 #  ifdef TL_KEY_IS_NT
 #    define fmap_hashfn(key) tlhash_ntfnv1a(key)
+#  elif defined(TL_KEY_IS_INT)
+#    define fmap_hashfn(key) TLSYMBOL(_PFX,fibhash)(key)
 #  else
 #    define fmap_hashfn(key) TLSYMBOL(_PFX,fnv1a)(key)
+#    define TL_FMAP_HASH_FNV1A
+#  endif
+#endif
+
+/**
+ * The hash of a key in a map (or frozen table) owner.
+ */
+#ifdef TL_SEEDED_HASH
+#  ifndef fmap_seeded_hashfn
+#    ifdef TL_KEY_IS_NT
+#      define fmap_seeded_hashfn(key, seed) tlhash_ntsip13((key), (seed))
+#    else
+#      define fmap_seeded_hashfn(key, seed) TLSYMBOL(_PFX,siphash)((key), (seed))
+#    endif
 #  endif
+#  define TL_FMAP_HASH(owner, key) fmap_seeded_hashfn((key), (owner)->hash_seed)
+#else
+#  define TL_FMAP_HASH(owner, key) fmap_hashfn(key)
+#endif
+
+/**
+ * The number of keys hashed at once by the bulk operations
+ */
+#define TL_FMAP_HASH_BATCH 256u
+
+/**
+ * The bucket of a hash given the slot_mask. Multiplicative hashes are weak in their low bits, so integer keys take the
+ * high bits instead.
+ */
+#ifdef TL_KEY_IS_INT
+#define TL_FMAP_BUCKET(hash, mask) tlhash_high_bits((hash), (mask) + 1u)
+#else
+#define TL_FMAP_BUCKET(hash, mask) ((hash) & (mask))
 #endif
 
 /**
@@ -115,6 +185,20 @@
 #define TL_FMAP_DEFAULT_BUCKET_COUNT 8u
 #define TL_FMAP_DEFAULT_LOAD_FACTOR 70u
 
+#ifdef TL_FMAP_SMALL
+#if (TL_FMAP_SMALL) < 1
+#error "TL_FMAP_SMALL must be at least 1"
+#endif
+#endif
+
+#ifdef TL_THREADS
+#include "private/threads.h"
+
+#ifndef TL_FMAP_PARALLEL_THRESHOLD
+#define TL_FMAP_PARALLEL_THRESHOLD 10000000u
+#endif
+#endif
+
 
 /**
  * fmap_<TL_NAME>_node
@@ -136,6 +220,9 @@ struct TLSYMBOL(_PFX, node)
  * nodes       - (private) The elements
  * info        - (private) Extra information about each node location
  * load_factor - (private) The fill percentage (0-100) to target before growth
+ * hash_seed   - (private) The key of the seeded hash (TL_SEEDED_HASH only)
+ * small_nodes - (private) Inline elements, used as a single bucket until the map grows (TL_FMAP_SMALL only)
+ * small_info  - (private) Inline information about each inline element (TL_FMAP_SMALL only)
  */
 struct _PFX
 {
@@ -148,9 +235,72 @@ struct _PFX
 	struct TLSYMBOL(_PFX, node)* nodes;
 	enum tl_map_slot_state* info;
 	size_t load_factor;
+#ifdef TL_SEEDED_HASH
+	uint64_t hash_seed[2];
+#endif
+#ifdef TL_FMAP_SMALL
+	struct TLSYMBOL(_PFX, node) small_nodes[TL_FMAP_SMALL];
+	enum tl_map_slot_state small_info[TL_FMAP_SMALL];
+#endif
 };
 
 
+/**
+ * is_small is for internal use only
+ * Whether the map still holds its elements in the inline single bucket.
+ */
+static inline int
+TLSYMBOL(_PFX, is_small)(const struct _PFX* fm)
+{
+#ifdef TL_FMAP_SMALL
+	return fm->nodes == fm->small_nodes;
+#else
+	(void)fm;
+	return 0;
+#endif
+}
+
+/**
+ * hash_key is for internal use only
+ * The hash used to locate key in fm. The inline single bucket is scanned linearly, so it is not hashed at all.
+ */
+static inline size_t
+TLSYMBOL(_PFX, hash_key)(const struct _PFX* fm, TL_K key)
+{
+	if (TLSYMBOL(_PFX, is_small)(fm))
+		return 0u;
+	return TL_FMAP_HASH(fm, key);
+}
+
+/**
+ * same_buckets is for internal use only
+ * Whether every key falls in the same bucket of both maps, so that a bucket index of one is valid in the other.
+ */
+static inline int
+TLSYMBOL(_PFX, same_buckets)(const struct _PFX* left, const struct _PFX* right)
+{
+#ifdef TL_SEEDED_HASH
+	if (left->slot_mask != 0 && memcmp(left->hash_seed, right->hash_seed, sizeof(left->hash_seed)) != 0)
+		return 0;
+#endif
+	return left->slot_mask == right->slot_mask;
+}
+
+/**
+ * release is for internal use only
+ * Free a backing store unless it is the inline one.
+ */
+static inline void
+TLSYMBOL(_PFX, release)(const struct _PFX* fm, struct TLSYMBOL(_PFX, node)* nodes, enum tl_map_slot_state* info,
+	const size_t capacity)
+{
+	if (TLSYMBOL(_PFX, is_small)(fm))
+		return;
+	tlfree_large(nodes, capacity * sizeof(struct TLSYMBOL(_PFX, node)));
+	tlfree_large(info, capacity * sizeof(enum tl_map_slot_state));
+}
+
+
 /**
  * fmap_<TL_NAME>_init_all
  * Initialize a fmap_<TL_NAME> struct fields, allowing the user to provide configuration.
@@ -177,13 +327,13 @@ TLSYMBOL(_PFX, init_all)(struct _PFX* fm, const size_t num_buckets, const size_t
 	const size_t capacity = buckets * bucket_max;
 	const size_t factor = (load_factor != 0) ? load_factor : TL_FMAP_DEFAULT_LOAD_FACTOR;
 
-	struct TLSYMBOL(_PFX, node)* nodes = tlcalloc(capacity, sizeof(struct TLSYMBOL(_PFX, node)));
+	struct TLSYMBOL(_PFX, node)* nodes = tlcalloc_large(capacity, sizeof(struct TLSYMBOL(_PFX, node)));
 	if (!nodes)
 		return TL_ERR_MEM;
 
-	enum tl_map_slot_state* info = tlcalloc(capacity, sizeof(enum tl_map_slot_state));
+	enum tl_map_slot_state* info = tlcalloc_large(capacity, sizeof(enum tl_map_slot_state));
 	if (!info) {
-		tlfree(nodes);
+		tlfree_large(nodes, capacity * sizeof(struct TLSYMBOL(_PFX, node)));
 		return TL_ERR_MEM;
 	}
 
@@ -196,6 +346,9 @@ TLSYMBOL(_PFX, init_all)(struct _PFX* fm, const size_t num_buckets, const size_t
 	fm->nodes = nodes;
 	fm->info = info;
 	fm->load_factor = factor;
+#ifdef TL_SEEDED_HASH
+	tlhash_seed(fm->hash_seed, fm);
+#endif
 
 	return TLOK;
 }
@@ -207,6 +360,7 @@ TLSYMBOL(_PFX, init_all)(struct _PFX* fm, const size_t num_buckets, const size_t
  * Note:
  * -Default number of buckets is 8
  * -Default load factor is 70
+ * -With TL_FMAP_SMALL the map starts with its inline storage instead and nothing is allocated
  *
  * @param fm The fmap_<TL_NAME> to initialize
  * @return
@@ -216,7 +370,29 @@ TLSYMBOL(_PFX, init_all)(struct _PFX* fm, const size_t num_buckets, const size_t
 static inline enum tl_status
 TLSYMBOL(_PFX, init)(struct _PFX* fm)
 {
+#ifdef TL_FMAP_SMALL
+	assert(fm != NULL);
+
+	fm->num_buckets = 1u;
+	fm->bucket_max = TL_FMAP_SMALL;
+	fm->capacity = TL_FMAP_SMALL;
+	fm->load_max = TL_FMAP_SMALL;
+	fm->size = 0;
+	fm->slot_mask = 0u;
+	fm->nodes = fm->small_nodes;
+	fm->info = fm->small_info;
+	fm->load_factor = TL_FMAP_DEFAULT_LOAD_FACTOR;
+#ifdef TL_SEEDED_HASH
+	tlhash_seed(fm->hash_seed, fm);
+#endif
+	tlmemset(fm->small_info, 0, sizeof(fm->small_info));
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(fm->small_nodes, TL_INIT_VAL, sizeof(fm->small_nodes));
+#endif
+	return TLOK;
+#else
 	return TLSYMBOL(_PFX, init_all)(fm, TL_FMAP_DEFAULT_BUCKET_COUNT, TL_FMAP_DEFAULT_LOAD_FACTOR);
+#endif
 }
 
 
@@ -235,6 +411,7 @@ TLSYMBOL(_PFX, deinit)(struct _PFX* fm)
 	assert(fm != NULL);
 	assert(fm->nodes != NULL);
 	assert(fm->info != NULL);
+	const size_t capacity = fm->capacity;
 #ifndef TL_NO_ZERO_MEM
 	tlmemset(fm->nodes, TL_INIT_VAL, fm->capacity * sizeof(struct TLSYMBOL(_PFX, node)));
 	tlmemset(fm->info, TL_INIT_VAL, fm->capacity * sizeof(enum tl_map_slot_state));
@@ -246,8 +423,7 @@ TLSYMBOL(_PFX, deinit)(struct _PFX* fm)
 	fm->load_max = 0u;
 	fm->slot_mask = 0u;
 #endif
-	tlfree(fm->nodes);
-	tlfree(fm->info);
+	TLSYMBOL(_PFX, release)(fm, fm->nodes, fm->info, capacity);
 	fm->nodes = NULL;
 	fm->info = NULL;
 }
@@ -296,7 +472,16 @@ TLSYMBOL(_PFX, new_all)(const size_t num_buckets, const float load_factor)
 static inline struct _PFX*
 TLSYMBOL(_PFX, new)()
 {
+#ifdef TL_FMAP_SMALL
+	struct _PFX* tmp = tlmalloc(sizeof(struct _PFX));
+	if (!tmp)
+		return NULL;
+
+	TLSYMBOL(_PFX, init)(tmp);
+	return tmp;
+#else
 	return TLSYMBOL(_PFX, new_all)(TL_FMAP_DEFAULT_BUCKET_COUNT, TL_FMAP_DEFAULT_LOAD_FACTOR);
+#endif
 }
 
 
@@ -368,7 +553,7 @@ TLSYMBOL(_PFX, probe_key)(struct TLSYMBOL(_PFX, node)* nodes, const enum tl_map_
 
 #ifdef TL_NO_ZERO_MEM
 		if (info[bucket_index + slot] == TL_MAPSS_DELETED) {
-			if (delt_slot != bucket_capacity) delt_slot = slot;
+			if (delt_slot == bucket_capacity) delt_slot = slot;
 			continue;
 		}
 #endif
@@ -386,65 +571,99 @@ TLSYMBOL(_PFX, probe_key)(struct TLSYMBOL(_PFX, node)* nodes, const enum tl_map_
 
 /**
  * rehash is for internal use only
- * note - rehash requires new_nodes to be large enough!
+ * Returns TL_OOB when a new bucket overflows, which a map moving out of its inline storage or shrinking into fewer
+ * buckets can run into. new_nodes and new_info are then partially filled and must be discarded.
  */
-static inline void
-TLSYMBOL(_PFX, rehash)(struct TLSYMBOL(_PFX, node)* old_nodes, const enum tl_map_slot_state* old_info, const size_t old_capacity,
+static inline enum tl_status
+TLSYMBOL(_PFX, rehash)(const struct _PFX* fm, struct TLSYMBOL(_PFX, node)* old_nodes, const enum tl_map_slot_state* old_info, const size_t old_capacity,
 	struct TLSYMBOL(_PFX, node)* new_nodes, enum tl_map_slot_state* new_info, const size_t new_bucket_max, const size_t new_mask)
 {
-	for (size_t slot = 0; slot < old_capacity; slot++) {
-		if (old_info[slot] == TL_MAPSS_OCCUPIED || old_info[slot] == TL_MAPSS_COLLIDED) {
-			const size_t bucket = (fmap_hashfn(old_nodes[slot].key) & new_mask) * new_bucket_max;
+#ifndef TL_SEEDED_HASH
+	(void)fm;
+#endif
+	for (size_t base = 0; base < old_capacity; base += 64u) {
+		for (uint64_t used = tl_map_used_bits(old_info + base, old_capacity - base); used != 0; used &= used - 1u) {
+			const size_t slot = base + tl_cpu_ctz64(used);
+			const size_t bucket = TL_FMAP_BUCKET(TL_FMAP_HASH(fm, old_nodes[slot].key), new_mask) * new_bucket_max;
 			const size_t new_slot = TLSYMBOL(_PFX, probe_open)(new_info, bucket, new_bucket_max);
 			const size_t pos = bucket + new_slot;
 
+			if (new_slot == new_bucket_max)
+				return TL_OOB;
 			new_nodes[pos] = old_nodes[slot];
 			new_info[pos] = (new_slot == 0) ? TL_MAPSS_OCCUPIED : TL_MAPSS_COLLIDED;
 		}
 	}
+	return TLOK;
 }
 
 
 /**
- * fmap_<TL_NAME>_grow
- * Grows the backing memory store for the given fmap_<TL_NAME>. This function should gnerally not be called by the user
- * but it can be.
- *
- * @param fm The fmap_<TL_NAME> to grow
- * @return
- * 	TLOK when the grow is successful
- * 	TL_ERR_MEM when there is an issue acquiring new memory. The original map state is untouched.
+ * put_hashed is for internal use only
+ * Insert or replace a key/value pair whose hash is already known. Never grows and never touches fm->size.
+ * Returns TL_ENF when the key was added, TLOK when an existing value was replaced and TL_OOB when the bucket is full.
  */
 static inline enum tl_status
-TLSYMBOL(_PFX, grow)(struct _PFX* fm)
+TLSYMBOL(_PFX, put_hashed)(struct _PFX* fm, const size_t hash, TL_K key, TL_V value)
 {
-	assert(fm != NULL);
-	assert(fm->nodes != NULL);
-	assert(fm->info != NULL);
+	const size_t slot = TL_FMAP_BUCKET(hash, fm->slot_mask) * fm->bucket_max;
+	size_t slot_idx = 0;
 
-	const size_t new_buckets = fm->num_buckets << 1;
-	const size_t new_mask = new_buckets - 1;
-	const size_t new_bucket_capacity = tl_util_log2n(new_buckets);
-	const size_t new_capacity = new_buckets * new_bucket_capacity;
+	const enum tl_status status = TLSYMBOL(_PFX, probe_key)(fm->nodes, fm->info, slot, fm->bucket_max, key, &slot_idx);
+	if (status == TL_OOB)
+		return TL_OOB;
 
-	struct TLSYMBOL(_PFX, node)* new_nodes = tlcalloc(new_capacity, sizeof(struct TLSYMBOL(_PFX, node)));
-	if (!new_nodes)
-		return TL_ERR_MEM;
+	fm->nodes[slot + slot_idx].key = key;
+	fm->nodes[slot + slot_idx].value = value;
+	fm->info[slot + slot_idx] = (slot_idx == 0) ? TL_MAPSS_OCCUPIED : TL_MAPSS_COLLIDED;
+	return status;
+}
 
-	enum tl_map_slot_state* new_info = tlcalloc(new_capacity, sizeof(enum tl_map_slot_state));
-	if (!new_info) {
-		tlfree(new_nodes);
-		return TL_ERR_MEM;
-	}
 
-	TLSYMBOL(_PFX, rehash)(fm->nodes, fm->info, fm->capacity, new_nodes, new_info, new_bucket_capacity, new_mask);
+/**
+ * resize is for internal use only
+ * Rehash every element into a new backing store of new_buckets buckets (a power of 2), doubling the buckets again
+ * whenever one of them overflows. On failure the original map state is untouched.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, resize)(struct _PFX* fm, size_t new_buckets)
+{
+	size_t new_mask;
+	size_t new_bucket_capacity;
+	size_t new_capacity;
+	struct TLSYMBOL(_PFX, node)* new_nodes;
+	enum tl_map_slot_state* new_info;
+
+	for (;;) {
+		new_mask = new_buckets - 1;
+		new_bucket_capacity = tl_util_log2n(new_buckets);
+		new_capacity = new_buckets * new_bucket_capacity;
+
+		new_nodes = tlcalloc_large(new_capacity, sizeof(struct TLSYMBOL(_PFX, node)));
+		if (!new_nodes)
+			return TL_ERR_MEM;
+
+		new_info = tlcalloc_large(new_capacity, sizeof(enum tl_map_slot_state));
+		if (!new_info) {
+			tlfree_large(new_nodes, new_capacity * sizeof(struct TLSYMBOL(_PFX, node)));
+			return TL_ERR_MEM;
+		}
+
+		if (TLSYMBOL(_PFX, rehash)(fm, fm->nodes, fm->info, fm->capacity, new_nodes, new_info, new_bucket_capacity,
+			new_mask) == TLOK)
+			break;
+
+		/* a bucket overflowed, which the original store knows nothing about: start over with twice the buckets */
+		tlfree_large(new_info, new_capacity * sizeof(enum tl_map_slot_state));
+		tlfree_large(new_nodes, new_capacity * sizeof(struct TLSYMBOL(_PFX, node)));
+		new_buckets <<= 1;
+	}
 
 #ifndef TL_NO_ZERO_MEM
 	tlmemset(fm->nodes, TL_INIT_VAL, fm->capacity * sizeof(struct TLSYMBOL(_PFX, node)));
 	tlmemset(fm->info, TL_INIT_VAL, fm->capacity * sizeof(enum tl_map_slot_state));
 #endif
-	tlfree(fm->nodes);
-	tlfree(fm->info);
+	TLSYMBOL(_PFX, release)(fm, fm->nodes, fm->info, fm->capacity);
 	fm->nodes = new_nodes;
 	fm->info = new_info;
 	fm->num_buckets = new_buckets;
@@ -456,6 +675,75 @@ TLSYMBOL(_PFX, grow)(struct _PFX* fm)
 }
 
 
+/**
+ * buckets_for is for internal use only
+ * The smallest bucket count (a power of 2, at least min_buckets) whose load_max can hold count elements.
+ */
+static inline size_t
+TLSYMBOL(_PFX, buckets_for)(const size_t count, const size_t load_factor, const size_t min_buckets)
+{
+	size_t buckets = tl_util_npot(min_buckets);
+
+	while (((buckets * tl_util_log2n(buckets)) * load_factor) / 100u < count) {
+		buckets <<= 1;
+	}
+	return buckets;
+}
+
+
+/**
+ * fmap_<TL_NAME>_grow
+ * Grows the backing memory store for the given fmap_<TL_NAME>. This function should gnerally not be called by the user
+ * but it can be. A map holding its elements inline moves to the hashed layout with the default number of buckets.
+ *
+ * @param fm The fmap_<TL_NAME> to grow
+ * @return
+ * 	TLOK when the grow is successful
+ * 	TL_ERR_MEM when there is an issue acquiring new memory. The original map state is untouched.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, grow)(struct _PFX* fm)
+{
+	assert(fm != NULL);
+	assert(fm->nodes != NULL);
+	assert(fm->info != NULL);
+
+	if (TLSYMBOL(_PFX, is_small)(fm)) {
+		return TLSYMBOL(_PFX, resize)(fm,
+			TLSYMBOL(_PFX, buckets_for)(fm->capacity + 1u, fm->load_factor, TL_FMAP_DEFAULT_BUCKET_COUNT));
+	}
+	return TLSYMBOL(_PFX, resize)(fm, fm->num_buckets << 1);
+}
+
+
+/**
+ * fmap_<TL_NAME>_reserve
+ * Grow the backing memory store, at most once, so that count elements fit in the map without reaching the load factor.
+ *
+ * Note:
+ * -A bucket may still overflow and cause a grow before count is reached if the hash does not distribute uniformly.
+ *
+ * @param fm The fmap_<TL_NAME> to reserve space in
+ * @param count The total number of elements the map should be able to hold
+ * @return
+ * 	TLOK when the map can hold count elements
+ * 	TL_ERR_MEM when there is an issue acquiring new memory. The original map state is untouched.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, reserve)(struct _PFX* fm, const size_t count)
+{
+	assert(fm != NULL);
+	assert(fm->nodes != NULL);
+	assert(fm->info != NULL);
+
+	if (count <= fm->load_max)
+		return TLOK;
+
+	const size_t min_buckets = TLSYMBOL(_PFX, is_small)(fm) ? TL_FMAP_DEFAULT_BUCKET_COUNT : fm->num_buckets;
+	return TLSYMBOL(_PFX, resize)(fm, TLSYMBOL(_PFX, buckets_for)(count, fm->load_factor, min_buckets));
+}
+
+
 /**
  * fmap_<TL_NAME>_add
  * Add a new key/value pair to the given fmap_<TL_NAME> -- if the given key already exists, do nothing.
@@ -481,12 +769,12 @@ TLSYMBOL(_PFX, add)(struct _PFX* fm, TL_K key, TL_V value)
 			return TL_ERR_MEM;
 	}
 
-	const size_t hash = fmap_hashfn(key);
+	size_t hash = TLSYMBOL(_PFX, hash_key)(fm, key);
 	size_t slot;
 	size_t slot_index;
 
 	RETRY_ADD:
-	slot = hash & fm->slot_mask;
+	slot = TL_FMAP_BUCKET(hash, fm->slot_mask);
 	slot *= fm->bucket_max;
 	slot_index = 0;
 
@@ -503,6 +791,7 @@ TLSYMBOL(_PFX, add)(struct _PFX* fm, TL_K key, TL_V value)
 		if (TLSYMBOL(_PFX, grow)(fm) != TLOK)
 			return TL_ERR_MEM;
 
+		hash = TLSYMBOL(_PFX, hash_key)(fm, key);
 		goto RETRY_ADD;
 	default:
 		return TL_ERROR;
@@ -528,8 +817,8 @@ TLSYMBOL(_PFX, get)(struct _PFX* fm, TL_K key)
 	assert(fm->nodes != NULL);
 	assert(fm->info != NULL);
 
-	const size_t hash = TLSYMBOL(_PFX, fnv1a)(key);
-	const size_t bucket = hash & fm->slot_mask;
+	const size_t hash = TLSYMBOL(_PFX, hash_key)(fm, key);
+	const size_t bucket = TL_FMAP_BUCKET(hash, fm->slot_mask);
 	const size_t slot = bucket * fm->bucket_max;
 	size_t slot_idx = 0;
 
@@ -561,8 +850,8 @@ TLSYMBOL(_PFX, try_get)(struct _PFX* fm, TL_K key, TL_V* out_value)
 	assert(fm->nodes != NULL);
 	assert(fm->info != NULL);
 
-	const size_t hash = TLSYMBOL(_PFX, fnv1a)(key);
-	const size_t bucket = hash & fm->slot_mask;
+	const size_t hash = TLSYMBOL(_PFX, hash_key)(fm, key);
+	const size_t bucket = TL_FMAP_BUCKET(hash, fm->slot_mask);
 	const size_t slot = bucket * fm->bucket_max;
 	size_t slot_idx = 0;
 
@@ -599,12 +888,12 @@ TLSYMBOL(_PFX, insert)(struct _PFX* fm, TL_K key, TL_V value)
 			return TL_ERR_MEM;
 	}
 
-	const size_t hash = fmap_hashfn(key);
+	size_t hash = TLSYMBOL(_PFX, hash_key)(fm, key);
 	size_t slot;
 	size_t slot_index;
 
 	RETRY_ADD:
-	slot = hash & fm->slot_mask;
+	slot = TL_FMAP_BUCKET(hash, fm->slot_mask);
 	slot *= fm->bucket_max;
 	slot_index = 0;
 
@@ -620,6 +909,7 @@ TLSYMBOL(_PFX, insert)(struct _PFX* fm, TL_K key, TL_V value)
 		if (TLSYMBOL(_PFX, grow)(fm) != TLOK)
 			return TL_ERR_MEM;
 
+		hash = TLSYMBOL(_PFX, hash_key)(fm, key);
 		goto RETRY_ADD;
 	default:
 		return TL_ERROR;
@@ -644,8 +934,8 @@ TLSYMBOL(_PFX, erase)(struct _PFX* fm, TL_K key)
 	assert(fm->nodes != NULL);
 	assert(fm->info != NULL);
 
-	const size_t hash = fmap_hashfn(key);
-	const size_t slot = (hash & fm->slot_mask) * fm->bucket_max;
+	const size_t hash = TLSYMBOL(_PFX, hash_key)(fm, key);
+	const size_t slot = TL_FMAP_BUCKET(hash, fm->slot_mask) * fm->bucket_max;
 	size_t slot_idx = 0;
 
 	switch (TLSYMBOL(_PFX, probe_key)(fm->nodes, fm->info, slot, fm->bucket_max, key, &slot_idx)) {
@@ -691,8 +981,8 @@ TLSYMBOL(_PFX, remove)(struct _PFX* fm, TL_K key, TL_V* out_value)
 	assert(fm->nodes != NULL);
 	assert(fm->info != NULL);
 
-	const size_t hash = fmap_hashfn(key);
-	const size_t slot = (hash & fm->slot_mask) * fm->bucket_max;
+	const size_t hash = TLSYMBOL(_PFX, hash_key)(fm, key);
+	const size_t slot = TL_FMAP_BUCKET(hash, fm->slot_mask) * fm->bucket_max;
 	size_t slot_idx = 0;
 
 	switch (TLSYMBOL(_PFX, probe_key)(fm->nodes, fm->info, slot, fm->bucket_max, key, &slot_idx)) {
@@ -742,12 +1032,1222 @@ TLSYMBOL(_PFX, clear)(struct _PFX* fm)
 }
 
 
-#undef TL_FMAP_DEFAULT_LOAD_FACTOR
-#undef TL_FMAP_DEFAULT_BUCKET_COUNT
-#undef fmap_hashfn
-#undef _PFX
-#undef TL_NAME
-#undef fmap_key_equalsfn
-#undef TL_NO_ZERO_MEM
+/**
+ * fmap_<TL_NAME>_clone
+ * Initialize dst as a copy of src with the identical geometry. The backing stores are copied with a single memcpy
+ * each, so no key is hashed or probed.
+ *
+ * Options:
+ * -Define fmap_key_copyfn(key) and/or fmap_value_copyfn(value) to deep copy each key/value of the clone (for example
+ * 	strdup for string keys). They are applied to every pair after the memcpy.
+ *
+ * Note:
+ * -dst must not be initialized, or must have been deinitialized.
+ * -Without copy functions, pointer keys and values are shared between both maps.
+ *
+ * @param dst The fmap_<TL_NAME> to initialize as the copy
+ * @param src The fmap_<TL_NAME> to copy
+ * @return
+ * 	TLOK on success
+ * 	TL_ERR_MEM if there was an issue acquiring memory. dst is left uninitialized.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, clone)(struct _PFX* dst, const struct _PFX* src)
+{
+	assert(dst != NULL);
+	assert(src != NULL);
+	assert(dst != src);
+	assert(src->nodes != NULL);
+	assert(src->info != NULL);
+
+	const size_t node_bytes = src->capacity * sizeof(struct TLSYMBOL(_PFX, node));
+	const size_t info_bytes = src->capacity * sizeof(enum tl_map_slot_state);
+
+#ifdef TL_FMAP_SMALL
+	if (TLSYMBOL(_PFX, is_small)(src)) {
+		*dst = *src;
+		dst->nodes = dst->small_nodes;
+		dst->info = dst->small_info;
+		goto COPY_ELEMENTS;
+	}
+#endif
+
+	struct TLSYMBOL(_PFX, node)* nodes = tlmalloc_large(node_bytes);
+	if (!nodes)
+		return TL_ERR_MEM;
+
+	enum tl_map_slot_state* info = tlmalloc_large(info_bytes);
+	if (!info) {
+		tlfree_large(nodes, node_bytes);
+		return TL_ERR_MEM;
+	}
+
+	memcpy(nodes, src->nodes, node_bytes);
+	memcpy(info, src->info, info_bytes);
+	*dst = *src;
+	dst->nodes = nodes;
+	dst->info = info;
+
+#ifdef TL_FMAP_SMALL
+	COPY_ELEMENTS:
+#endif
+#if defined(fmap_key_copyfn) || defined(fmap_value_copyfn)
+	for (size_t base = 0; base < dst->capacity; base += 64u) {
+		for (uint64_t used = tl_map_used_bits(dst->info + base, dst->capacity - base); used != 0; used &= used - 1u) {
+			const size_t slot = base + tl_cpu_ctz64(used);
+#  ifdef fmap_key_copyfn
+			dst->nodes[slot].key = fmap_key_copyfn(dst->nodes[slot].key);
+#  endif
+#  ifdef fmap_value_copyfn
+			dst->nodes[slot].value = fmap_value_copyfn(dst->nodes[slot].value);
+#  endif
+		}
+	}
+#endif
+	return TLOK;
+}
+
+
+/**
+ * sweep is for internal use only
+ * Walk every bucket once, keeping the pairs for which keep returns non-zero, and compact each bucket in place so that
+ * its pairs stay contiguous from the first slot. The sweep itself never hashes or probes. keep receives the first slot
+ * of the bucket and the slot of the pair.
+ */
+typedef int TLSYMBOL(_PFX, keep_fn)(struct _PFX* fm, size_t bucket, size_t slot, void* ctx);
+
+static inline void
+TLSYMBOL(_PFX, sweep)(struct _PFX* fm, TLSYMBOL(_PFX, keep_fn)* keep_fn, void* ctx)
+{
+	struct TLSYMBOL(_PFX, node)* nodes = fm->nodes;
+	enum tl_map_slot_state* info = fm->info;
+	const size_t bucket_max = fm->bucket_max;
+
+	for (size_t bucket = 0; bucket < fm->capacity; bucket += bucket_max) {
+		size_t keep = 0;
+		size_t read;
+
+		for (read = 0; read < bucket_max; read++) {
+			const size_t slot = bucket + read;
+			if (info[slot] == TL_MAPSS_EMPTY) break;
+			if (info[slot] == TL_MAPSS_DELETED) continue;
+
+			if (!keep_fn(fm, bucket, slot, ctx)) {
+				fm->size--;
+				continue;
+			}
+
+			if (keep != read) {
+				nodes[bucket + keep] = nodes[slot];
+				info[bucket + keep] = (keep == 0) ? TL_MAPSS_OCCUPIED : TL_MAPSS_COLLIDED;
+			}
+			keep++;
+		}
+
+		for (size_t slot = bucket + keep; slot < bucket + read; slot++) {
+			info[slot] = TL_MAPSS_EMPTY;
+#ifndef TL_NO_ZERO_MEM
+			tlmemset(&nodes[slot], TL_INIT_VAL, sizeof(struct TLSYMBOL(_PFX, node)));
+#endif
+		}
+	}
+}
+
+
+/**
+ * fmap_<TL_NAME>_pred_fn
+ * Signature of the predicate used by fmap_<TL_NAME>_retain. Return non-zero to keep the pair. The value may be
+ * modified in place.
+ */
+typedef int TLSYMBOL(_PFX, pred_fn)(TL_K key, TL_V* value, void* ctx);
+
+/**
+ * keep_pred is for internal use only
+ */
+struct TLSYMBOL(_PFX, retainer)
+{
+	TLSYMBOL(_PFX, pred_fn)* pred;
+	void* ctx;
+};
+
+static inline int
+TLSYMBOL(_PFX, keep_pred)(struct _PFX* fm, const size_t bucket, const size_t slot, void* ctx)
+{
+	const struct TLSYMBOL(_PFX, retainer)* retainer = ctx;
+	(void)bucket;
+	return retainer->pred(fm->nodes[slot].key, &fm->nodes[slot].value, retainer->ctx);
+}
+
+
+/**
+ * fmap_<TL_NAME>_retain
+ * Keep only the key/value pairs for which pred returns non-zero. Every slot is visited once and each bucket is
+ * compacted as it is walked, so unlike repeated calls to erase no key is hashed or probed. In TL_NO_ZERO_MEM mode
+ * this also clears deleted slots left behind by erase and remove.
+ *
+ * Note:
+ * -Removed Keys and Values are *not* freed. The user must do so, typically from within pred.
+ * -pred must not modify the map.
+ *
+ * @param fm The fmap_<TL_NAME> to filter
+ * @param pred Called once for each pair
+ * @param ctx User data passed to pred
+ * @return The number of pairs removed
+ */
+static inline size_t
+TLSYMBOL(_PFX, retain)(struct _PFX* fm, TLSYMBOL(_PFX, pred_fn)* pred, void* ctx)
+{
+	assert(fm != NULL);
+	assert(fm->nodes != NULL);
+	assert(fm->info != NULL);
+	assert(pred != NULL);
+
+	const size_t size = fm->size;
+	struct TLSYMBOL(_PFX, retainer) retainer = {pred, ctx};
+
+	TLSYMBOL(_PFX, sweep)(fm, &TLSYMBOL(_PFX, keep_pred), &retainer);
+	return size - fm->size;
+}
+
+
+/**
+ * fmap_<TL_NAME>_combine_fn
+ * Signature of the function used to combine the values of a key present in both maps during merge and intersect.
+ * Receives the value from the destination map first and returns the value to keep.
+ */
+typedef TL_V TLSYMBOL(_PFX, combine_fn)(TL_V dst_value, TL_V src_value, void* ctx);
+
+
+/**
+ * fmap_<TL_NAME>_merge
+ * Add every key/value pair of src to dst. dst is presized once for both maps before any pair is placed, and src is
+ * walked slot by slot. When both maps share the same geometry the bucket of each src slot is reused and no key is
+ * hashed.
+ *
+ * @param dst The fmap_<TL_NAME> to merge into
+ * @param src The fmap_<TL_NAME> to merge from. It is not modified.
+ * @param combine Called for keys present in both maps to produce the resulting value. When NULL, src values replace
+ * 	dst values.
+ * @param ctx User data passed to combine
+ * @return
+ * 	TLOK upon success
+ * 	TL_ERR_MEM if there was an issue growing dst. dst holds a partial merge.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, merge)(struct _PFX* dst, const struct _PFX* src, TLSYMBOL(_PFX, combine_fn)* combine, void* ctx)
+{
+	assert(dst != NULL);
+	assert(src != NULL);
+	assert(dst != src);
+	assert(dst->nodes != NULL);
+	assert(src->nodes != NULL);
+
+	if (TLSYMBOL(_PFX, reserve)(dst, dst->size + src->size) != TLOK)
+		return TL_ERR_MEM;
+
+	const struct TLSYMBOL(_PFX, node)* nodes = src->nodes;
+	const enum tl_map_slot_state* info = src->info;
+	const size_t bucket_max = src->bucket_max;
+
+	for (size_t bucket = 0; bucket < src->capacity; bucket += bucket_max) {
+		for (size_t slot = bucket; slot < bucket + bucket_max; slot++) {
+			if (info[slot] == TL_MAPSS_EMPTY) break;
+			if (info[slot] == TL_MAPSS_DELETED) continue;
+
+			size_t dst_bucket;
+			size_t slot_idx;
+			RETRY_MERGE:
+			if (TLSYMBOL(_PFX, same_buckets)(dst, src))
+				dst_bucket = bucket;
+			else
+				dst_bucket = TL_FMAP_BUCKET(TL_FMAP_HASH(dst, nodes[slot].key), dst->slot_mask) * dst->bucket_max;
+			slot_idx = 0;
+
+			switch (TLSYMBOL(_PFX, probe_key)(dst->nodes, dst->info, dst_bucket, dst->bucket_max,
+				nodes[slot].key, &slot_idx)) {
+			case TLOK:
+				dst->nodes[dst_bucket + slot_idx].value = (combine)
+					? combine(dst->nodes[dst_bucket + slot_idx].value, nodes[slot].value, ctx)
+					: nodes[slot].value;
+				break;
+			case TL_ENF:
+				dst->nodes[dst_bucket + slot_idx] = nodes[slot];
+				dst->info[dst_bucket + slot_idx] = (slot_idx == 0) ? TL_MAPSS_OCCUPIED : TL_MAPSS_COLLIDED;
+				dst->size++;
+				break;
+			default:
+				if (TLSYMBOL(_PFX, grow)(dst) != TLOK)
+					return TL_ERR_MEM;
+				goto RETRY_MERGE;
+			}
+		}
+	}
+	return TLOK;
+}
+
+
+/**
+ * keep_against is for internal use only
+ * sweep callback keeping the pairs whose presence in src equals keep_found. Kept pairs found in src have their value
+ * combined when combine is provided. The bucket is reused for the src lookup when both maps share the same geometry.
+ */
+struct TLSYMBOL(_PFX, against)
+{
+	const struct _PFX* src;
+	int keep_found;
+	TLSYMBOL(_PFX, combine_fn)* combine;
+	void* ctx;
+};
+
+static inline int
+TLSYMBOL(_PFX, keep_against)(struct _PFX* fm, const size_t bucket, const size_t slot, void* ctx)
+{
+	const struct TLSYMBOL(_PFX, against)* against = ctx;
+	const struct _PFX* src = against->src;
+	struct TLSYMBOL(_PFX, node)* node = &fm->nodes[slot];
+
+	const size_t src_bucket = TLSYMBOL(_PFX, same_buckets)(fm, src)
+		? bucket
+		: TL_FMAP_BUCKET(TL_FMAP_HASH(src, node->key), src->slot_mask) * src->bucket_max;
+	size_t src_idx = 0;
+	const int found = (TLSYMBOL(_PFX, probe_key)(src->nodes, src->info, src_bucket, src->bucket_max,
+		node->key, &src_idx) == TLOK);
+
+	if (found && against->combine)
+		node->value = against->combine(node->value, src->nodes[src_bucket + src_idx].value, against->ctx);
+	return found == against->keep_found;
+}
+
+
+/**
+ * fmap_<TL_NAME>_intersect
+ * Remove every pair of dst whose key is not present in src. dst is walked once and each bucket is compacted in place;
+ * when both maps share the same geometry the keys are not hashed.
+ *
+ * Note:
+ * -Removed Keys and Values are *not* freed. The user must do so.
+ *
+ * @param dst The fmap_<TL_NAME> to intersect
+ * @param src The fmap_<TL_NAME> to intersect with. It is not modified.
+ * @param combine Called for each kept key to produce the resulting value. When NULL, dst values are kept.
+ * @param ctx User data passed to combine
+ */
+static inline void
+TLSYMBOL(_PFX, intersect)(struct _PFX* dst, const struct _PFX* src, TLSYMBOL(_PFX, combine_fn)* combine, void* ctx)
+{
+	assert(dst != NULL);
+	assert(src != NULL);
+	assert(dst != src);
+	assert(dst->nodes != NULL);
+	assert(src->nodes != NULL);
+
+	struct TLSYMBOL(_PFX, against) against = {src, 1, combine, ctx};
+	TLSYMBOL(_PFX, sweep)(dst, &TLSYMBOL(_PFX, keep_against), &against);
+}
+
+
+/**
+ * fmap_<TL_NAME>_subtract
+ * Remove every pair of dst whose key is present in src. When src is much smaller than dst each of its keys is erased
+ * from dst, otherwise dst is walked once and compacted in place.
+ *
+ * Note:
+ * -Removed Keys and Values are *not* freed. The user must do so.
+ *
+ * @param dst The fmap_<TL_NAME> to subtract from
+ * @param src The fmap_<TL_NAME> holding the keys to remove. It is not modified.
+ */
+static inline void
+TLSYMBOL(_PFX, subtract)(struct _PFX* dst, const struct _PFX* src)
+{
+	assert(dst != NULL);
+	assert(src != NULL);
+	assert(dst != src);
+	assert(dst->nodes != NULL);
+	assert(src->nodes != NULL);
+
+	if (src->size >= (dst->size >> 2)) {
+		struct TLSYMBOL(_PFX, against) against = {src, 0, NULL, NULL};
+		TLSYMBOL(_PFX, sweep)(dst, &TLSYMBOL(_PFX, keep_against), &against);
+		return;
+	}
+
+	for (size_t base = 0; base < src->capacity; base += 64u) {
+		for (uint64_t used = tl_map_used_bits(src->info + base, src->capacity - base); used != 0; used &= used - 1u) {
+			TLSYMBOL(_PFX, erase)(dst, src->nodes[base + tl_cpu_ctz64(used)].key);
+		}
+	}
+}
+
+
+/**
+ * fmap_<TL_NAME>_hash_many
+ * Compute the hash fm uses for each of count keys. With the default hash of fixed size keys, independent keys are
+ * hashed side by side (in vector lanes on CPUs with AVX2, see tlhash_fnv1a_many) instead of one multiply chain after
+ * the other. Meant to feed bulk lookups and filters built in front of the map.
+ *
+ * @param fm The fmap_<TL_NAME> whose hash to use
+ * @param keys The keys to hash
+ * @param count The number of keys
+ * @param out_hashes --Out-- Receives the count hashes
+ */
+static inline void
+TLSYMBOL(_PFX, hash_many)(const struct _PFX* fm, TL_K const* keys, const size_t count, size_t* out_hashes)
+{
+	assert(fm != NULL);
+	assert(count == 0 || (keys != NULL && out_hashes != NULL));
+
+#if defined(TL_FMAP_HASH_FNV1A) && !defined(TL_SEEDED_HASH)
+	(void)fm;
+	TLSYMBOL(_PFX, fnv1a_many)(keys, count, out_hashes);
+#else
+#ifndef TL_SEEDED_HASH
+	(void)fm;
+#endif
+	for (size_t i = 0; i < count; i++) {
+		out_hashes[i] = TL_FMAP_HASH(fm, keys[i]);
+	}
+#endif
+}
+
+
+#ifdef TL_FMAP_HASH_QUALITY
+
+/**
+ * quality_hash is for internal use only
+ * The hash of a map (ctx) over a key handed over as bytes by tlhash_quality.
+ */
+static inline size_t
+TLSYMBOL(_PFX, quality_hash)(const void* key, const size_t len, void* ctx)
+{
+	const struct _PFX* fm = ctx;
+	(void)fm;
+	(void)len;
+
+#ifdef TL_KEY_IS_NT
+	TL_K k = (TL_K)key;
+#else
+	TL_K k;
+	memcpy(&k, key, sizeof(TL_K));
+#endif
+	return TL_FMAP_HASH(fm, k);
+}
+
+/**
+ * fmap_<TL_NAME>_hash_quality
+ * Check how well the hash of fm spreads a sample of keys over the buckets of a map sized for them at fm's load factor
+ * (see tlhash_quality for the report). Use it on a representative sample before settling on a custom fmap_hashfn,
+ * or to pick the num_buckets and load_factor for fmap_<TL_NAME>_init_all.
+ *
+ * Note:
+ * -Only generated when TL_FMAP_HASH_QUALITY is defined
+ * -fm is only read for its hash (and seed with TL_SEEDED_HASH) and its load factor, the keys are not inserted
+ *
+ * @param fm The fmap_<TL_NAME> whose hash to analyze
+ * @param keys The sample of keys
+ * @param count The number of keys, at least 1
+ * @param out --Out-- The analysis
+ * @return
+ * 	TLOK on success
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, hash_quality)(const struct _PFX* fm, TL_K const* keys, const size_t count, struct tlhash_quality* out)
+{
+	assert(fm != NULL);
+
+#ifdef TL_KEY_IS_NT
+	const size_t key_size = 0;
+#else
+	const size_t key_size = sizeof(TL_K);
+#endif
+#ifdef TL_KEY_IS_INT
+	const int high_bits = 1;
+#else
+	const int high_bits = 0;
+#endif
+	return tlhash_quality(&TLSYMBOL(_PFX, quality_hash), (void*)fm, keys, key_size, count, fm->load_factor, high_bits,
+		out);
+}
+
+#endif
+
+
+/**
+ * parallel insert is for internal use only
+ * Rows are hashed once and grouped by the high bits of their bucket index, so that each thread owns a contiguous
+ * range of buckets and can place its rows without synchronization. Rows keep their input order within a group, which
+ * keeps "last duplicate wins" semantics. If a bucket overflows the map grows and every row is placed again; rows that
+ * were already placed are simply replaced by themselves.
+ */
+#ifdef TL_THREADS
+
+struct TLSYMBOL(_PFX, build_task)
+{
+	struct _PFX* fm;
+	TL_K const* keys;
+	TL_V const* values;
+	size_t* hashes;
+	size_t* order;
+	size_t* counts;
+	size_t begin;
+	size_t end;
+	size_t nparts;
+	size_t part_shift;
+	size_t added;
+	int phase;
+	enum tl_status status;
+};
+
+#define TL_FMAP_BUILD_HASH 0
+#define TL_FMAP_BUILD_COUNT 1
+#define TL_FMAP_BUILD_SCATTER 2
+#define TL_FMAP_BUILD_PLACE 3
+
+static inline void*
+TLSYMBOL(_PFX, build_run)(void* arg)
+{
+	struct TLSYMBOL(_PFX, build_task)* task = arg;
+	const size_t mask = task->fm->slot_mask;
+	size_t i;
+
+	switch (task->phase) {
+	case TL_FMAP_BUILD_HASH:
+		TLSYMBOL(_PFX, hash_many)(task->fm, task->keys + task->begin, task->end - task->begin,
+			task->hashes + task->begin);
+		/* fall through */
+	case TL_FMAP_BUILD_COUNT:
+		for (i = 0; i < task->nparts; i++) {
+			task->counts[i] = 0;
+		}
+		for (i = task->begin; i < task->end; i++) {
+			task->counts[TL_FMAP_BUCKET(task->hashes[i], mask) >> task->part_shift]++;
+		}
+		break;
+	case TL_FMAP_BUILD_SCATTER:
+		for (i = task->begin; i < task->end; i++) {
+			task->order[task->counts[TL_FMAP_BUCKET(task->hashes[i], mask) >> task->part_shift]++] = i;
+		}
+		break;
+	case TL_FMAP_BUILD_PLACE:
+		task->added = 0;
+		task->status = TLOK;
+		for (i = task->begin; i < task->end; i++) {
+			const size_t row = task->order[i];
+			const enum tl_status status = TLSYMBOL(_PFX, put_hashed)(task->fm, task->hashes[row],
+				task->keys[row], task->values[row]);
+
+			if (status == TL_OOB) {
+				task->status = TL_OOB;
+				break;
+			}
+			if (status == TL_ENF)
+				task->added++;
+		}
+		break;
+	default:
+		break;
+	}
+	return NULL;
+}
+
+static inline enum tl_status
+TLSYMBOL(_PFX, insert_n_parallel)(struct _PFX* fm, TL_K const* keys, TL_V const* values, const size_t count)
+{
+	struct TLSYMBOL(_PFX, build_task) tasks[TL_MAX_THREADS];
+	size_t nparts = tl_util_npot(tl_thread_count());
+	enum tl_status ret = TLOK;
+	size_t t;
+	size_t p;
+
+	if (nparts > tl_thread_count()) nparts >>= 1;
+	if (nparts < 2) nparts = 2;
+	if (nparts > fm->num_buckets) nparts = fm->num_buckets;
+
+	size_t* hashes = tlmalloc_large(count * sizeof(size_t));
+	size_t* order = tlmalloc_large(count * sizeof(size_t));
+	size_t* counts = tlmalloc(nparts * nparts * sizeof(size_t));
+	if (!hashes || !order || !counts) {
+		ret = TL_ERR_MEM;
+		goto CLEANUP;
+	}
+
+	for (t = 0; t < nparts; t++) {
+		tasks[t].fm = fm;
+		tasks[t].keys = keys;
+		tasks[t].values = values;
+		tasks[t].hashes = hashes;
+		tasks[t].order = order;
+		tasks[t].counts = counts + (t * nparts);
+		tasks[t].nparts = nparts;
+		tasks[t].phase = TL_FMAP_BUILD_HASH;
+	}
+
+	for (;;) {
+		const size_t shift = tl_util_log2n(fm->num_buckets) - tl_util_log2n(nparts);
+
+		for (t = 0; t < nparts; t++) {
+			tasks[t].begin = (count * t) / nparts;
+			tasks[t].end = (count * (t + 1)) / nparts;
+			tasks[t].part_shift = shift;
+		}
+		tl_thread_run(nparts, &TLSYMBOL(_PFX, build_run), tasks, sizeof(tasks[0]));
+
+		/* turn the per task counts into scatter offsets, group by group */
+		size_t offset = 0;
+		for (p = 0; p < nparts; p++) {
+			for (t = 0; t < nparts; t++) {
+				const size_t n = counts[(t * nparts) + p];
+				counts[(t * nparts) + p] = offset;
+				offset += n;
+			}
+		}
+
+		for (t = 0; t < nparts; t++) {
+			tasks[t].phase = TL_FMAP_BUILD_SCATTER;
+		}
+		tl_thread_run(nparts, &TLSYMBOL(_PFX, build_run), tasks, sizeof(tasks[0]));
+
+		/* after the scatter the last task's counters mark the end of each group */
+		for (p = 0; p < nparts; p++) {
+			tasks[p].begin = (p == 0) ? 0 : counts[((nparts - 1) * nparts) + p - 1];
+			tasks[p].end = counts[((nparts - 1) * nparts) + p];
+			tasks[p].phase = TL_FMAP_BUILD_PLACE;
+		}
+		tl_thread_run(nparts, &TLSYMBOL(_PFX, build_run), tasks, sizeof(tasks[0]));
+
+		enum tl_status status = TLOK;
+		for (t = 0; t < nparts; t++) {
+			fm->size += tasks[t].added;
+			if (tasks[t].status == TL_OOB) status = TL_OOB;
+		}
+		if (status == TLOK)
+			break;
+
+		if (TLSYMBOL(_PFX, grow)(fm) != TLOK) {
+			ret = TL_ERR_MEM;
+			break;
+		}
+		for (t = 0; t < nparts; t++) {
+			tasks[t].phase = TL_FMAP_BUILD_COUNT;
+		}
+	}
+
+CLEANUP:
+	if (hashes) tlfree_large(hashes, count * sizeof(size_t));
+	if (order) tlfree_large(order, count * sizeof(size_t));
+	if (counts) tlfree(counts);
+	return ret;
+}
+
+#undef TL_FMAP_BUILD_PLACE
+#undef TL_FMAP_BUILD_SCATTER
+#undef TL_FMAP_BUILD_COUNT
+#undef TL_FMAP_BUILD_HASH
+
+#endif //TL_THREADS
+
+
+/**
+ * fmap_<TL_NAME>_insert_n
+ * Insert count key/value pairs taken from two parallel arrays, replacing the value of keys that already exist. The map
+ * is presized once for all rows before any of them are placed. When a key appears more than once, the last row wins.
+ *
+ * Options:
+ * -Define TL_THREADS to place the rows on multiple threads when count is at least TL_FMAP_PARALLEL_THRESHOLD
+ *
+ * @param fm The fmap_<TL_NAME> to insert into
+ * @param keys The keys, count elements long
+ * @param values The values, count elements long
+ * @param count The number of rows
+ * @return
+ * 	TLOK upon success
+ * 	TL_ERR_MEM if there was an issue growing the backing arrays. Rows may have been partially inserted.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, insert_n)(struct _PFX* fm, TL_K const* keys, TL_V const* values, const size_t count)
+{
+	assert(fm != NULL);
+	assert(fm->nodes != NULL);
+	assert(fm->info != NULL);
+	assert(count == 0 || (keys != NULL && values != NULL));
+
+	if (TLSYMBOL(_PFX, reserve)(fm, fm->size + count) != TLOK)
+		return TL_ERR_MEM;
+
+#ifdef TL_THREADS
+	if (count >= TL_FMAP_PARALLEL_THRESHOLD)
+		return TLSYMBOL(_PFX, insert_n_parallel)(fm, keys, values, count);
+#endif
+
+	size_t hashes[TL_FMAP_HASH_BATCH];
+	for (size_t begin = 0; begin < count; begin += TL_FMAP_HASH_BATCH) {
+		const size_t n = (count - begin < TL_FMAP_HASH_BATCH) ? count - begin : TL_FMAP_HASH_BATCH;
+		TLSYMBOL(_PFX, hash_many)(fm, keys + begin, n, hashes);
+
+		for (size_t i = 0; i < n; i++) {
+			enum tl_status status;
+
+			while ((status = TLSYMBOL(_PFX, put_hashed)(fm, hashes[i], keys[begin + i], values[begin + i])) == TL_OOB) {
+				if (TLSYMBOL(_PFX, grow)(fm) != TLOK)
+					return TL_ERR_MEM;
+			}
+			if (status == TL_ENF)
+				fm->size++;
+		}
+	}
+	return TLOK;
+}
+
+
+/**
+ * fmap_<TL_NAME>_init_from
+ * Initialize a fmap_<TL_NAME> sized for count rows and insert the rows from two parallel key/value arrays.
+ *
+ * @param fm The fmap_<TL_NAME> to initialize
+ * @param keys The keys, count elements long
+ * @param values The values, count elements long
+ * @param count The number of rows
+ * @param load_factor 0 - 100. whole number percentage of capacity to target before growing automatically. 70 is default.
+ * @return
+ * 	TLOK on successful initialization
+ * 	TL_ERR_MEM if there was an issue acquiring memory. fm is left uninitialized.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, init_from)(struct _PFX* fm, TL_K const* keys, TL_V const* values, const size_t count,
+	const size_t load_factor)
+{
+	assert(fm != NULL);
+	assert(load_factor <= 100);
+
+	const size_t factor = (load_factor != 0) ? load_factor : TL_FMAP_DEFAULT_LOAD_FACTOR;
+	const size_t buckets = TLSYMBOL(_PFX, buckets_for)(count, factor, TL_FMAP_DEFAULT_BUCKET_COUNT);
+
+	if (TLSYMBOL(_PFX, init_all)(fm, buckets, factor) != TLOK)
+		return TL_ERR_MEM;
+
+	if (TLSYMBOL(_PFX, insert_n)(fm, keys, values, count) != TLOK) {
+		TLSYMBOL(_PFX, deinit)(fm);
+		return TL_ERR_MEM;
+	}
+	return TLOK;
+}
+
+
+/**
+ * fmap_<TL_NAME>_export
+ * Copy every key and/or value in the map into caller provided arrays, in slot order. The n-th key and n-th value
+ * written belong to the same pair.
+ *
+ * @param fm The fmap_<TL_NAME> to export
+ * @param out_keys --Out-- Receives the keys. Must hold fm->size elements. May be NULL.
+ * @param out_values --Out-- Receives the values. Must hold fm->size elements. May be NULL.
+ * @return The number of pairs exported (fm->size)
+ */
+static inline size_t
+TLSYMBOL(_PFX, export)(const struct _PFX* fm, TL_K* out_keys, TL_V* out_values)
+{
+	assert(fm != NULL);
+	assert(fm->nodes != NULL);
+	assert(fm->info != NULL);
+
+	const struct TLSYMBOL(_PFX, node)* nodes = fm->nodes;
+	const enum tl_map_slot_state* info = fm->info;
+	size_t n = 0;
+
+	for (size_t base = 0; base < fm->capacity; base += 64u) {
+		for (uint64_t used = tl_map_used_bits(info + base, fm->capacity - base); used != 0; used &= used - 1u) {
+			const size_t slot = base + tl_cpu_ctz64(used);
+			if (out_keys) out_keys[n] = nodes[slot].key;
+			if (out_values) out_values[n] = nodes[slot].value;
+			n++;
+		}
+	}
+	return n;
+}
+
+
+#ifdef TL_FMAP_KEY_ARRAY
+/**
+ * fmap_<TL_NAME>_export_keys
+ * Append every key in the map to the end of an array of keys. The array grows at most once.
+ *
+ * Note:
+ * -Only generated when TL_FMAP_KEY_ARRAY is defined.
+ *
+ * @param fm The fmap_<TL_NAME> to export
+ * @param keys The initialized array to append the keys to
+ * @return
+ * 	TLOK upon success
+ * 	TL_ERR_MEM if the array could not grow
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, export_keys)(const struct _PFX* fm, struct TL_FMAP_KEY_ARRAY* keys)
+{
+	assert(fm != NULL);
+	assert(keys != NULL);
+
+	if (TLSYMBOL(TL_FMAP_KEY_ARRAY, ensure_capacity)(keys, keys->size + fm->size) == TL_ERR_MEM)
+		return TL_ERR_MEM;
+
+	keys->size += TLSYMBOL(_PFX, export)(fm, keys->data + keys->size, NULL);
+	return TLOK;
+}
+#endif
+
+#ifdef TL_FMAP_VALUE_ARRAY
+/**
+ * fmap_<TL_NAME>_export_values
+ * Append every value in the map to the end of an array of values. The array grows at most once.
+ *
+ * Note:
+ * -Only generated when TL_FMAP_VALUE_ARRAY is defined.
+ * -Values are appended in the same order export_keys appends keys.
+ *
+ * @param fm The fmap_<TL_NAME> to export
+ * @param values The initialized array to append the values to
+ * @return
+ * 	TLOK upon success
+ * 	TL_ERR_MEM if the array could not grow
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, export_values)(const struct _PFX* fm, struct TL_FMAP_VALUE_ARRAY* values)
+{
+	assert(fm != NULL);
+	assert(values != NULL);
+
+	if (TLSYMBOL(TL_FMAP_VALUE_ARRAY, ensure_capacity)(values, values->size + fm->size) == TL_ERR_MEM)
+		return TL_ERR_MEM;
+
+	values->size += TLSYMBOL(_PFX, export)(fm, NULL, values->data + values->size);
+	return TLOK;
+}
+#endif
+
+#if defined(TL_FMAP_KEY_ARRAY) && defined(TL_FMAP_VALUE_ARRAY)
+/**
+ * fmap_<TL_NAME>_init_from_arrays
+ * Initialize a fmap_<TL_NAME> from a key column and a value column of the same size. See fmap_<TL_NAME>_init_from.
+ *
+ * Note:
+ * -Only generated when both TL_FMAP_KEY_ARRAY and TL_FMAP_VALUE_ARRAY are defined.
+ *
+ * @param fm The fmap_<TL_NAME> to initialize
+ * @param keys The keys
+ * @param values The values, keys->size elements long
+ * @param load_factor 0 - 100. whole number percentage of capacity to target before growing automatically. 70 is default.
+ * @return
+ * 	TLOK on successful initialization
+ * 	TL_ERR_MEM if there was an issue acquiring memory. fm is left uninitialized.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, init_from_arrays)(struct _PFX* fm, const struct TL_FMAP_KEY_ARRAY* keys,
+	const struct TL_FMAP_VALUE_ARRAY* values, const size_t load_factor)
+{
+	assert(keys != NULL);
+	assert(values != NULL);
+	assert(keys->size == values->size);
+
+	return TLSYMBOL(_PFX, init_from)(fm, keys->data, values->data, keys->size, load_factor);
+}
+#endif
+
+
+/**
+ * fmap_<TL_NAME>_frozen
+ * Immutable minimal perfect hash table built from a fmap_<TL_NAME> by fmap_<TL_NAME>_freeze. There is exactly one
+ * slot per element and no info array, so a lookup is one hash, one displacement read, one slot access and one key
+ * compare.
+ *
+ * size        - (public) The number of elements, which is also the number of slots
+ * num_buckets - (private) The number of displacement buckets (a power of 2)
+ * seed        - (private) The seed mixed into every key hash
+ * disp        - (private) The displacement of each bucket, or the slot itself for single element buckets
+ * nodes       - (private) The elements
+ * hash_seed   - (private) The key of the seeded hash, copied from the map (TL_SEEDED_HASH only)
+ */
+struct TLSYMBOL(_PFX, frozen)
+{
+	size_t size;
+	size_t num_buckets;
+	size_t seed;
+	uint32_t* disp;
+	struct TLSYMBOL(_PFX, node)* nodes;
+#ifdef TL_SEEDED_HASH
+	uint64_t hash_seed[2];
+#endif
+};
+
+#define TL_FMAP_FROZEN_DIRECT 0x80000000u
+#ifndef TL_FMAP_FROZEN_MAX_DISP
+#define TL_FMAP_FROZEN_MAX_DISP (1u << 20u)
+#endif
+#ifndef TL_FMAP_FROZEN_SEEDS
+#define TL_FMAP_FROZEN_SEEDS 8u
+#endif
+
+/**
+ * frozen_slot is for internal use only
+ * Maps a mixed key hash and its bucket displacement to a slot in [0, size) with a multiply instead of a modulo.
+ * Single element buckets store their slot directly, flagged by TL_FMAP_FROZEN_DIRECT.
+ */
+static inline size_t
+TLSYMBOL(_PFX, frozen_slot)(const size_t mixed, const uint32_t disp, const size_t size)
+{
+	const size_t displaced = tlhash_mix(mixed ^ disp);
+#if (TL_SIZE_T_BYTES == 16)
+	const size_t slot = (size_t)(((displaced >> 32u) * (uint64_t)size) >> 32u);
+#else
+	const size_t slot = (size_t)(((uint64_t)displaced * size) >> 32u);
+#endif
+	return (disp & TL_FMAP_FROZEN_DIRECT) ? (size_t)(disp ^ TL_FMAP_FROZEN_DIRECT) : slot;
+}
+
+/**
+ * frozen_place is for internal use only
+ * One CHD placement attempt with the seed currently in frozen. Buckets are placed largest first, searching for a
+ * displacement that sends every element of the bucket to a distinct free slot. Single element buckets take the next
+ * free slot directly. Returns TL_OOB when a bucket could not be placed (another seed may work) and TL_EAE when two
+ * keys share a full hash (no seed can separate them).
+ *
+ * scratch must hold (2 * n) + 1 elements.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, frozen_place)(struct TLSYMBOL(_PFX, frozen)* frozen, const size_t* mixed, size_t* offsets,
+	size_t* members, size_t* order, size_t* scratch, unsigned char* taken)
+{
+	const size_t n = frozen->size;
+	const size_t nb = frozen->num_buckets;
+	const size_t bucket_mask = nb - 1;
+	size_t i;
+	size_t b;
+
+	/* group the elements by bucket, offsets[b] to offsets[b + 1] index into members */
+	for (b = 0; b <= nb; b++) {
+		offsets[b] = 0;
+	}
+	for (i = 0; i < n; i++) {
+		offsets[(mixed[i] & bucket_mask) + 1]++;
+	}
+	size_t largest = 0;
+	for (b = 0; b < nb; b++) {
+		if (offsets[b + 1] > largest) largest = offsets[b + 1];
+		offsets[b + 1] += offsets[b];
+	}
+	for (b = 0; b < nb; b++) {
+		order[b] = offsets[b];
+	}
+	for (i = 0; i < n; i++) {
+		members[order[mixed[i] & bucket_mask]++] = i;
+	}
+
+	/* order the buckets largest first with a counting sort over their sizes */
+	size_t* slots = scratch;
+	size_t* by_size = scratch + largest;
+	for (i = 0; i <= largest; i++) {
+		by_size[i] = 0;
+	}
+	for (b = 0; b < nb; b++) {
+		by_size[largest - (offsets[b + 1] - offsets[b])]++;
+	}
+	size_t start = 0;
+	for (i = 0; i <= largest; i++) {
+		const size_t count = by_size[i];
+		by_size[i] = start;
+		start += count;
+	}
+	for (b = 0; b < nb; b++) {
+		order[by_size[largest - (offsets[b + 1] - offsets[b])]++] = b;
+	}
+
+	/* equal mixed hashes always share a bucket, check them all before a failed placement can hide them */
+	for (b = 0; b < nb; b++) {
+		for (i = offsets[b]; i < offsets[b + 1]; i++) {
+			for (size_t j = i + 1; j < offsets[b + 1]; j++) {
+				if (mixed[members[i]] == mixed[members[j]])
+					return TL_EAE;
+			}
+		}
+	}
+
+	tlmemset(taken, 0, n);
+	size_t next_free = 0;
+
+	for (size_t o = 0; o < nb; o++) {
+		const size_t bucket = order[o];
+		const size_t* member = members + offsets[bucket];
+		const size_t k = offsets[bucket + 1] - offsets[bucket];
+
+		if (k == 0) {
+			frozen->disp[bucket] = 0;
+			continue;
+		}
+		if (k == 1) {
+			while (taken[next_free]) next_free++;
+			taken[next_free] = 1;
+			frozen->disp[bucket] = TL_FMAP_FROZEN_DIRECT | (uint32_t)next_free;
+			continue;
+		}
+
+		uint32_t d;
+		for (d = 0; d < TL_FMAP_FROZEN_MAX_DISP; d++) {
+			for (i = 0; i < k; i++) {
+				size_t j;
+				slots[i] = TLSYMBOL(_PFX, frozen_slot)(mixed[member[i]], d, n);
+				if (taken[slots[i]])
+					break;
+				for (j = 0; j < i && slots[j] != slots[i]; j++);
+				if (j != i)
+					break;
+			}
+			if (i == k)
+				break;
+		}
+		if (d == TL_FMAP_FROZEN_MAX_DISP)
+			return TL_OOB;
+
+		for (i = 0; i < k; i++) {
+			taken[slots[i]] = 1;
+		}
+		frozen->disp[bucket] = d;
+	}
+	return TLOK;
+}
+
+
+/**
+ * fmap_<TL_NAME>_freeze
+ * Build an immutable minimal perfect hash table (CHD style) over the current contents of a fmap_<TL_NAME>. The map is
+ * not modified and may be deinitialized afterwards, the frozen table holds its own copy of every key/value pair.
+ *
+ * Note:
+ * -Keys and Values are copied shallowly. Pointers are shared with the map.
+ * -Building costs a few passes over the elements plus a small search per bucket. It is meant for maps that are built
+ * 	once and then only read.
+ *
+ * Options:
+ * -Define TL_FMAP_FROZEN_SEEDS to the number of seeds tried before giving up
+ * 	-Default is 8
+ * -Define TL_FMAP_FROZEN_MAX_DISP to the number of displacements tried per bucket and seed
+ * 	-Default is 2^20
+ *
+ * @param fm The fmap_<TL_NAME> to freeze
+ * @param frozen --Out-- The frozen table to initialize
+ * @return
+ * 	TLOK on success
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ * 	TL_OOB if the map holds too many elements (2^31 or more) to freeze
+ * 	TL_EAE if two keys share the same full hash value, which no seed can separate (fix the hash function)
+ * 	TL_ERROR if no seed produced a placement (practically only with a very small TL_FMAP_FROZEN_MAX_DISP)
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, freeze)(const struct _PFX* fm, struct TLSYMBOL(_PFX, frozen)* frozen)
+{
+	assert(fm != NULL);
+	assert(fm->nodes != NULL);
+	assert(fm->info != NULL);
+	assert(frozen != NULL);
+
+	const size_t n = fm->size;
+	if (n >= TL_FMAP_FROZEN_DIRECT)
+		return TL_OOB;
+
+	const size_t nb = tl_util_npot((n + 3u) / 4u);
+	const size_t alloc_n = (n != 0) ? n : 1u;
+	enum tl_status ret = TL_ERR_MEM;
+	size_t i;
+
+	frozen->size = n;
+	frozen->num_buckets = nb;
+#ifdef TL_SEEDED_HASH
+	memcpy(frozen->hash_seed, fm->hash_seed, sizeof(frozen->hash_seed));
+#endif
+	frozen->disp = tlmalloc_large(nb * sizeof(uint32_t));
+	frozen->nodes = tlmalloc_large(alloc_n * sizeof(struct TLSYMBOL(_PFX, node)));
+
+	size_t* hashes = tlmalloc_large(alloc_n * sizeof(size_t));
+	size_t* mixed = tlmalloc_large(alloc_n * sizeof(size_t));
+	size_t* sources = tlmalloc_large(alloc_n * sizeof(size_t));
+	size_t* members = tlmalloc_large(alloc_n * sizeof(size_t));
+	size_t* offsets = tlmalloc_large((nb + 1u) * sizeof(size_t));
+	size_t* order = tlmalloc_large(nb * sizeof(size_t));
+	size_t* scratch = tlmalloc_large(((2u * alloc_n) + 1u) * sizeof(size_t));
+	unsigned char* taken = tlmalloc_large(alloc_n);
+
+	if (!frozen->disp || !frozen->nodes || !hashes || !mixed || !sources || !members || !offsets || !order
+	    || !scratch || !taken)
+		goto CLEANUP;
+
+	i = 0;
+	for (size_t base = 0; base < fm->capacity; base += 64u) {
+		for (uint64_t used = tl_map_used_bits(fm->info + base, fm->capacity - base); used != 0; used &= used - 1u) {
+			const size_t slot = base + tl_cpu_ctz64(used);
+			hashes[i] = TL_FMAP_HASH(fm, fm->nodes[slot].key);
+			sources[i] = slot;
+			i++;
+		}
+	}
+
+	ret = TL_ERROR;
+	for (size_t attempt = 0; attempt < TL_FMAP_FROZEN_SEEDS; attempt++) {
+		frozen->seed = tlhash_mix(attempt + 1u);
+		for (i = 0; i < n; i++) {
+			mixed[i] = tlhash_mix(hashes[i] ^ frozen->seed);
+		}
+
+		const enum tl_status status = TLSYMBOL(_PFX, frozen_place)(frozen, mixed, offsets, members, order,
+			scratch, taken);
+		if (status == TLOK) {
+			ret = TLOK;
+			break;
+		}
+		if (status == TL_EAE) {
+			ret = TL_EAE;
+			break;
+		}
+	}
+
+	if (ret == TLOK) {
+		for (i = 0; i < n; i++) {
+			const uint32_t disp = frozen->disp[mixed[i] & (nb - 1)];
+			frozen->nodes[TLSYMBOL(_PFX, frozen_slot)(mixed[i], disp, n)] = fm->nodes[sources[i]];
+		}
+	}
+
+CLEANUP:
+	if (hashes) tlfree_large(hashes, alloc_n * sizeof(size_t));
+	if (mixed) tlfree_large(mixed, alloc_n * sizeof(size_t));
+	if (sources) tlfree_large(sources, alloc_n * sizeof(size_t));
+	if (members) tlfree_large(members, alloc_n * sizeof(size_t));
+	if (offsets) tlfree_large(offsets, (nb + 1u) * sizeof(size_t));
+	if (order) tlfree_large(order, nb * sizeof(size_t));
+	if (scratch) tlfree_large(scratch, ((2u * alloc_n) + 1u) * sizeof(size_t));
+	if (taken) tlfree_large(taken, alloc_n);
+
+	if (ret != TLOK) {
+		if (frozen->disp) tlfree_large(frozen->disp, nb * sizeof(uint32_t));
+		if (frozen->nodes) tlfree_large(frozen->nodes, alloc_n * sizeof(struct TLSYMBOL(_PFX, node)));
+		frozen->disp = NULL;
+		frozen->nodes = NULL;
+	}
+	return ret;
+}
+
+
+/**
+ * fmap_<TL_NAME>_frozen_try_get
+ * Acquire a value for a given key out of a frozen table and set out_value from the found value.
+ *
+ * @param frozen The frozen table to acquire the value from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- The value found for the given key
+ * @return
+ * 	TLOK when the key was found
+ * 	TL_ENF when the key was not found
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, frozen_try_get)(const struct TLSYMBOL(_PFX, frozen)* frozen, TL_K key, TL_V* out_value)
+{
+	assert(frozen != NULL);
+	assert(frozen->nodes != NULL);
+
+	if (frozen->size == 0)
+		return TL_ENF;
+
+	const size_t mixed = tlhash_mix(TL_FMAP_HASH(frozen, key) ^ frozen->seed);
+	const uint32_t disp = frozen->disp[mixed & (frozen->num_buckets - 1)];
+	const struct TLSYMBOL(_PFX, node)* node = &frozen->nodes[TLSYMBOL(_PFX, frozen_slot)(mixed, disp, frozen->size)];
+
+	if (!(fmap_key_equalsfn(node->key, key)))
+		return TL_ENF;
+
+	*out_value = node->value;
+	return TLOK;
+}
+
+
+/**
+ * fmap_<TL_NAME>_frozen_get
+ * Returns the value for a given key of a frozen table or 0 if the key was not found.
+ *
+ * Note:
+ * -This function is not suitable if 0 is a valid value for you! use fmap_<TL_NAME>_frozen_try_get instead.
+ *
+ * @param frozen The frozen table to get a value from
+ * @param key The key to use for lookup
+ * @return The value paired with the given key
+ */
+static inline TL_V
+TLSYMBOL(_PFX, frozen_get)(const struct TLSYMBOL(_PFX, frozen)* frozen, TL_K key)
+{
+	TL_V value;
+
+	if (TLSYMBOL(_PFX, frozen_try_get)(frozen, key, &value) != TLOK)
+		tlmemset(&value, TL_INIT_VAL, sizeof(TL_V));
+
+	return value;
+}
+
+
+/**
+ * fmap_<TL_NAME>_frozen_deinit
+ * Deinitialize a frozen table built by fmap_<TL_NAME>_freeze. Deinitialization frees the backing memory stores.
+ *
+ * Note:
+ * -Keys and Values are *not* freed. The user must do so.
+ *
+ * @param frozen The frozen table to deinitialize
+ */
+static inline void
+TLSYMBOL(_PFX, frozen_deinit)(struct TLSYMBOL(_PFX, frozen)* frozen)
+{
+	assert(frozen != NULL);
+	assert(frozen->nodes != NULL);
+	assert(frozen->disp != NULL);
+
+	const size_t node_bytes = ((frozen->size != 0) ? frozen->size : 1u) * sizeof(struct TLSYMBOL(_PFX, node));
+	const size_t disp_bytes = frozen->num_buckets * sizeof(uint32_t);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(frozen->nodes, TL_INIT_VAL, node_bytes);
+	tlmemset(frozen->disp, TL_INIT_VAL, disp_bytes);
+	frozen->size = 0u;
+	frozen->num_buckets = 0u;
+	frozen->seed = 0u;
+#endif
+	tlfree_large(frozen->nodes, node_bytes);
+	tlfree_large(frozen->disp, disp_bytes);
+	frozen->nodes = NULL;
+	frozen->disp = NULL;
+}
+
+#undef TL_FMAP_FROZEN_SEEDS
+#undef TL_FMAP_FROZEN_MAX_DISP
+#undef TL_FMAP_FROZEN_DIRECT
+
+
+#undef TL_FMAP_HASH_QUALITY
+#undef TL_FMAP_SMALL
+#undef TL_FMAP_DEFAULT_LOAD_FACTOR
+#undef TL_FMAP_DEFAULT_BUCKET_COUNT
+#undef TL_FMAP_BUCKET
+#undef TL_FMAP_HASH_BATCH
+#undef TL_FMAP_HASH_FNV1A
+#undef TL_FMAP_HASH
+#undef fmap_seeded_hashfn
+#undef fmap_hashfn
+#undef _PFX
+#ifdef TL_FMAP_PFX
+#undef TL_FMAP_PFX
+#else
+#undef TL_NAME
+#undef TL_NO_ZERO_MEM
+#undef TL_KEY_IS_INT
+#undef TL_SEEDED_HASH
+#endif
+#undef fmap_key_equalsfn
+#undef fmap_key_copyfn
+#undef fmap_value_copyfn
+#undef TL_FMAP_VALUE_ARRAY
+#undef TL_FMAP_KEY_ARRAY
 #undef TL_V
 #undef TL_K
@@ -0,0 +1,710 @@
+/**
+ * Indexmap is an insertion ordered map. Entries live densely in an array, in the order they were first inserted, and
+ * a separate hash index maps each key to the position of its entry.
+ *
+ * The index uses the flatmap layout: a power of 2 number of buckets, log2n(num_buckets) slots per bucket, probed
+ * linearly. Each slot only holds the 32 bit position of an entry, so the index is much smaller than flatmap nodes and
+ * is rebuilt from the entries (using their stored hash) when it grows.
+ *
+ *   Entries (struct array_)            Index
+ * [(k1,v1)(k2,v2)(k3,v3)...]       |(2)(-)(-)|(0)(3)(-)|(1)(-)(-)|....
+ *
+ * Iterating is a walk over im->entries.data from 0 to im->entries.size, in insertion order.
+ *
+ * We provide the same 2 hashing functions as flatmap:
+ * tlhash_ntfnv1a(key)		- Hash till reaching a null terminator value (good for c strings)
+ * imap_<TL_NAME>_fnv1a(key)	- Hash for the sizeof(TL_K)
+ *
+ * Note:
+ * -Must define TL_K to set the key type
+ * -Must define TL_V to set the value type
+ * -An indexmap holds at most 2^32 - 1 entries
+ *
+ * -All user #define are consumed by the #include and must be redefined again to include again!
+ *
+ * Options:
+ * -Define imap_key_equalsfn(left,right) to override the key equality test behavior
+ * 	-Default behavior is a simple equality operator
+ * -Define imap_hashfn(key) to provide your own hashing function (must accept key type and return size_t)
+ * 	-Default is provided imap_<TL_NAME>_fnv1a
+ * -Define TL_NAME to set the provided name
+ * 	-Default is to concatenate the TL_K and TL_V values
+ * -Define TL_NO_ZERO_MEM to stop the zeroing of memory in non-critical code
+ * -Define TL_KEY_IS_NT to use the provided tlhash_ntfnv1a(key) instead of imap_<TL_NAME>_fnv1a(key)
+ * -Define TL_KEY_IS_INT when TL_K is an integer type to use the provided imap_<TL_NAME>_murmurhash(key) instead of
+ * 	imap_<TL_NAME>_fnv1a(key)
+ *
+ *
+ * Examples:
+ *
+ * ---------- Example with primitive types:
+ * #define TL_K int
+ * #define TL_V int
+ * #include <indexmap.h>
+ *
+ * struct imap_intint im;
+ * imap_intint_init(&im);
+ * imap_intint_insert(&im, 4, 40);
+ * for (size_t i = 0; i < im.entries.size; i++) {
+ * 	printf("%d=%d\n", im.entries.data[i].key, im.entries.data[i].value);
+ * }
+ * imap_intint_deinit(&im);
+ *
+ *
+ * ---------- Example with a string key:
+ * #define TL_KEY_IS_NT
+ * #define imap_key_equalsfn(left, right) (strcmp((left), (right)) == 0)
+ * #define TL_K char*
+ * #define TL_V int
+ * #define TL_NAME str
+ * #include <indexmap.h>
+ */
+
+#ifndef TL_K
+#error "TL_K not defined for indexmap.h"
+#endif
+
+#ifndef TL_V
+#error "TL_V not defined for indexmap.h"
+#endif
+
+#include <stdint.h>
+
+#include "private/common.h"
+#include "private/utility.h"
+
+#ifndef TL_NAME
+#define TL_NAME TLCONCAT(TL_K,TL_V)
+#endif
+
+#define _PFX TLSYMBOL(imap,TL_NAME)
+
+/**
+ * imap_<TL_NAME>_entry
+ * indexmap entry containing a key, value pair and the hash of the key.
+ */
+struct TLSYMBOL(_PFX, entry)
+{
+	TL_K key;
+	TL_V value;
+	size_t hash;
+};
+
+/**
+ * imap_<TL_NAME>_entries
+ * The entry array, an array.h instantiation providing the imap_<TL_NAME>_entries_* functions.
+ */
+#undef _PFX
+#define TL_T struct TLSYMBOL(TLSYMBOL(imap,TL_NAME), entry)
+#define TL_ARRAY_PFX TLSYMBOL(TLSYMBOL(imap,TL_NAME), entries)
+#include "array.h"
+#define _PFX TLSYMBOL(imap,TL_NAME)
+
+/**
+ * Ensures that the key comparison is a simple equality check
+ */
+#ifndef imap_key_equalsfn
+#define imap_key_equalsfn(left, right) (left) == (right)
+#endif
+
+#include "private/hash_algorithm.h"
+
+/** Enable user provided hash function */
+#ifndef imap_hashfn
+#  ifdef TL_KEY_IS_NT
+#    define imap_hashfn(key) tlhash_ntfnv1a(key)
+#  elif defined(TL_KEY_IS_INT)
+#    define imap_hashfn(key) TLSYMBOL(_PFX,murmurhash)(key)
+#  else
+#    define imap_hashfn(key) TLSYMBOL(_PFX,fnv1a)(key)
+#  endif
+#endif
+
+#define TL_IMAP_DEFAULT_BUCKET_COUNT 8u
+#define TL_IMAP_DEFAULT_LOAD_FACTOR 70u
+#define TL_IMAP_EMPTY UINT32_MAX
+
+
+/**
+ * entries     - (public) The entries in insertion order. entries.size is the number of elements in the map. Read only!
+ * num_buckets - (private) The number of index buckets
+ * bucket_max  - (private) Max entry positions in each bucket
+ * capacity    - (private) The total positions the index can hold (num_buckets * bucket_max)
+ * load_max    - (private) The total elements before the index should grow
+ * slot_mask   - (private) The mask used to transform a hash to a bucket index
+ * load_factor - (private) The fill percentage (0-100) to target before growth
+ * index       - (private) The entry position held by each slot, TL_IMAP_EMPTY when the slot is free
+ */
+struct _PFX
+{
+	struct TLSYMBOL(_PFX, entries) entries;
+	size_t num_buckets;
+	size_t bucket_max;
+	size_t capacity;
+	size_t load_max;
+	size_t slot_mask;
+	size_t load_factor;
+	uint32_t* index;
+};
+
+
+/**
+ * index_build is for internal use only
+ * Build an index of new_buckets buckets over every entry. Returns NULL when memory could not be acquired and sets
+ * *out_overflow when a bucket overflowed (a larger index is required).
+ */
+static inline uint32_t*
+TLSYMBOL(_PFX, index_build)(const struct _PFX* im, const size_t new_buckets, int* out_overflow)
+{
+	const size_t bucket_max = tl_util_log2n(new_buckets);
+	const size_t capacity = new_buckets * bucket_max;
+	const size_t mask = new_buckets - 1;
+
+	*out_overflow = 0;
+	uint32_t* index = tlmalloc_large(capacity * sizeof(uint32_t));
+	if (!index)
+		return NULL;
+
+	tlmemset(index, 0xff, capacity * sizeof(uint32_t));
+	for (size_t i = 0; i < im->entries.size; i++) {
+		const size_t base = (im->entries.data[i].hash & mask) * bucket_max;
+		size_t slot;
+
+		for (slot = 0; slot < bucket_max && index[base + slot] != TL_IMAP_EMPTY; slot++);
+		if (slot == bucket_max) {
+			*out_overflow = 1;
+			break;
+		}
+		index[base + slot] = (uint32_t)i;
+	}
+	return index;
+}
+
+/**
+ * resize is for internal use only
+ * Replace the index with one of at least new_buckets buckets (a power of 2). On failure the original map state is
+ * untouched.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, resize)(struct _PFX* im, size_t new_buckets)
+{
+	uint32_t* index;
+	int overflow;
+
+	for (;;) {
+		index = TLSYMBOL(_PFX, index_build)(im, new_buckets, &overflow);
+		if (!index)
+			return TL_ERR_MEM;
+		if (!overflow)
+			break;
+
+		tlfree_large(index, new_buckets * tl_util_log2n(new_buckets) * sizeof(uint32_t));
+		new_buckets <<= 1;
+	}
+
+	tlfree_large(im->index, im->capacity * sizeof(uint32_t));
+	im->index = index;
+	im->num_buckets = new_buckets;
+	im->bucket_max = tl_util_log2n(new_buckets);
+	im->capacity = new_buckets * im->bucket_max;
+	im->slot_mask = new_buckets - 1;
+	im->load_max = (im->capacity * im->load_factor) / 100u;
+	return TLOK;
+}
+
+/**
+ * find is for internal use only
+ * Probe the bucket of hash for key. Returns TLOK with the slot holding the key, TL_ENF with the first free slot of the
+ * bucket or TL_OOB when the key is absent and the bucket is full.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, find)(const struct _PFX* im, const size_t hash, TL_K key, size_t* out_slot)
+{
+	const size_t base = (hash & im->slot_mask) * im->bucket_max;
+
+	for (size_t slot = base; slot < base + im->bucket_max; slot++) {
+		const uint32_t at = im->index[slot];
+		if (at == TL_IMAP_EMPTY) {
+			*out_slot = slot;
+			return TL_ENF;
+		}
+
+		const struct TLSYMBOL(_PFX, entry)* entry = &im->entries.data[at];
+		if (entry->hash == hash && imap_key_equalsfn(entry->key, key)) {
+			*out_slot = slot;
+			return TLOK;
+		}
+	}
+	return TL_OOB;
+}
+
+/**
+ * unlink is for internal use only
+ * Free an index slot, keeping the positions of its bucket contiguous from the first slot.
+ */
+static inline void
+TLSYMBOL(_PFX, unlink)(struct _PFX* im, const size_t slot)
+{
+	const size_t end = slot - (slot % im->bucket_max) + im->bucket_max;
+	size_t last = slot;
+
+	while (last + 1 < end && im->index[last + 1] != TL_IMAP_EMPTY) last++;
+
+	im->index[slot] = im->index[last];
+	im->index[last] = TL_IMAP_EMPTY;
+}
+
+/**
+ * reindex is for internal use only
+ * Point the index slot of the entry at position from to position to.
+ */
+static inline void
+TLSYMBOL(_PFX, reindex)(struct _PFX* im, const uint32_t from, const uint32_t to)
+{
+	size_t slot = (im->entries.data[from].hash & im->slot_mask) * im->bucket_max;
+
+	while (im->index[slot] != from) slot++;
+	im->index[slot] = to;
+}
+
+
+/**
+ * imap_<TL_NAME>_init_all
+ * Initialize a imap_<TL_NAME> struct fields, allowing the user to provide configuration.
+ *
+ * Note:
+ * -That the num_buckets isn't the capacity. Index capacity is calculated (num_buckets * (log2n(num_buckets))
+ *
+ * @param im the imap_<TL_NAME> to initialize
+ * @param num_buckets the number of index buckets to initialize with
+ * @param load_factor 0 - 100. whole number percentage of capacity to target before growing automatically. 70 is default.
+ * @return
+ * 	TLOK on successful initialization
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, init_all)(struct _PFX* im, const size_t num_buckets, const size_t load_factor)
+{
+	assert(im != NULL);
+	assert(num_buckets > 1u);
+	assert(load_factor <= 100);
+
+	const size_t buckets = tl_util_npot(num_buckets);
+	const size_t bucket_max = tl_util_log2n(buckets);
+	const size_t capacity = buckets * bucket_max;
+	const size_t factor = (load_factor != 0) ? load_factor : TL_IMAP_DEFAULT_LOAD_FACTOR;
+	const size_t load_max = (capacity * factor) / 100u;
+
+	if (TLSYMBOL(_PFX, entries_init_all)(&im->entries, (load_max > 1u) ? load_max : 2u, 2u) != TLOK)
+		return TL_ERR_MEM;
+
+	im->index = tlmalloc_large(capacity * sizeof(uint32_t));
+	if (!im->index) {
+		TLSYMBOL(_PFX, entries_deinit)(&im->entries);
+		return TL_ERR_MEM;
+	}
+	tlmemset(im->index, 0xff, capacity * sizeof(uint32_t));
+
+	im->num_buckets = buckets;
+	im->bucket_max = bucket_max;
+	im->capacity = capacity;
+	im->load_max = load_max;
+	im->slot_mask = buckets - 1;
+	im->load_factor = factor;
+	return TLOK;
+}
+
+
+/**
+ * imap_<TL_NAME>_init
+ * Initialize a imap_<TL_NAME> using default values.
+ *
+ * Note:
+ * -Default number of buckets is 8
+ * -Default load factor is 70
+ *
+ * @param im The imap_<TL_NAME> to initialize
+ * @return
+ * 	TLOK on successful initialization
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, init)(struct _PFX* im)
+{
+	return TLSYMBOL(_PFX, init_all)(im, TL_IMAP_DEFAULT_BUCKET_COUNT, TL_IMAP_DEFAULT_LOAD_FACTOR);
+}
+
+
+/**
+ * imap_<TL_NAME>_deinit
+ * Deinitialize an initialized imap_<TL_NAME>. Deinitialization frees the entries and the index.
+ *
+ * Note:
+ * -Keys and Values are *not* freed. The user must do so.
+ *
+ * @param im The imap_<TL_NAME> to deinitialize
+ */
+static inline void
+TLSYMBOL(_PFX, deinit)(struct _PFX* im)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	const size_t capacity = im->capacity;
+	TLSYMBOL(_PFX, entries_deinit)(&im->entries);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(im->index, TL_INIT_VAL, capacity * sizeof(uint32_t));
+	im->num_buckets = 0u;
+	im->bucket_max = 0u;
+	im->capacity = 0u;
+	im->load_max = 0u;
+	im->slot_mask = 0u;
+	im->load_factor = 0u;
+#endif
+	tlfree_large(im->index, capacity * sizeof(uint32_t));
+	im->index = NULL;
+}
+
+
+/**
+ * imap_<TL_NAME>_new
+ * Heap allocate and initialize a new imap_<TL_NAME> with default values and then return a pointer to it.
+ *
+ * @return
+ * 	Pointer to a imap_<TL_NAME> struct on success
+ * 	NULL if any error occurred acquiring memory
+ */
+static inline struct _PFX*
+TLSYMBOL(_PFX, new)(void)
+{
+	struct _PFX* tmp = tlmalloc(sizeof(struct _PFX));
+	if (!tmp)
+		return NULL;
+
+	if (TLSYMBOL(_PFX, init)(tmp) != TLOK) {
+		tlfree(tmp);
+		return NULL;
+	}
+	return tmp;
+}
+
+
+/**
+ * imap_<TL_NAME>_delete
+ * Deinitialize and delete a heap allocated imap_<TL_NAME>. The given pointer is set to NULL.
+ *
+ * Note:
+ * -Keys and Values are *not* freed. The user must do so.
+ *
+ * @param im The imap_<TL_NAME> to delete.
+ */
+static inline void
+TLSYMBOL(_PFX, delete)(struct _PFX** im)
+{
+	assert(*im != NULL);
+
+	TLSYMBOL(_PFX, deinit)(*im);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(*im, TL_INIT_VAL, sizeof(struct _PFX));
+#endif
+	tlfree(*im);
+	*im = NULL;
+}
+
+
+/**
+ * imap_<TL_NAME>_reserve
+ * Grow the entries and the index, at most once each, so that count elements fit without reaching the load factor.
+ *
+ * @param im The imap_<TL_NAME> to reserve space in
+ * @param count The total number of elements the map should be able to hold
+ * @return
+ * 	TLOK when the map can hold count elements
+ * 	TL_ERR_MEM when there is an issue acquiring new memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, reserve)(struct _PFX* im, const size_t count)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	if (count > im->entries.capacity
+	    && TLSYMBOL(_PFX, entries_ensure_capacity)(&im->entries, count) == TL_ERR_MEM)
+		return TL_ERR_MEM;
+
+	if (count <= im->load_max)
+		return TLOK;
+
+	size_t buckets = im->num_buckets;
+	while (((buckets * tl_util_log2n(buckets)) * im->load_factor) / 100u < count) {
+		buckets <<= 1;
+	}
+	return TLSYMBOL(_PFX, resize)(im, buckets);
+}
+
+
+/**
+ * put is for internal use only
+ * Shared body of add and insert. Returns TL_EAE when the key exists and replace is 0.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, put)(struct _PFX* im, TL_K key, TL_V value, const int replace)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	if (im->entries.size >= im->load_max) {
+		if (TLSYMBOL(_PFX, resize)(im, im->num_buckets << 1) != TLOK)
+			return TL_ERR_MEM;
+	}
+
+	const size_t hash = imap_hashfn(key);
+	size_t slot = 0;
+
+	RETRY_PUT:
+	switch (TLSYMBOL(_PFX, find)(im, hash, key, &slot)) {
+	case TLOK:
+		if (!replace)
+			return TL_EAE;
+		im->entries.data[im->index[slot]].value = value;
+		return TLOK;
+	case TL_ENF: {
+		if (im->entries.size >= TL_IMAP_EMPTY)
+			return TL_OOB;
+
+		const struct TLSYMBOL(_PFX, entry) entry = {key, value, hash};
+		if (TLSYMBOL(_PFX, entries_append)(&im->entries, entry) != TLOK)
+			return TL_ERR_MEM;
+
+		im->index[slot] = (uint32_t)(im->entries.size - 1);
+		return TLOK;
+	}
+	case TL_OOB:
+		if (TLSYMBOL(_PFX, resize)(im, im->num_buckets << 1) != TLOK)
+			return TL_ERR_MEM;
+
+		goto RETRY_PUT;
+	default:
+		return TL_ERROR;
+	}
+}
+
+
+/**
+ * imap_<TL_NAME>_add
+ * Append a new key/value pair to the given imap_<TL_NAME> -- if the given key already exists, do nothing.
+ *
+ * @param im The imap_<TL_NAME> to add the key/value pair to.
+ * @param key The key
+ * @param value The value
+ * @return
+ * 	TLOK on success
+ * 	TL_ERR_MEM if a grow was caused and there was an issue acquirining memory
+ * 	TL_EAE if the key already exists
+ * 	TL_OOB if the map already holds the maximum number of entries
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, add)(struct _PFX* im, TL_K key, TL_V value)
+{
+	return TLSYMBOL(_PFX, put)(im, key, value, 0);
+}
+
+
+/**
+ * imap_<TL_NAME>_insert
+ * Append a new key/value pair to the map, or replace the value of a given key if it already exists. A replaced value
+ * keeps the original position of its key.
+ *
+ * @param im The imap_<TL_NAME> to add the key/value pair to
+ * @param key The key to add
+ * @param value The value to add
+ * @return
+ * 	TLOK upon success
+ * 	TL_ERR_MEM if there was an issue growing the entries or the index
+ * 	TL_OOB if the map already holds the maximum number of entries
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, insert)(struct _PFX* im, TL_K key, TL_V value)
+{
+	return TLSYMBOL(_PFX, put)(im, key, value, 1);
+}
+
+
+/**
+ * imap_<TL_NAME>_index_of
+ * Acquire the position of a key in insertion order, which is its index in im->entries.data.
+ *
+ * @param im The imap_<TL_NAME> to search
+ * @param key The key to use for lookup
+ * @param out_index --Out-- The position of the entry for key
+ * @return
+ * 	TLOK when the key was found
+ * 	TL_ENF when the key was not found
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, index_of)(const struct _PFX* im, TL_K key, size_t* out_index)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	size_t slot = 0;
+	if (TLSYMBOL(_PFX, find)(im, imap_hashfn(key), key, &slot) != TLOK)
+		return TL_ENF;
+
+	*out_index = im->index[slot];
+	return TLOK;
+}
+
+
+/**
+ * imap_<TL_NAME>_try_get
+ * Acquire a value for a given key out of the indexmap and set out_value from the found value.
+ *
+ * @param im The imap_<TL_NAME> to acquire the value from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- The value found for the given key
+ * @return
+ * 	TLOK when the key was found
+ * 	TL_ENF when the key was not found
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, try_get)(const struct _PFX* im, TL_K key, TL_V* out_value)
+{
+	size_t at = 0;
+
+	if (TLSYMBOL(_PFX, index_of)(im, key, &at) != TLOK)
+		return TL_ENF;
+
+	*out_value = im->entries.data[at].value;
+	return TLOK;
+}
+
+
+/**
+ * imap_<TL_NAME>_get
+ * Returns the value for a given key or 0 if the key was not found.
+ *
+ * Note:
+ * -This function is not suitable if 0 is a valid value for you! use imap_<TL_NAME>_try_get instead.
+ *
+ * @param im The imap_<TL_NAME> to get a value from
+ * @param key The key to use for lookup
+ * @return The value paired with the given key
+ */
+static inline TL_V
+TLSYMBOL(_PFX, get)(const struct _PFX* im, TL_K key)
+{
+	TL_V value;
+
+	if (TLSYMBOL(_PFX, try_get)(im, key, &value) != TLOK)
+		tlmemset(&value, TL_INIT_VAL, sizeof(TL_V));
+
+	return value;
+}
+
+
+/**
+ * imap_<TL_NAME>_swap_remove
+ * Remove a key/value pair in O(1) by moving the last entry into its position. This changes the order of the last
+ * entry; use imap_<TL_NAME>_shift_remove to keep the insertion order.
+ *
+ * @param im The imap_<TL_NAME> to remove an element from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- Receives the removed value. May be NULL.
+ * @return
+ * 	TLOK upon successful removal
+ * 	TL_ENF if the key was not found in the map. out_value will not be assigned.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, swap_remove)(struct _PFX* im, TL_K key, TL_V* out_value)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	size_t slot = 0;
+	if (TLSYMBOL(_PFX, find)(im, imap_hashfn(key), key, &slot) != TLOK)
+		return TL_ENF;
+
+	const uint32_t at = im->index[slot];
+	const uint32_t last = (uint32_t)(im->entries.size - 1);
+
+	if (out_value) *out_value = im->entries.data[at].value;
+	TLSYMBOL(_PFX, unlink)(im, slot);
+
+	if (at != last)
+		TLSYMBOL(_PFX, reindex)(im, last, at);
+
+	const struct TLSYMBOL(_PFX, entry) moved = TLSYMBOL(_PFX, entries_remove)(&im->entries, last);
+	if (at != last)
+		im->entries.data[at] = moved;
+
+	return TLOK;
+}
+
+
+/**
+ * imap_<TL_NAME>_shift_remove
+ * Remove a key/value pair while keeping the insertion order of every other entry. Every later entry moves down by one
+ * position, so this is O(n); use imap_<TL_NAME>_swap_remove when the order does not matter.
+ *
+ * @param im The imap_<TL_NAME> to remove an element from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- Receives the removed value. May be NULL.
+ * @return
+ * 	TLOK upon successful removal
+ * 	TL_ENF if the key was not found in the map. out_value will not be assigned.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, shift_remove)(struct _PFX* im, TL_K key, TL_V* out_value)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	size_t slot = 0;
+	if (TLSYMBOL(_PFX, find)(im, imap_hashfn(key), key, &slot) != TLOK)
+		return TL_ENF;
+
+	const uint32_t at = im->index[slot];
+
+	if (out_value) *out_value = im->entries.data[at].value;
+	TLSYMBOL(_PFX, unlink)(im, slot);
+	TLSYMBOL(_PFX, entries_erase)(&im->entries, at);
+
+	for (size_t i = 0; i < im->capacity; i++) {
+		const uint32_t pos = im->index[i];
+		if (pos != TL_IMAP_EMPTY && pos > at)
+			im->index[i] = pos - 1;
+	}
+	return TLOK;
+}
+
+
+/**
+ * imap_<TL_NAME>_clear
+ * Empty this map of all key/value pairs.
+ *
+ * @param im the imap_<TL_NAME> to clear
+ */
+static inline void
+TLSYMBOL(_PFX, clear)(struct _PFX* im)
+{
+	assert(im != NULL);
+	assert(im->index != NULL);
+
+	tlmemset(im->index, 0xff, im->capacity * sizeof(uint32_t));
+	TLSYMBOL(_PFX, entries_clear)(&im->entries);
+}
+
+
+
+#undef TL_IMAP_EMPTY
+#undef TL_IMAP_DEFAULT_LOAD_FACTOR
+#undef TL_IMAP_DEFAULT_BUCKET_COUNT
+#undef imap_hashfn
+#undef imap_key_equalsfn
+#undef _PFX
+#undef TL_NAME
+#undef TL_NO_ZERO_MEM
+#undef TL_KEY_IS_INT
+#undef TL_V
+#undef TL_K
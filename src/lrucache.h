@@ -0,0 +1,572 @@
+/**
+ * Lrucache is a fixed capacity least recently used cache. Every byte it will ever need is allocated by
+ * lru_<TL_NAME>_init, so a cache in steady state (put, get, evict) never calls the allocator.
+ *
+ * Entries live in one array of capacity elements. Each entry carries its key, value, hash and the prev/next positions
+ * of the recency list, so there is no separate list node and a hit is a single lookup. The index next to it holds 32 bit
+ * entry positions in a power of 2 table of at least twice the capacity. It is probed linearly across the whole table
+ * (instead of per bucket like flatmap) so that it can never overflow and never has to grow, and deletions shift the
+ * following positions back instead of leaving tombstones.
+ *
+ *   Entries                                    Index
+ * [(k1,v1,prev,next)(k2,v2,prev,next)...]    [(1)(-)(0)(-)(-)(2)...]
+ *  head (most recent) -> ... -> tail (least recent, evicted first)
+ *
+ * We provide the same 2 hashing functions as flatmap:
+ * tlhash_ntfnv1a(key)		- Hash till reaching a null terminator value (good for c strings)
+ * lru_<TL_NAME>_fnv1a(key)	- Hash for the sizeof(TL_K)
+ *
+ * Note:
+ * -Must define TL_K to set the key type
+ * -Must define TL_V to set the value type
+ * -Capacity is limited to 2^31 - 1 entries
+ *
+ * -All user #define are consumed by the #include and must be redefined again to include again!
+ *
+ * Options:
+ * -Define lru_key_equalsfn(left,right) to override the key equality test behavior
+ * 	-Default behavior is a simple equality operator
+ * -Define lru_hashfn(key) to provide your own hashing function (must accept key type and return size_t)
+ * 	-Default is provided lru_<TL_NAME>_fnv1a
+ * -Define TL_NAME to set the provided name
+ * 	-Default is to concatenate the TL_K and TL_V values
+ * -Define TL_NO_ZERO_MEM to stop the zeroing of memory in non-critical code
+ * -Define TL_KEY_IS_NT to use the provided tlhash_ntfnv1a(key) instead of lru_<TL_NAME>_fnv1a(key)
+ * -Define TL_KEY_IS_INT when TL_K is an integer type to use the provided lru_<TL_NAME>_murmurhash(key) instead of
+ * 	lru_<TL_NAME>_fnv1a(key)
+ *
+ *
+ * Examples:
+ *
+ * ---------- Example with primitive types:
+ * static void on_evict(int key, int value, void* ctx) { ... }
+ *
+ * #define TL_K int
+ * #define TL_V int
+ * #include <lrucache.h>
+ *
+ * struct lru_intint cache;
+ * lru_intint_init(&cache, 1024, on_evict, NULL);
+ * lru_intint_put(&cache, 1, 10);
+ * lru_intint_try_get(&cache, 1, &value);
+ * lru_intint_deinit(&cache);
+ */
+
+#ifndef TL_K
+#error "TL_K not defined for lrucache.h"
+#endif
+
+#ifndef TL_V
+#error "TL_V not defined for lrucache.h"
+#endif
+
+#include <stdint.h>
+
+#include "private/common.h"
+#include "private/utility.h"
+
+#ifndef TL_NAME
+#define TL_NAME TLCONCAT(TL_K,TL_V)
+#endif
+
+#define _PFX TLSYMBOL(lru,TL_NAME)
+
+/**
+ * Ensures that the key comparison is a simple equality check
+ */
+#ifndef lru_key_equalsfn
+#define lru_key_equalsfn(left, right) (left) == (right)
+#endif
+
+#include "private/hash_algorithm.h"
+
+/** Enable user provided hash function */
+#ifndef lru_hashfn
+#  ifdef TL_KEY_IS_NT
+#    define lru_hashfn(key) tlhash_ntfnv1a(key)
+#  elif defined(TL_KEY_IS_INT)
+#    define lru_hashfn(key) TLSYMBOL(_PFX,murmurhash)(key)
+#  else
+#    define lru_hashfn(key) TLSYMBOL(_PFX,fnv1a)(key)
+#  endif
+#endif
+
+#define TL_LRU_NIL UINT32_MAX
+#define TL_LRU_MAX_CAPACITY 0x7fffffffu
+
+
+/**
+ * lru_<TL_NAME>_entry
+ * lrucache entry containing a key, value pair, the hash of the key and its neighbours in the recency list.
+ */
+struct TLSYMBOL(_PFX, entry)
+{
+	TL_K key;
+	TL_V value;
+	size_t hash;
+	uint32_t prev;
+	uint32_t next;
+};
+
+/**
+ * lru_<TL_NAME>_evict_fn
+ * Called with each pair pushed out of a full cache by lru_<TL_NAME>_put. The cache must not be modified from within.
+ */
+typedef void TLSYMBOL(_PFX, evict_fn)(TL_K key, TL_V value, void* ctx);
+
+/**
+ * size        - (public) The number of elements currently in the cache
+ * capacity    - (public) The maximum number of elements. Read only!
+ * head        - (public) The most recently used entry, UINT32_MAX when empty. Follow entries[].next to iterate.
+ * tail        - (private) The least recently used entry, evicted first
+ * free        - (private) The first entry of the free list (linked through next)
+ * used        - (private) The number of entries ever handed out, entries past it have never been used
+ * index_mask  - (private) The index size minus 1
+ * entries     - (private) The entries
+ * index       - (private) The entry position held by each index slot, TL_LRU_NIL when the slot is free
+ * evict       - (private) The eviction callback, may be NULL
+ * evict_ctx   - (private) The context handed to evict
+ */
+struct _PFX
+{
+	size_t size;
+	size_t capacity;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t free;
+	uint32_t used;
+	size_t index_mask;
+	struct TLSYMBOL(_PFX, entry)* entries;
+	uint32_t* index;
+	TLSYMBOL(_PFX, evict_fn)* evict;
+	void* evict_ctx;
+};
+
+
+/**
+ * lru_<TL_NAME>_init
+ * Initialize a lru_<TL_NAME> and allocate everything it will ever need.
+ *
+ * @param lru The lru_<TL_NAME> to initialize
+ * @param capacity The maximum number of elements (1 to 2^31 - 1)
+ * @param evict Called with every pair evicted by lru_<TL_NAME>_put. May be NULL.
+ * @param evict_ctx Passed to every call of evict
+ * @return
+ * 	TLOK on successful initialization
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, init)(struct _PFX* lru, const size_t capacity, TLSYMBOL(_PFX, evict_fn)* evict, void* evict_ctx)
+{
+	assert(lru != NULL);
+	assert(capacity > 0u);
+	assert(capacity <= TL_LRU_MAX_CAPACITY);
+
+	const size_t index_size = tl_util_npot(capacity * 2u);
+
+	lru->entries = tlmalloc_large(capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+	if (!lru->entries)
+		return TL_ERR_MEM;
+
+	lru->index = tlmalloc_large(index_size * sizeof(uint32_t));
+	if (!lru->index) {
+		tlfree_large(lru->entries, capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+		return TL_ERR_MEM;
+	}
+
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(lru->entries, TL_INIT_VAL, capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+#endif
+	tlmemset(lru->index, 0xff, index_size * sizeof(uint32_t));
+	lru->size = 0u;
+	lru->capacity = capacity;
+	lru->head = TL_LRU_NIL;
+	lru->tail = TL_LRU_NIL;
+	lru->free = TL_LRU_NIL;
+	lru->used = 0u;
+	lru->index_mask = index_size - 1u;
+	lru->evict = evict;
+	lru->evict_ctx = evict_ctx;
+	return TLOK;
+}
+
+
+/**
+ * lru_<TL_NAME>_deinit
+ * Deinitialize an initialized lru_<TL_NAME>. Deinitialization frees the backing memory stores without calling the
+ * eviction callback.
+ *
+ * Note:
+ * -Keys and Values are *not* freed. The user must do so.
+ *
+ * @param lru The lru_<TL_NAME> to deinitialize
+ */
+static inline void
+TLSYMBOL(_PFX, deinit)(struct _PFX* lru)
+{
+	assert(lru != NULL);
+	assert(lru->entries != NULL);
+	assert(lru->index != NULL);
+
+	const size_t entry_bytes = lru->capacity * sizeof(struct TLSYMBOL(_PFX, entry));
+	const size_t index_bytes = (lru->index_mask + 1u) * sizeof(uint32_t);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(lru->entries, TL_INIT_VAL, entry_bytes);
+	tlmemset(lru->index, TL_INIT_VAL, index_bytes);
+	lru->size = 0u;
+	lru->capacity = 0u;
+	lru->index_mask = 0u;
+#endif
+	tlfree_large(lru->entries, entry_bytes);
+	tlfree_large(lru->index, index_bytes);
+	lru->entries = NULL;
+	lru->index = NULL;
+}
+
+
+/**
+ * lru_<TL_NAME>_new
+ * Heap allocate and initialize a new lru_<TL_NAME> and then return a pointer to it.
+ *
+ * @param capacity The maximum number of elements (1 to 2^31 - 1)
+ * @param evict Called with every pair evicted by lru_<TL_NAME>_put. May be NULL.
+ * @param evict_ctx Passed to every call of evict
+ * @return
+ * 	Pointer to a lru_<TL_NAME> struct on success
+ * 	NULL if any error occurred acquiring memory
+ */
+static inline struct _PFX*
+TLSYMBOL(_PFX, new)(const size_t capacity, TLSYMBOL(_PFX, evict_fn)* evict, void* evict_ctx)
+{
+	struct _PFX* tmp = tlmalloc(sizeof(struct _PFX));
+	if (!tmp)
+		return NULL;
+
+	if (TLSYMBOL(_PFX, init)(tmp, capacity, evict, evict_ctx) != TLOK) {
+		tlfree(tmp);
+		return NULL;
+	}
+	return tmp;
+}
+
+
+/**
+ * lru_<TL_NAME>_delete
+ * Deinitialize and delete a heap allocated lru_<TL_NAME>. The given pointer is set to NULL.
+ *
+ * @param lru The lru_<TL_NAME> to delete.
+ */
+static inline void
+TLSYMBOL(_PFX, delete)(struct _PFX** lru)
+{
+	assert(*lru != NULL);
+
+	TLSYMBOL(_PFX, deinit)(*lru);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(*lru, TL_INIT_VAL, sizeof(struct _PFX));
+#endif
+	tlfree(*lru);
+	*lru = NULL;
+}
+
+
+/**
+ * find is for internal use only
+ * Returns TLOK with the index slot holding key, or TL_ENF with the free slot that ends its probe sequence.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, find)(const struct _PFX* lru, const size_t hash, TL_K key, size_t* out_slot)
+{
+	size_t slot = hash & lru->index_mask;
+
+	for (;;) {
+		const uint32_t at = lru->index[slot];
+		if (at == TL_LRU_NIL) {
+			*out_slot = slot;
+			return TL_ENF;
+		}
+
+		const struct TLSYMBOL(_PFX, entry)* entry = &lru->entries[at];
+		if (entry->hash == hash && lru_key_equalsfn(entry->key, key)) {
+			*out_slot = slot;
+			return TLOK;
+		}
+		slot = (slot + 1u) & lru->index_mask;
+	}
+}
+
+/**
+ * unindex is for internal use only
+ * Free an index slot and shift the rest of its probe run back so that no tombstone is needed.
+ */
+static inline void
+TLSYMBOL(_PFX, unindex)(struct _PFX* lru, size_t slot)
+{
+	const size_t mask = lru->index_mask;
+	size_t next = slot;
+
+	for (;;) {
+		next = (next + 1u) & mask;
+		const uint32_t at = lru->index[next];
+		if (at == TL_LRU_NIL)
+			break;
+
+		/* move it back unless its home lies cyclically in (slot, next] */
+		const size_t home = lru->entries[at].hash & mask;
+		if (((next - home) & mask) >= ((next - slot) & mask)) {
+			lru->index[slot] = at;
+			slot = next;
+		}
+	}
+	lru->index[slot] = TL_LRU_NIL;
+}
+
+/**
+ * unlink is for internal use only
+ * Take an entry out of the recency list.
+ */
+static inline void
+TLSYMBOL(_PFX, unlink)(struct _PFX* lru, const uint32_t at)
+{
+	struct TLSYMBOL(_PFX, entry)* entry = &lru->entries[at];
+
+	if (entry->prev != TL_LRU_NIL) lru->entries[entry->prev].next = entry->next;
+	else lru->head = entry->next;
+
+	if (entry->next != TL_LRU_NIL) lru->entries[entry->next].prev = entry->prev;
+	else lru->tail = entry->prev;
+}
+
+/**
+ * link_front is for internal use only
+ * Make an entry the most recently used.
+ */
+static inline void
+TLSYMBOL(_PFX, link_front)(struct _PFX* lru, const uint32_t at)
+{
+	struct TLSYMBOL(_PFX, entry)* entry = &lru->entries[at];
+
+	entry->prev = TL_LRU_NIL;
+	entry->next = lru->head;
+	if (lru->head != TL_LRU_NIL) lru->entries[lru->head].prev = at;
+	else lru->tail = at;
+	lru->head = at;
+}
+
+
+/**
+ * lru_<TL_NAME>_try_get
+ * Acquire a value for a given key and mark the key as the most recently used.
+ *
+ * @param lru The lru_<TL_NAME> to acquire the value from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- The value found for the given key
+ * @return
+ * 	TLOK when the key was found
+ * 	TL_ENF when the key was not found
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, try_get)(struct _PFX* lru, TL_K key, TL_V* out_value)
+{
+	assert(lru != NULL);
+	assert(lru->entries != NULL);
+
+	size_t slot;
+	if (TLSYMBOL(_PFX, find)(lru, lru_hashfn(key), key, &slot) != TLOK)
+		return TL_ENF;
+
+	const uint32_t at = lru->index[slot];
+	if (lru->head != at) {
+		TLSYMBOL(_PFX, unlink)(lru, at);
+		TLSYMBOL(_PFX, link_front)(lru, at);
+	}
+
+	*out_value = lru->entries[at].value;
+	return TLOK;
+}
+
+
+/**
+ * lru_<TL_NAME>_get
+ * Returns the value for a given key, marking the key as the most recently used, or 0 if the key was not found.
+ *
+ * Note:
+ * -This function is not suitable if 0 is a valid value for you! use lru_<TL_NAME>_try_get instead.
+ *
+ * @param lru The lru_<TL_NAME> to get a value from
+ * @param key The key to use for lookup
+ * @return The value paired with the given key
+ */
+static inline TL_V
+TLSYMBOL(_PFX, get)(struct _PFX* lru, TL_K key)
+{
+	TL_V value;
+
+	if (TLSYMBOL(_PFX, try_get)(lru, key, &value) != TLOK)
+		tlmemset(&value, TL_INIT_VAL, sizeof(TL_V));
+
+	return value;
+}
+
+
+/**
+ * lru_<TL_NAME>_peek
+ * Acquire a value for a given key without changing its recency.
+ *
+ * @param lru The lru_<TL_NAME> to acquire the value from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- The value found for the given key
+ * @return
+ * 	TLOK when the key was found
+ * 	TL_ENF when the key was not found
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, peek)(const struct _PFX* lru, TL_K key, TL_V* out_value)
+{
+	assert(lru != NULL);
+	assert(lru->entries != NULL);
+
+	size_t slot;
+	if (TLSYMBOL(_PFX, find)(lru, lru_hashfn(key), key, &slot) != TLOK)
+		return TL_ENF;
+
+	*out_value = lru->entries[lru->index[slot]].value;
+	return TLOK;
+}
+
+
+/**
+ * lru_<TL_NAME>_put
+ * Add a key/value pair, or replace the value of an existing key, and mark the key as the most recently used. When the
+ * cache is full the least recently used pair is evicted first and handed to the eviction callback.
+ *
+ * @param lru The lru_<TL_NAME> to add the key/value pair to
+ * @param key The key
+ * @param value The value
+ * @return
+ * 	TLOK when the key was added
+ * 	TL_EAE when the key already existed and its value was replaced
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, put)(struct _PFX* lru, TL_K key, TL_V value)
+{
+	assert(lru != NULL);
+	assert(lru->entries != NULL);
+
+	const size_t hash = lru_hashfn(key);
+	size_t slot;
+	uint32_t at;
+
+	if (TLSYMBOL(_PFX, find)(lru, hash, key, &slot) == TLOK) {
+		at = lru->index[slot];
+		lru->entries[at].value = value;
+		if (lru->head != at) {
+			TLSYMBOL(_PFX, unlink)(lru, at);
+			TLSYMBOL(_PFX, link_front)(lru, at);
+		}
+		return TL_EAE;
+	}
+
+	if (lru->size == lru->capacity) {
+		at = lru->tail;
+		struct TLSYMBOL(_PFX, entry)* victim = &lru->entries[at];
+		size_t victim_slot;
+
+		TLSYMBOL(_PFX, find)(lru, victim->hash, victim->key, &victim_slot);
+		TLSYMBOL(_PFX, unindex)(lru, victim_slot);
+		TLSYMBOL(_PFX, unlink)(lru, at);
+		lru->size--;
+		if (lru->evict)
+			lru->evict(victim->key, victim->value, lru->evict_ctx);
+
+		/* the shift may have moved the free slot found above */
+		TLSYMBOL(_PFX, find)(lru, hash, key, &slot);
+	} else if (lru->free != TL_LRU_NIL) {
+		at = lru->free;
+		lru->free = lru->entries[at].next;
+	} else {
+		at = lru->used++;
+	}
+
+	struct TLSYMBOL(_PFX, entry)* entry = &lru->entries[at];
+	entry->key = key;
+	entry->value = value;
+	entry->hash = hash;
+	lru->index[slot] = at;
+	TLSYMBOL(_PFX, link_front)(lru, at);
+	lru->size++;
+	return TLOK;
+}
+
+
+/**
+ * lru_<TL_NAME>_remove
+ * Remove a key/value pair from the cache without calling the eviction callback.
+ *
+ * @param lru The lru_<TL_NAME> to remove an element from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- Receives the removed value. May be NULL.
+ * @return
+ * 	TLOK upon successful removal
+ * 	TL_ENF if the key was not found. out_value will not be assigned.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, remove)(struct _PFX* lru, TL_K key, TL_V* out_value)
+{
+	assert(lru != NULL);
+	assert(lru->entries != NULL);
+
+	size_t slot;
+	if (TLSYMBOL(_PFX, find)(lru, lru_hashfn(key), key, &slot) != TLOK)
+		return TL_ENF;
+
+	const uint32_t at = lru->index[slot];
+	if (out_value) *out_value = lru->entries[at].value;
+
+	TLSYMBOL(_PFX, unindex)(lru, slot);
+	TLSYMBOL(_PFX, unlink)(lru, at);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(&lru->entries[at], TL_INIT_VAL, sizeof(struct TLSYMBOL(_PFX, entry)));
+#endif
+	lru->entries[at].next = lru->free;
+	lru->free = at;
+	lru->size--;
+	return TLOK;
+}
+
+
+/**
+ * lru_<TL_NAME>_clear
+ * Empty the cache without calling the eviction callback.
+ *
+ * @param lru the lru_<TL_NAME> to clear
+ */
+static inline void
+TLSYMBOL(_PFX, clear)(struct _PFX* lru)
+{
+	assert(lru != NULL);
+	assert(lru->entries != NULL);
+
+	tlmemset(lru->index, 0xff, (lru->index_mask + 1u) * sizeof(uint32_t));
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(lru->entries, TL_INIT_VAL, lru->capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+#endif
+	lru->size = 0u;
+	lru->head = TL_LRU_NIL;
+	lru->tail = TL_LRU_NIL;
+	lru->free = TL_LRU_NIL;
+	lru->used = 0u;
+}
+
+
+
+#undef TL_LRU_MAX_CAPACITY
+#undef TL_LRU_NIL
+#undef lru_hashfn
+#undef lru_key_equalsfn
+#undef _PFX
+#undef TL_NAME
+#undef TL_NO_ZERO_MEM
+#undef TL_KEY_IS_INT
+#undef TL_V
+#undef TL_K
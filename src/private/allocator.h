@@ -2,7 +2,7 @@
  * Enables user to provide custom allocators
  */
 #include <stdlib.h>        /* malloc, calloc, realloc */
-#include <string.h>        /* memset, memmove */
+#include <string.h>        /* memset, memmove, memcpy */
 
 
 #ifndef tlmalloc
@@ -25,6 +25,163 @@
 #endif
 
 
+/**
+ * Large allocations
+ * Containers acquire their backing stores through the *_large variants below. Unlike the plain allocator, the caller
+ * always passes the size of the block being released or resized, which lets an implementation pick a different
+ * mechanism per block. By default they map straight on to the allocator above.
+ *
+ * Options:
+ * -Define TL_HUGE_PAGES to back blocks of at least TL_HUGE_PAGE_THRESHOLD bytes with anonymous mmap memory, aligned
+ * 	to TL_HUGE_PAGE_SIZE and advised with MADV_HUGEPAGE. Smaller blocks still use tlmalloc and friends.
+ * 	-Default threshold is 32MiB, default huge page size is 2MiB
+ * -Define TL_HUGE_PAGES_HUGETLB as well to first try MAP_HUGETLB (reserved hugetlbfs pages), falling back to the
+ * 	transparent huge page path when none are available.
+ * -Define tlmalloc_large(size), tlcalloc_large(nmemb,size), tlrealloc_large(ptr,old_size,new_size) and
+ * 	tlfree_large(ptr,size) to provide your own.
+ *
+ * Note:
+ * -TL_HUGE_PAGES must be defined the same way for every template_lib include in a translation unit, since a block
+ * 	must be released by the same mechanism it was acquired with.
+ */
+#ifdef TL_HUGE_PAGES
+
+#ifndef TEMPLATE_LIB_HUGE_PAGES
+#define TEMPLATE_LIB_HUGE_PAGES
+
+#include <stdint.h>          /* SIZE_MAX */
+#include <sys/mman.h>        /* mmap, munmap, madvise */
+
+#ifndef TL_HUGE_PAGE_THRESHOLD
+#define TL_HUGE_PAGE_THRESHOLD ((size_t)32u * 1024u * 1024u)
+#endif
+#ifndef TL_HUGE_PAGE_SIZE
+#define TL_HUGE_PAGE_SIZE ((size_t)2u * 1024u * 1024u)
+#endif
+
+/**
+ * tl_huge_length is for internal use only
+ * Rounds a block size up to a whole number of huge pages.
+ */
+static inline size_t
+tl_huge_length(const size_t size)
+{
+	return (size + (TL_HUGE_PAGE_SIZE - 1u)) & ~(TL_HUGE_PAGE_SIZE - 1u);
+}
+
+/**
+ * tl_huge_map is for internal use only
+ * Maps a zeroed, huge page aligned block of tl_huge_length(size) bytes. Returns NULL on failure.
+ */
+static inline void*
+tl_huge_map(const size_t size)
+{
+	const size_t length = tl_huge_length(size);
+	unsigned char* ptr;
+
+#if defined(TL_HUGE_PAGES_HUGETLB) && defined(MAP_HUGETLB)
+	ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (ptr != MAP_FAILED)
+		return ptr;
+#endif
+
+	/* over-map by one huge page so the block can be trimmed down to a huge page boundary */
+	ptr = mmap(NULL, length + TL_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
+
+	const size_t head = (TL_HUGE_PAGE_SIZE - ((size_t)ptr & (TL_HUGE_PAGE_SIZE - 1u))) & (TL_HUGE_PAGE_SIZE - 1u);
+	if (head != 0)
+		munmap(ptr, head);
+	munmap(ptr + head + length, TL_HUGE_PAGE_SIZE - head);
+	ptr += head;
+
+#ifdef MADV_HUGEPAGE
+	madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+	return ptr;
+}
+
+static inline void*
+tl_huge_malloc(const size_t size)
+{
+	if (size < TL_HUGE_PAGE_THRESHOLD)
+		return tlmalloc(size);
+	return tl_huge_map(size);
+}
+
+static inline void*
+tl_huge_calloc(const size_t nmemb, const size_t size)
+{
+	if (size != 0 && nmemb > SIZE_MAX / size)
+		return NULL;
+	if (nmemb * size < TL_HUGE_PAGE_THRESHOLD)
+		return tlcalloc(nmemb, size);
+	return tl_huge_map(nmemb * size);        /* anonymous mappings are already zeroed */
+}
+
+static inline void
+tl_huge_free(void* ptr, const size_t size)
+{
+	if (size < TL_HUGE_PAGE_THRESHOLD) {
+		tlfree(ptr);
+		return;
+	}
+	munmap(ptr, tl_huge_length(size));
+}
+
+static inline void*
+tl_huge_realloc(void* ptr, const size_t old_size, const size_t new_size)
+{
+	if (old_size < TL_HUGE_PAGE_THRESHOLD && new_size < TL_HUGE_PAGE_THRESHOLD)
+		return tlrealloc(ptr, new_size);
+
+	if (old_size >= TL_HUGE_PAGE_THRESHOLD && new_size >= TL_HUGE_PAGE_THRESHOLD
+	    && tl_huge_length(old_size) == tl_huge_length(new_size))
+		return ptr;
+
+	void* tmp = tl_huge_malloc(new_size);
+	if (!tmp)
+		return NULL;
+
+	memcpy(tmp, ptr, (old_size < new_size) ? old_size : new_size);
+	tl_huge_free(ptr, old_size);
+	return tmp;
+}
+
+#endif //TEMPLATE_LIB_HUGE_PAGES
+
+#ifndef tlmalloc_large
+#define tlmalloc_large(size) tl_huge_malloc((size))
+#endif
+#ifndef tlcalloc_large
+#define tlcalloc_large(nmemb,size) tl_huge_calloc((nmemb),(size))
+#endif
+#ifndef tlrealloc_large
+#define tlrealloc_large(ptr,old_size,new_size) tl_huge_realloc((ptr),(old_size),(new_size))
+#endif
+#ifndef tlfree_large
+#define tlfree_large(ptr,size) tl_huge_free((ptr),(size))
+#endif
+
+#else
+
+#ifndef tlmalloc_large
+#define tlmalloc_large(size) tlmalloc((size))
+#endif
+#ifndef tlcalloc_large
+#define tlcalloc_large(nmemb,size) tlcalloc((nmemb),(size))
+#endif
+#ifndef tlrealloc_large
+#define tlrealloc_large(ptr,old_size,new_size) ((void)(old_size), tlrealloc((ptr),(new_size)))
+#endif
+#ifndef tlfree_large
+#define tlfree_large(ptr,size) ((void)(size), tlfree((ptr)))
+#endif
+
+#endif //TL_HUGE_PAGES
+
+
 /** todo: do some more testing to pick the implementation
  * --The macros most like more reliably compile to better code
  * --The static functions provide better type verification
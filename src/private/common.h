@@ -23,5 +23,14 @@
 #define TL_INIT_VAL 0x45
 #endif
 
+/**
+ * Hint that the cache line holding ptr will be read soon. ptr must point into (or one past) a live object.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define TL_PREFETCH(ptr) __builtin_prefetch((ptr))
+#else
+#define TL_PREFETCH(ptr) ((void)(ptr))
+#endif
+
 
 #endif //TEMPLATE_LIB_COMMON_H
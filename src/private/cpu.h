@@ -0,0 +1,149 @@
+#ifndef TEMPLATE_LIB_CPU_H
+#define TEMPLATE_LIB_CPU_H
+
+/**
+ * Runtime CPU feature detection for the SIMD kernels of the containers. One binary runs everywhere: each kernel is
+ * compiled for every instruction set it has a variant for (with per function target attributes, no -march needed) and
+ * each call picks the best one the running CPU supports from the features detected once by tl_cpu_features. Picking
+ * costs a few well predicted branches, and keeping no selection per kernel leaves nothing to synchronize when maps are
+ * used from several threads.
+ *
+ * The variants are only built by GCC and Clang for x86. Everything else, and any build defining TL_NO_SIMD, only gets
+ * the portable variant of each kernel.
+ *
+ * Kernels:
+ * -tl_map_used_bits (map_scan.h): the used slots of 64 map slot states, SSE2, AVX2 and AVX-512 variants
+ * -tlhash_fnv1a_many (hash_algorithm.h): fnv1a of many 4 or 8 byte keys side by side, AVX2 and AVX-512 variants
+ *
+ * There are no bucket probe or array.h kernels. A flatmap probe stops at the first empty slot of its bucket, mostly
+ * after 1 to 3 slot states, and compares keys through fmap_key_equalsfn: there is no fixed width tag per slot to
+ * compare in vector lanes. array.h elements are any TL_T compared through array_cmpfn, so there is no element width
+ * to vectorize over either.
+ *
+ * A kernel looks like this:
+ *
+ * static inline size_t
+ * tl_kernel(...)
+ * {
+ * 	if (tl_cpu_features() & TL_CPU_AVX2)
+ * 		return tl_kernel_avx2(...);
+ * 	return tl_kernel_portable(...);
+ * }
+ */
+
+#include <stdint.h>
+
+#if !defined(TL_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TL_CPU_X86 1
+#include <immintrin.h>
+#define TL_CPU_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+/**
+ * The detected features and the limit are shared by every thread. They are read and written with relaxed atomics:
+ * detection always yields the same value, so threads racing on the first call only store it twice. tlhash_seed counts
+ * its calls with TL_CPU_FETCH_ADD, which returns the value before the addition.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define TL_CPU_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define TL_CPU_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define TL_CPU_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#else
+#define TL_CPU_LOAD(ptr) (*(ptr))
+#define TL_CPU_STORE(ptr, value) (*(ptr) = (value))
+#define TL_CPU_FETCH_ADD(ptr, value) ((*(ptr) += (value)) - (value))
+#endif
+
+enum tl_cpu_feature
+{
+	TL_CPU_SSE2 = 1u << 0u,
+	TL_CPU_SSE42 = 1u << 1u,
+	TL_CPU_AVX2 = 1u << 2u,
+	TL_CPU_AVX512 = 1u << 3u,       /* AVX-512 F and BW */
+
+	TL_CPU_DETECTED = 1u << 31u     /* internal, marks the cached features as valid */
+};
+
+/**
+ * tl_cpu_detect is for internal use only
+ * Query the CPU (cpuid and the OS support for the wider registers) for the features we have kernels for.
+ */
+static inline unsigned
+tl_cpu_detect(void)
+{
+	unsigned features = 0;
+#ifdef TL_CPU_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) features |= TL_CPU_SSE2;
+	if (__builtin_cpu_supports("sse4.2")) features |= TL_CPU_SSE42;
+	if (__builtin_cpu_supports("avx2")) features |= TL_CPU_AVX2;
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) features |= TL_CPU_AVX512;
+#endif
+	return features;
+}
+
+/**
+ * tl_cpu_mask is for internal use only
+ */
+static inline unsigned*
+tl_cpu_mask(void)
+{
+	static unsigned mask = ~0u;
+	return &mask;
+}
+
+/**
+ * tl_cpu_features
+ * The tl_cpu_feature flags of the running CPU, detected on the first call. Always 0 without SIMD kernels.
+ *
+ * @return The supported features, limited by tl_cpu_limit
+ */
+static inline unsigned
+tl_cpu_features(void)
+{
+	static unsigned features = 0;
+	unsigned detected = TL_CPU_LOAD(&features);
+
+	if (!(detected & TL_CPU_DETECTED)) {
+		detected = tl_cpu_detect() | TL_CPU_DETECTED;
+		TL_CPU_STORE(&features, detected);
+	}
+	return detected & TL_CPU_LOAD(tl_cpu_mask()) & ~(unsigned)TL_CPU_DETECTED;
+}
+
+/**
+ * tl_cpu_limit
+ * Restrict the kernels to the given tl_cpu_feature flags (0 for the portable variants only, ~0u to lift the limit).
+ * Kernels follow from their next call on. Meant for tests and benchmarks comparing the variants.
+ *
+ * Note:
+ * -The features and the limit are kept per translation unit.
+ *
+ * @param mask The features the kernels may use
+ */
+static inline void
+tl_cpu_limit(const unsigned mask)
+{
+	TL_CPU_STORE(tl_cpu_mask(), mask);
+}
+
+/**
+ * tl_cpu_ctz64
+ * Count the trailing zero bits of a non zero word, for walking the bitmaps the kernels return.
+ *
+ * @param word The word, not 0
+ * @return The index of the lowest set bit
+ */
+static inline unsigned
+tl_cpu_ctz64(const uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctzll(word);
+#else
+	unsigned n = 0;
+	while (((word >> n) & 1u) == 0) n++;
+	return n;
+#endif
+}
+
+#endif //TEMPLATE_LIB_CPU_H
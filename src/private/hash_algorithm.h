@@ -23,13 +23,68 @@
 #endif
 
 
+#ifndef TEMPLATE_LIB_HASH_MIX
+#define TEMPLATE_LIB_HASH_MIX
+
+/**
+ * tlhash_mix
+ * Bijective finalizer (the murmur3 fmix) that spreads every bit of its input over every bit of its output. Cheap
+ * enough to derive further well distributed values from a single key hash.
+ *
+ * @param hash The value to mix
+ * @return The mixed value
+ */
+static inline size_t
+tlhash_mix(size_t hash)
+{
+#if (TL_SIZE_T_BYTES == 16)
+	hash ^= hash >> 33u;
+	hash *= 0xff51afd7ed558ccdu;
+	hash ^= hash >> 33u;
+	hash *= 0xc4ceb9fe1a85ec53u;
+	hash ^= hash >> 33u;
+#else
+	hash ^= hash >> 16u;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13u;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16u;
+#endif
+	return hash;
+}
+
+/**
+ * tlhash_high_bits
+ * The high half of hash * count, which for a power of 2 count are the top log2(count) bits of hash. Lets a table take
+ * its bucket from the high bits of a hash, where a multiplicative hash is strongest, without storing a shift.
+ *
+ * @param hash The hash
+ * @param count The number of buckets, a power of 2
+ * @return The bucket in [0, count)
+ */
+static inline size_t
+tlhash_high_bits(const size_t hash, const size_t count)
+{
+#if (TL_SIZE_T_BYTES == 16) && defined(__SIZEOF_INT128__)
+	return (size_t)(((unsigned __int128)hash * count) >> 64u);
+#elif (TL_SIZE_T_BYTES == 16)
+	size_t bits = 0;
+	while (((size_t)1u << bits) < count) bits++;
+	return (bits == 0) ? 0u : hash >> (64u - bits);
+#else
+	return (size_t)(((uint64_t)hash * count) >> 32u);
+#endif
+}
+
+#endif
+
 #ifndef TEMPLATE_LIB_NULL_TERMINATED_FNV1A
 #define TEMPLATE_LIB_NULL_TERMINATED_FNV1A
 
 static inline size_t
-tlhash_ntfnv1a(void* key)
+tlhash_ntfnv1a(const void* key)
 {
-	unsigned char* data = key;
+	const unsigned char* data = key;
 	size_t hash = TLHASH_FNV1A_OFFSET;
 
 	while (*data != 0) {
@@ -41,6 +96,490 @@ tlhash_ntfnv1a(void* key)
 
 #endif
 
+#ifndef TEMPLATE_LIB_HASH_MANY
+#define TEMPLATE_LIB_HASH_MANY
+
+#include "cpu.h"
+
+/**
+ * tlhash_fnv1a_many_portable is for internal use only
+ * Four keys at a time with independent multiply chains, so their latencies overlap.
+ */
+static inline void
+tlhash_fnv1a_many_portable(const unsigned char* keys, const size_t key_size, const size_t count, size_t* out_hashes)
+{
+	size_t i = 0;
+
+	for (; i + 4u <= count; i += 4u) {
+		const unsigned char* key = keys + (i * key_size);
+		size_t h0 = TLHASH_FNV1A_OFFSET, h1 = TLHASH_FNV1A_OFFSET, h2 = TLHASH_FNV1A_OFFSET, h3 = TLHASH_FNV1A_OFFSET;
+
+		for (size_t b = 0; b < key_size; b++) {
+			h0 = (key[b] ^ h0) * TLHASH_FNV1A_PRIME;
+			h1 = (key[key_size + b] ^ h1) * TLHASH_FNV1A_PRIME;
+			h2 = (key[(2u * key_size) + b] ^ h2) * TLHASH_FNV1A_PRIME;
+			h3 = (key[(3u * key_size) + b] ^ h3) * TLHASH_FNV1A_PRIME;
+		}
+		out_hashes[i] = h0;
+		out_hashes[i + 1u] = h1;
+		out_hashes[i + 2u] = h2;
+		out_hashes[i + 3u] = h3;
+	}
+
+	for (; i < count; i++) {
+		const unsigned char* key = keys + (i * key_size);
+		size_t hash = TLHASH_FNV1A_OFFSET;
+
+		for (size_t b = 0; b < key_size; b++) {
+			hash = (key[b] ^ hash) * TLHASH_FNV1A_PRIME;
+		}
+		out_hashes[i] = hash;
+	}
+}
+
+#if defined(TL_CPU_X86) && (TL_SIZE_T_BYTES == 16)
+/**
+ * tlhash_fnv1a_step_avx2 is for internal use only
+ * One fnv1a step with the low byte of each 64-bit lane. AVX2 has no 64-bit multiply, but the prime is 2^40 + 0x1b3,
+ * so h * prime = (h << 40) + lo(h) * 0x1b3 + ((hi(h) * 0x1b3) << 32).
+ */
+static inline TL_CPU_TARGET("avx2") __m256i
+tlhash_fnv1a_step_avx2(__m256i hash, const __m256i words)
+{
+	const __m256i low = _mm256_set1_epi64x(0x1b3);
+	const __m256i mask = _mm256_set1_epi64x(0xff);
+
+	hash = _mm256_xor_si256(hash, _mm256_and_si256(words, mask));
+	return _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(hash, 40), _mm256_mul_epu32(hash, low)),
+		_mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(hash, 32), low), 32));
+}
+
+/**
+ * tlhash_fnv1a_many_avx2 is for internal use only
+ * Eight 4 or 8 byte keys at a time, in two vectors of four 64-bit lanes. Keys are read as little endian words, which
+ * is their byte order on x86.
+ */
+static inline TL_CPU_TARGET("avx2") void
+tlhash_fnv1a_many_avx2(const unsigned char* keys, const size_t key_size, const size_t count, size_t* out_hashes)
+{
+	const __m256i offset = _mm256_set1_epi64x((long long)TLHASH_FNV1A_OFFSET);
+	size_t i = 0;
+
+	for (; i + 8u <= count; i += 8u) {
+		const unsigned char* key = keys + (i * key_size);
+		__m256i words0, words1;
+
+		if (key_size == 8u) {
+			words0 = _mm256_loadu_si256((const __m256i*)key);
+			words1 = _mm256_loadu_si256((const __m256i*)(key + 32));
+		} else {
+			words0 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)key));
+			words1 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(key + 16)));
+		}
+
+		__m256i hash0 = offset, hash1 = offset;
+		for (size_t b = 0; b < key_size; b++) {
+			hash0 = tlhash_fnv1a_step_avx2(hash0, words0);
+			hash1 = tlhash_fnv1a_step_avx2(hash1, words1);
+			words0 = _mm256_srli_epi64(words0, 8);
+			words1 = _mm256_srli_epi64(words1, 8);
+		}
+		_mm256_storeu_si256((__m256i*)(out_hashes + i), hash0);
+		_mm256_storeu_si256((__m256i*)(out_hashes + i + 4u), hash1);
+	}
+
+	tlhash_fnv1a_many_portable(keys + (i * key_size), key_size, count - i, out_hashes + i);
+}
+
+/**
+ * tlhash_fnv1a_step_avx512 is for internal use only
+ * tlhash_fnv1a_step_avx2 over eight 64-bit lanes.
+ */
+static inline TL_CPU_TARGET("avx512f") __m512i
+tlhash_fnv1a_step_avx512(__m512i hash, const __m512i words)
+{
+	const __m512i low = _mm512_set1_epi64(0x1b3);
+	const __m512i mask = _mm512_set1_epi64(0xff);
+
+	hash = _mm512_xor_si512(hash, _mm512_and_si512(words, mask));
+	return _mm512_add_epi64(_mm512_add_epi64(_mm512_slli_epi64(hash, 40), _mm512_mul_epu32(hash, low)),
+		_mm512_slli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(hash, 32), low), 32));
+}
+
+/**
+ * tlhash_fnv1a_many_avx512 is for internal use only
+ * Sixteen 4 or 8 byte keys at a time, in two vectors of eight 64-bit lanes, handing the rest to the avx2 kernel.
+ */
+static inline TL_CPU_TARGET("avx512f") void
+tlhash_fnv1a_many_avx512(const unsigned char* keys, const size_t key_size, const size_t count, size_t* out_hashes)
+{
+	const __m512i offset = _mm512_set1_epi64((long long)TLHASH_FNV1A_OFFSET);
+	size_t i = 0;
+
+	for (; i + 16u <= count; i += 16u) {
+		const unsigned char* key = keys + (i * key_size);
+		__m512i words0, words1;
+
+		if (key_size == 8u) {
+			words0 = _mm512_loadu_si512((const void*)key);
+			words1 = _mm512_loadu_si512((const void*)(key + 64));
+		} else {
+			words0 = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)key));
+			words1 = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)(key + 32)));
+		}
+
+		__m512i hash0 = offset, hash1 = offset;
+		for (size_t b = 0; b < key_size; b++) {
+			hash0 = tlhash_fnv1a_step_avx512(hash0, words0);
+			hash1 = tlhash_fnv1a_step_avx512(hash1, words1);
+			words0 = _mm512_srli_epi64(words0, 8);
+			words1 = _mm512_srli_epi64(words1, 8);
+		}
+		_mm512_storeu_si512((void*)(out_hashes + i), hash0);
+		_mm512_storeu_si512((void*)(out_hashes + i + 8u), hash1);
+	}
+
+	tlhash_fnv1a_many_avx2(keys + (i * key_size), key_size, count - i, out_hashes + i);
+}
+#endif
+
+/**
+ * tlhash_fnv1a_many
+ * The fnv1a hash (as <_PFX>_fnv1a) of each of count keys of key_size bytes stored back to back. Independent keys are
+ * hashed side by side, in vector lanes on CPUs with AVX2 or AVX-512 for keys of 4 or 8 bytes, instead of one multiply
+ * chain after the other.
+ *
+ * @param keys The keys
+ * @param key_size The size of a single key in bytes
+ * @param count The number of keys
+ * @param out_hashes --Out-- Receives the count hashes
+ */
+static inline void
+tlhash_fnv1a_many(const void* keys, const size_t key_size, const size_t count, size_t* out_hashes)
+{
+#if defined(TL_CPU_X86) && (TL_SIZE_T_BYTES == 16)
+	if (key_size == 4u || key_size == 8u) {
+		const unsigned features = tl_cpu_features();
+		if (features & TL_CPU_AVX512) {
+			tlhash_fnv1a_many_avx512(keys, key_size, count, out_hashes);
+			return;
+		}
+		if (features & TL_CPU_AVX2) {
+			tlhash_fnv1a_many_avx2(keys, key_size, count, out_hashes);
+			return;
+		}
+	}
+#endif
+	tlhash_fnv1a_many_portable(keys, key_size, count, out_hashes);
+}
+
+#endif
+
+#ifndef TEMPLATE_LIB_HASH_WY
+#define TEMPLATE_LIB_HASH_WY
+
+#include <stdint.h>
+
+#define TLHASH_WY_P0 UINT64_C(0xa0761d6478bd642f)
+#define TLHASH_WY_P1 UINT64_C(0xe7037ed1a0b428db)
+#define TLHASH_WY_P2 UINT64_C(0x8ebc6af09c88c6e3)
+#define TLHASH_WY_P3 UINT64_C(0x589965cc75374cc3)
+
+/**
+ * Words are read with unaligned loads. Reading a whole word that runs past the terminator of a string is harmless as
+ * long as the word stays within the page, but it would trip the address sanitizer, so tlhash_ntwy does its loads
+ * in a function excluded from it.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define TLHASH_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+typedef uint64_t tlhash_u64_unaligned __attribute__((may_alias, aligned(1)));
+#else
+#define TLHASH_NO_SANITIZE_ADDRESS
+#endif
+
+#ifndef TLHASH_PAGE_SIZE
+#define TLHASH_PAGE_SIZE 4096u
+#endif
+
+/**
+ * tlhash_mum is for internal use only
+ * Multiply to 128 bits and fold the halves together with xor.
+ */
+static inline uint64_t
+tlhash_mum(const uint64_t a, const uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+	const unsigned __int128 r = (unsigned __int128)a * b;
+	return (uint64_t)r ^ (uint64_t)(r >> 64u);
+#else
+	const uint64_t ha = a >> 32u, hb = b >> 32u, la = (uint32_t)a, lb = (uint32_t)b;
+	const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	const uint64_t t = rl + (rm0 << 32u);
+	const uint64_t lo = t + (rm1 << 32u);
+	const uint64_t hi = rh + (rm0 >> 32u) + (rm1 >> 32u) + (t < rl) + (lo < t);
+	return lo ^ hi;
+#endif
+}
+
+/**
+ * tlhash_wy_read is for internal use only
+ */
+static inline uint64_t
+tlhash_wy_read(const unsigned char* data)
+{
+	uint64_t word;
+	memcpy(&word, data, sizeof(word));
+	return word;
+}
+
+/**
+ * tlhash_wy_finish is for internal use only
+ * Mix the last (zero padded) 16 bytes and the length into the running state.
+ */
+static inline size_t
+tlhash_wy_finish(const uint64_t state, const uint64_t a, const uint64_t b, const size_t len)
+{
+	return (size_t)tlhash_mum(tlhash_mum(a ^ TLHASH_WY_P1, b ^ state) ^ TLHASH_WY_P2, (uint64_t)len ^ TLHASH_WY_P3);
+}
+
+/**
+ * tlhash_wy
+ * wyhash style hash of len bytes. The input is consumed 16 bytes per 128-bit multiply instead of a multiply per byte
+ * like fnv1a. When len is a constant (as in fmap_<TL_NAME>_wyhash) the loops are unrolled by the compiler.
+ *
+ * @param data The bytes to hash
+ * @param len The number of bytes
+ * @return The hash
+ */
+static inline size_t
+tlhash_wy(const void* data, const size_t len)
+{
+	const unsigned char* bytes = data;
+	size_t left = len;
+	uint64_t state = TLHASH_WY_P0;
+	uint64_t a = 0, b = 0;
+
+	for (; left >= 16u; left -= 16u, bytes += 16u) {
+		state = tlhash_mum(tlhash_wy_read(bytes) ^ TLHASH_WY_P1, tlhash_wy_read(bytes + 8u) ^ state);
+	}
+
+	if (left > 8u) {
+		a = tlhash_wy_read(bytes);
+		memcpy(&b, bytes + 8u, left - 8u);
+	} else {
+		memcpy(&a, bytes, left);
+	}
+	return tlhash_wy_finish(state, a, b, len);
+}
+
+/**
+ * tlhash_nt_load is for internal use only
+ * Load the word at data, or when that word would cross into the next page, load it up to the terminator only.
+ */
+static inline TLHASH_NO_SANITIZE_ADDRESS uint64_t
+tlhash_nt_load(const unsigned char* data)
+{
+	uint64_t word = 0;
+
+	if (((uintptr_t)data & (TLHASH_PAGE_SIZE - 1u)) <= TLHASH_PAGE_SIZE - sizeof(word)) {
+#if defined(__GNUC__) || defined(__clang__)
+		return *(const tlhash_u64_unaligned*)data;
+#else
+		memcpy(&word, data, sizeof(word));
+		return word;
+#endif
+	}
+
+	for (size_t i = 0; i < sizeof(word) && data[i] != 0; i++) {
+		((unsigned char*)&word)[i] = data[i];
+	}
+	return word;
+}
+
+/**
+ * tlhash_nt_length is for internal use only
+ * The number of bytes before the first zero byte of a word, or 8 when the word has no zero byte. The zero test is the
+ * usual SWAR one, which never reports a zero byte that isn't there.
+ */
+static inline size_t
+tlhash_nt_length(const uint64_t word)
+{
+	const uint64_t lows = UINT64_C(0x0101010101010101);
+	const uint64_t highs = UINT64_C(0x8080808080808080);
+
+	if (((word - lows) & ~word & highs) == 0)
+		return 8u;
+
+	size_t len = 0;
+	while (((const unsigned char*)&word)[len] != 0) len++;
+	return len;
+}
+
+/**
+ * tlhash_ntwy
+ * Word at a time hash of a null terminated string. The terminator is found 8 bytes at a time with a SWAR zero byte test
+ * while hashing, so the string is read once. Equal to tlhash_wy(key, strlen(key)).
+ *
+ * @param key The null terminated string to hash
+ * @return The hash
+ */
+static inline size_t
+tlhash_ntwy(const void* key)
+{
+	const unsigned char* bytes = key;
+	size_t len = 0;
+	uint64_t state = TLHASH_WY_P0;
+
+	for (;;) {
+		uint64_t a = tlhash_nt_load(bytes);
+		size_t n = tlhash_nt_length(a);
+		if (n < 8u) {
+			uint64_t tail = 0;
+			memcpy(&tail, &a, n);
+			return tlhash_wy_finish(state, tail, 0, len + n);
+		}
+
+		uint64_t b = tlhash_nt_load(bytes + 8u);
+		n = tlhash_nt_length(b);
+		if (n < 8u) {
+			uint64_t tail = 0;
+			memcpy(&tail, &b, n);
+			return tlhash_wy_finish(state, a, tail, len + 8u + n);
+		}
+
+		state = tlhash_mum(a ^ TLHASH_WY_P1, b ^ state);
+		bytes += 16u;
+		len += 16u;
+	}
+}
+
+#undef TLHASH_WY_P3
+#undef TLHASH_WY_P2
+#undef TLHASH_WY_P1
+#undef TLHASH_WY_P0
+
+#endif
+
+#ifndef TEMPLATE_LIB_HASH_SIP
+#define TEMPLATE_LIB_HASH_SIP
+
+#include <stdint.h>
+#include <stdio.h>        /* fopen, fread */
+#include <time.h>         /* time, clock */
+#include "cpu.h"          /* TL_CPU_LOAD, TL_CPU_STORE, TL_CPU_FETCH_ADD */
+
+#define TLHASH_ROTL64(x, b) (((x) << (b)) | ((x) >> (64u - (b))))
+#define TLHASH_SIPROUND(v0, v1, v2, v3) do { \
+		v0 += v1; v1 = TLHASH_ROTL64(v1, 13u); v1 ^= v0; v0 = TLHASH_ROTL64(v0, 32u); \
+		v2 += v3; v3 = TLHASH_ROTL64(v3, 16u); v3 ^= v2; \
+		v0 += v3; v3 = TLHASH_ROTL64(v3, 21u); v3 ^= v0; \
+		v2 += v1; v1 = TLHASH_ROTL64(v1, 17u); v1 ^= v2; v2 = TLHASH_ROTL64(v2, 32u); \
+	} while (0)
+
+/**
+ * tlhash_sip13
+ * SipHash-1-3 of len bytes under a 128-bit key. Without the key, inputs that collide cannot be chosen, so a table
+ * hashed with a secret per table key only grows with its real load, whatever keys a client sends it.
+ *
+ * @param data The bytes to hash
+ * @param len The number of bytes
+ * @param seed The key, two 64-bit words (see tlhash_seed)
+ * @return The hash
+ */
+static inline size_t
+tlhash_sip13(const void* data, const size_t len, const uint64_t* seed)
+{
+	const unsigned char* bytes = data;
+	uint64_t v0 = seed[0] ^ UINT64_C(0x736f6d6570736575);
+	uint64_t v1 = seed[1] ^ UINT64_C(0x646f72616e646f6d);
+	uint64_t v2 = seed[0] ^ UINT64_C(0x6c7967656e657261);
+	uint64_t v3 = seed[1] ^ UINT64_C(0x7465646279746573);
+	uint64_t last = (uint64_t)len << 56u;
+	size_t left = len;
+
+	for (; left >= 8u; left -= 8u, bytes += 8u) {
+		uint64_t m = 0;
+		for (size_t i = 0; i < 8u; i++) {
+			m |= (uint64_t)bytes[i] << (8u * i);
+		}
+		v3 ^= m;
+		TLHASH_SIPROUND(v0, v1, v2, v3);
+		v0 ^= m;
+	}
+	for (size_t i = 0; i < left; i++) {
+		last |= (uint64_t)bytes[i] << (8u * i);
+	}
+
+	v3 ^= last;
+	TLHASH_SIPROUND(v0, v1, v2, v3);
+	v0 ^= last;
+	v2 ^= 0xffu;
+	TLHASH_SIPROUND(v0, v1, v2, v3);
+	TLHASH_SIPROUND(v0, v1, v2, v3);
+	TLHASH_SIPROUND(v0, v1, v2, v3);
+	return (size_t)(v0 ^ v1 ^ v2 ^ v3);
+}
+
+/**
+ * tlhash_ntsip13
+ * tlhash_sip13 of a null terminated string.
+ *
+ * @param key The null terminated string to hash
+ * @param seed The key, two 64-bit words (see tlhash_seed)
+ * @return The hash
+ */
+static inline size_t
+tlhash_ntsip13(const void* key, const uint64_t* seed)
+{
+	return tlhash_sip13(key, strlen(key), seed);
+}
+
+/**
+ * tlhash_seed
+ * Fill seed with a new key for the seeded hashes. A secret is read once from /dev/urandom (or, where there is none,
+ * from the clock and the address space layout) and every call derives a different key from it, a call count and salt.
+ *
+ * Note:
+ * -Safe to call from several threads. The secret and count are read and written with the relaxed atomics of cpu.h:
+ *  threads racing on the first call each read a secret and store it, and later calls may combine the words of two
+ *  of them, which are all random. Neither word is ever used before it was stored.
+ *
+ * @param seed --Out-- The new key, two 64-bit words
+ * @param salt Any address unique to the caller, such as the table being initialized
+ */
+static inline void
+tlhash_seed(uint64_t* seed, const void* salt)
+{
+	static uint64_t secret[2];
+	static uint64_t calls;
+	uint64_t key[2] = {TL_CPU_LOAD(&secret[0]), TL_CPU_LOAD(&secret[1])};
+
+	/* both words are stored non zero, so a zero word has not been stored yet */
+	if (key[0] == 0 || key[1] == 0) {
+		FILE* random = fopen("/dev/urandom", "rb");
+		if (!random || fread(key, sizeof(key), 1, random) != 1) {
+			const uint64_t stack = (uint64_t)(uintptr_t)&random;
+			key[0] = (uint64_t)time(NULL) ^ (stack << 16u);
+			key[1] = (uint64_t)clock() ^ (uint64_t)(uintptr_t)&tlhash_seed;
+		}
+		if (random)
+			fclose(random);
+		key[0] |= 1u;
+		key[1] |= 1u;
+		TL_CPU_STORE(&secret[0], key[0]);
+		TL_CPU_STORE(&secret[1], key[1]);
+	}
+
+	const uint64_t input[2] = {TL_CPU_FETCH_ADD(&calls, 1u) + 1u, (uint64_t)(uintptr_t)salt};
+	seed[0] = tlhash_sip13(input, sizeof(input), key);
+	seed[1] = tlhash_sip13(&seed[0], sizeof(seed[0]), key);
+}
+
+#undef TLHASH_SIPROUND
+#undef TLHASH_ROTL64
+
+#endif
+
 static inline size_t
 TLSYMBOL(_PFX,fnv1a)(TL_K key)
 {
@@ -55,5 +594,71 @@ TLSYMBOL(_PFX,fnv1a)(TL_K key)
 	return hash;
 }
 
+/**
+ * <_PFX>_fnv1a_many
+ * <_PFX>_fnv1a of count keys at once (see tlhash_fnv1a_many).
+ */
+static inline void
+TLSYMBOL(_PFX,fnv1a_many)(TL_K const* keys, const size_t count, size_t* out_hashes)
+{
+	tlhash_fnv1a_many(keys, sizeof(TL_K), count, out_hashes);
+}
+
+/**
+ * <_PFX>_wyhash
+ * tlhash_wy over the bytes of a key. Select it with #define fmap_hashfn(key) fmap_<TL_NAME>_wyhash(key)
+ */
+static inline size_t
+TLSYMBOL(_PFX,wyhash)(TL_K key)
+{
+	return tlhash_wy(&key, sizeof(TL_K));
+}
+
+/**
+ * <_PFX>_siphash
+ * tlhash_sip13 over the bytes of a key. The default hash of a map with TL_SEEDED_HASH.
+ */
+static inline size_t
+TLSYMBOL(_PFX,siphash)(TL_K key, const uint64_t* seed)
+{
+	return tlhash_sip13(&key, sizeof(TL_K), seed);
+}
+
+#ifdef TL_KEY_IS_INT
+
+/**
+ * <_PFX>_fibhash
+ * Fibonacci (multiply-shift) hash of an integer key in a single multiply. Only the high bits of the product depend on
+ * every key bit, so the table must take its bucket from them (see tlhash_high_bits), as flatmap.h does when
+ * TL_KEY_IS_INT is defined.
+ */
+static inline size_t
+TLSYMBOL(_PFX,fibhash)(TL_K key)
+{
+#if (TL_SIZE_T_BYTES == 16)
+	return (size_t)((uint64_t)key * UINT64_C(0x9e3779b97f4a7c15));
+#else
+	return (size_t)(((uint64_t)key * UINT64_C(0x9e3779b97f4a7c15)) >> 32u);
+#endif
+}
+
+/**
+ * <_PFX>_murmurhash
+ * The murmur3 finalizer (tlhash_mix) of an integer key. Two multiplies, but every output bit depends on every key bit,
+ * so it works with any bucket selection and with keys that are all multiples of a large power of 2.
+ */
+static inline size_t
+TLSYMBOL(_PFX,murmurhash)(TL_K key)
+{
+#if (TL_SIZE_T_BYTES == 16)
+	return tlhash_mix((size_t)(uint64_t)key);
+#else
+	const uint64_t wide = (uint64_t)key;
+	return tlhash_mix((size_t)(wide ^ (wide >> 32u)));
+#endif
+}
+
+#endif
+
 #undef TLHASH_FNV1A_PRIME
 #undef TLHASH_FNV1A_OFFSET
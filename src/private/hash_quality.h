@@ -0,0 +1,475 @@
+#ifndef TEMPLATE_LIB_HASH_QUALITY_H
+#define TEMPLATE_LIB_HASH_QUALITY_H
+
+/**
+ * Hash quality analysis of a key sample against the flatmap.h geometry: a map sized for the sample has num_buckets
+ * buckets of log2n(num_buckets) slots each and grows whenever one bucket overflows, so a hash that clusters keys in a
+ * few buckets wastes memory and time no matter the load factor.
+ *
+ * Requires hash_algorithm.h to be included first (see fmap_<TL_NAME>_hash_quality in flatmap.h, or tools/hashq.c for
+ * the command line tool).
+ */
+
+#ifndef TEMPLATE_LIB_HASH_MIX
+#error "hash_quality.h requires hash_algorithm.h to be included first"
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>        /* qsort */
+#include <string.h>
+
+#include "allocator.h"
+#include "tlstatus.h"
+#include "utility.h"
+
+/**
+ * The number of keys flipped bit by bit for the avalanche statistics, and the leading key bytes flipped in each
+ */
+#define TLHASH_QUALITY_AVALANCHE_KEYS 512u
+#define TLHASH_QUALITY_AVALANCHE_BYTES 32u
+
+/**
+ * The smallest map flatmap.h grows to, TL_FMAP_DEFAULT_BUCKET_COUNT
+ */
+#define TLHASH_QUALITY_MIN_BUCKETS 8u
+
+/**
+ * The most doublings tried when fitting the sample. A hash that needs a map 2^16 times larger than the sample is not
+ * worth a recommendation.
+ */
+#define TLHASH_QUALITY_MAX_GROWS 16u
+
+/**
+ * tlhash_quality_fn
+ * The hash under test. key points to the key bytes (the characters for NUL terminated keys) and len is their count.
+ */
+typedef size_t tlhash_quality_fn(const void* key, size_t len, void* ctx);
+
+/**
+ * count                   - The number of distinct keys in the sample, which every other field is computed over
+ * duplicate_keys          - The keys equal to another key of the sample, left out since a map holds each key once
+ * inseparable_keys        - The distinct keys sharing their full hash with another key, no number of buckets can
+ *                           tell them apart
+ * num_buckets             - The buckets of a map sized for the sample at the load factor
+ * bucket_max              - The slots of each bucket at that size
+ * max_fill                - The most keys hashed to a single bucket
+ * overflow_buckets        - The buckets holding more than bucket_max keys, each one a TL_OOB grow
+ * chi_squared             - The chi squared of the bucket fill per degree of freedom, close to 1 for a uniform hash
+ * oob_probability         - The chance that a uniform hash overflows a bucket at this size, to compare with
+ * oob_grows               - The doublings of num_buckets the sample forces through bucket overflows alone, at most
+ *                           TLHASH_QUALITY_MAX_GROWS
+ * bucket_bits             - The number of hash bits selecting the bucket
+ * worst_bit               - The bucket selecting hash bit furthest from being set half the time
+ * worst_bit_bias          - |P(worst_bit set) - 0.5|, ideally close to 0
+ * avalanche_bias          - The worst |P(bucket bit flips) - 0.5| over every (key bit, bucket bit) pair
+ * avalanche_mean          - The mean of the same over every pair, ideally close to 0 (sampling noise alone gives
+ *                           about 0.02 with a full sample)
+ * recommended_buckets     - The num_buckets to initialize a map with so the sample goes in without any grow, 0 when
+ *                           the sample still overflows after TLHASH_QUALITY_MAX_GROWS doublings
+ * recommended_load_factor - The lowest load factor that keeps a map of recommended_buckets from growing on load, 0
+ *                           with recommended_buckets
+ */
+struct tlhash_quality
+{
+	size_t count;
+	size_t duplicate_keys;
+	size_t inseparable_keys;
+	size_t num_buckets;
+	size_t bucket_max;
+	size_t max_fill;
+	size_t overflow_buckets;
+	double chi_squared;
+	double oob_probability;
+	size_t oob_grows;
+	unsigned bucket_bits;
+	unsigned worst_bit;
+	double worst_bit_bias;
+	double avalanche_bias;
+	double avalanche_mean;
+	size_t recommended_buckets;
+	size_t recommended_load_factor;
+};
+
+/**
+ * tlhash_quality_bucket is for internal use only
+ */
+static inline size_t
+tlhash_quality_bucket(const size_t hash, const size_t num_buckets, const int high_bits)
+{
+	return high_bits ? tlhash_high_bits(hash, num_buckets) : (hash & (num_buckets - 1u));
+}
+
+/**
+ * tlhash_quality_powi is for internal use only
+ */
+static inline double
+tlhash_quality_powi(double base, size_t exp)
+{
+	double result = 1.0;
+	while (exp != 0) {
+		if (exp & 1u)
+			result *= base;
+		base *= base;
+		exp >>= 1u;
+	}
+	return result;
+}
+
+/**
+ * tlhash_quality_oob_uniform is for internal use only
+ * The chance that one of num_buckets buckets gets more than bucket_max of count uniformly hashed keys.
+ */
+static inline double
+tlhash_quality_oob_uniform(const size_t count, const size_t num_buckets, const size_t bucket_max)
+{
+	if (num_buckets == 1)
+		return (count > bucket_max) ? 1.0 : 0.0;
+
+	/* the fill of one bucket is binomial(count, 1 / num_buckets) */
+	const double p = 1.0 / (double)num_buckets;
+	double pmf = tlhash_quality_powi(1.0 - p, count);
+	double fits = pmf;
+	for (size_t k = 0; k < bucket_max && k < count; k++) {
+		pmf *= ((double)(count - k) / (double)(k + 1u)) * (p / (1.0 - p));
+		fits += pmf;
+	}
+	if (fits > 1.0)
+		fits = 1.0;
+	return 1.0 - tlhash_quality_powi(fits, num_buckets);
+}
+
+/**
+ * tlhash_quality_fill is for internal use only
+ * Fill fills with the keys per bucket, returning the fullest bucket and setting the overflowing bucket count.
+ */
+static inline size_t
+tlhash_quality_fill(const size_t* hashes, const size_t count, const size_t num_buckets, const int high_bits,
+	size_t* fills, size_t* out_overflows)
+{
+	const size_t bucket_max = tl_util_log2n(num_buckets);
+	size_t max_fill = 0;
+	size_t overflows = 0;
+
+	memset(fills, 0, num_buckets * sizeof(size_t));
+	for (size_t i = 0; i < count; i++) {
+		const size_t fill = ++fills[tlhash_quality_bucket(hashes[i], num_buckets, high_bits)];
+		if (fill > max_fill)
+			max_fill = fill;
+		if (fill == bucket_max + 1u)
+			overflows++;
+	}
+	*out_overflows = overflows;
+	return max_fill;
+}
+
+/**
+ * tlhash_quality_entry is for internal use only
+ * A key of the sample and its hash, sorted by hash to find the keys sharing one.
+ */
+struct tlhash_quality_entry
+{
+	size_t hash;
+	const unsigned char* key;
+	size_t len;
+};
+
+/**
+ * tlhash_quality_entry_cmp is for internal use only
+ */
+static inline int
+tlhash_quality_entry_cmp(const void* left, const void* right)
+{
+	const size_t l = ((const struct tlhash_quality_entry*)left)->hash;
+	const size_t r = ((const struct tlhash_quality_entry*)right)->hash;
+	return (l > r) - (l < r);
+}
+
+/**
+ * tlhash_quality_size_cmp is for internal use only
+ */
+static inline int
+tlhash_quality_size_cmp(const void* left, const void* right)
+{
+	const size_t l = *(const size_t*)left;
+	const size_t r = *(const size_t*)right;
+	return (l > r) - (l < r);
+}
+
+/**
+ * tlhash_quality_reverse is for internal use only
+ * The bits of hash in reverse order, which sorts hashes sharing their low bits next to each other.
+ */
+static inline size_t
+tlhash_quality_reverse(size_t hash)
+{
+	size_t reversed = 0;
+	for (size_t b = 0; b < sizeof(size_t) * 8u; b++) {
+		reversed = (reversed << 1u) | (hash & 1u);
+		hash >>= 1u;
+	}
+	return reversed;
+}
+
+/**
+ * tlhash_quality_overflows is for internal use only
+ * The number of buckets holding more than bucket_max keys when the top bucket_bits bits of each sorted key select the
+ * bucket. Keys of one bucket are adjacent in sorted, so this needs no memory however many buckets there are.
+ */
+static inline size_t
+tlhash_quality_overflows(const size_t* sorted, const size_t count, const unsigned bucket_bits,
+	const size_t bucket_max)
+{
+	const unsigned shift = (unsigned)(sizeof(size_t) * 8u) - bucket_bits;
+	size_t overflows = 0;
+	size_t run = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		run = (i != 0 && (sorted[i] >> shift) == (sorted[i - 1u] >> shift)) ? run + 1u : 1u;
+		if (run == bucket_max + 1u)
+			overflows++;
+	}
+	return overflows;
+}
+
+/**
+ * tlhash_quality_dedupe is for internal use only
+ * Hash every key, drop the keys equal to an earlier one and count the distinct keys sharing a full hash. Fills hashes
+ * with the hash of each distinct key and returns their number.
+ */
+static inline size_t
+tlhash_quality_dedupe(tlhash_quality_fn* hash, void* ctx, const void* keys, const size_t key_size,
+	const size_t count, struct tlhash_quality_entry* entries, size_t* hashes, struct tlhash_quality* out)
+{
+	for (size_t i = 0; i < count; i++) {
+		entries[i].key = (key_size != 0) ? (const unsigned char*)keys + i * key_size
+			: ((const unsigned char* const*)keys)[i];
+		entries[i].len = (key_size != 0) ? key_size : strlen((const char*)entries[i].key);
+		entries[i].hash = hash(entries[i].key, entries[i].len, ctx);
+	}
+	qsort(entries, count, sizeof(*entries), &tlhash_quality_entry_cmp);
+
+	size_t distinct = 0;
+	size_t run_start = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (i == 0 || entries[i].hash != entries[i - 1u].hash) {
+			if (distinct - run_start > 1u)
+				out->inseparable_keys += distinct - run_start;
+			run_start = distinct;
+		}
+
+		/* equal keys have equal hashes, so only the distinct keys of the current run need comparing */
+		size_t j;
+		for (j = run_start; j < distinct; j++) {
+			if (entries[j].len == entries[i].len && memcmp(entries[j].key, entries[i].key, entries[i].len) == 0)
+				break;
+		}
+		if (j != distinct) {
+			out->duplicate_keys++;
+			continue;
+		}
+		entries[distinct] = entries[i];
+		hashes[distinct] = entries[i].hash;
+		distinct++;
+	}
+	if (distinct - run_start > 1u)
+		out->inseparable_keys += distinct - run_start;
+	return distinct;
+}
+
+/**
+ * tlhash_quality_avalanche is for internal use only
+ * Flip every bit of the leading bytes of the first keys and count how often each bucket bit of the hash flips.
+ */
+static inline enum tl_status
+tlhash_quality_avalanche(tlhash_quality_fn* hash, void* ctx, const void* keys, const size_t key_size,
+	const size_t count, const unsigned* bits, const unsigned bit_count, struct tlhash_quality* out)
+{
+	const size_t max_bits = TLHASH_QUALITY_AVALANCHE_BYTES * 8u;
+	const size_t sample = (count < TLHASH_QUALITY_AVALANCHE_KEYS) ? count : TLHASH_QUALITY_AVALANCHE_KEYS;
+	size_t trials[TLHASH_QUALITY_AVALANCHE_BYTES * 8u] = {0};
+
+	uint32_t* flips = tlcalloc(max_bits * 64u, sizeof(uint32_t));
+	if (!flips)
+		return TL_ERR_MEM;
+
+	for (size_t i = 0; i < sample; i++) {
+		const unsigned char* key = (key_size != 0) ? (const unsigned char*)keys + i * key_size
+			: ((const unsigned char* const*)keys)[i];
+		const size_t len = (key_size != 0) ? key_size : strlen((const char*)key);
+		const size_t flip_bytes = (len < TLHASH_QUALITY_AVALANCHE_BYTES) ? len : TLHASH_QUALITY_AVALANCHE_BYTES;
+
+		unsigned char* copy = tlmalloc(len + 1u);
+		if (!copy) {
+			tlfree(flips);
+			return TL_ERR_MEM;
+		}
+		memcpy(copy, key, len);
+		copy[len] = 0;
+
+		const size_t base = hash(copy, len, ctx);
+		for (size_t bit = 0; bit < flip_bytes * 8u; bit++) {
+			const unsigned char mask = (unsigned char)(1u << (bit & 7u));
+			/* a NUL terminated key cannot hold a 0 byte */
+			if (key_size == 0 && (copy[bit >> 3u] ^ mask) == 0)
+				continue;
+
+			copy[bit >> 3u] ^= mask;
+			const size_t diff = base ^ hash(copy, len, ctx);
+			copy[bit >> 3u] ^= mask;
+
+			trials[bit]++;
+			for (unsigned b = 0; b < bit_count; b++) {
+				flips[bit * 64u + b] += (uint32_t)((diff >> bits[b]) & 1u);
+			}
+		}
+		tlfree(copy);
+	}
+
+	double worst = 0.0;
+	double total = 0.0;
+	size_t cells = 0;
+	for (size_t bit = 0; bit < max_bits; bit++) {
+		if (trials[bit] == 0)
+			continue;
+		for (unsigned b = 0; b < bit_count; b++) {
+			double bias = (double)flips[bit * 64u + b] / (double)trials[bit] - 0.5;
+			bias = (bias < 0.0) ? -bias : bias;
+			worst = (bias > worst) ? bias : worst;
+			total += bias;
+			cells++;
+		}
+	}
+	out->avalanche_bias = worst;
+	out->avalanche_mean = (cells != 0) ? total / (double)cells : 0.0;
+
+	tlfree(flips);
+	return TLOK;
+}
+
+/**
+ * tlhash_quality
+ * Analyze how a hash spreads a sample of keys over the buckets of a flatmap.h map sized for the sample.
+ *
+ * Note:
+ * -The sample should be representative of the real keys (the same distribution), with at least a few thousand keys
+ * -Keys equal to another key of the sample are counted in duplicate_keys and left out of everything else
+ * -Fitting the sample doubles the buckets at most TLHASH_QUALITY_MAX_GROWS times. Keys sharing a full hash (see
+ * 	inseparable_keys) stay in one bucket however large the map, so enough of them leave no fit at all.
+ * -The avalanche statistics flip each bit of the first TLHASH_QUALITY_AVALANCHE_BYTES bytes of the first
+ * 	TLHASH_QUALITY_AVALANCHE_KEYS keys. Flips that would put a 0 byte in a NUL terminated key are skipped.
+ * -Padding bytes of struct keys are hashed like any other byte, so they show up in the avalanche statistics
+ *
+ * @param hash The hash to analyze
+ * @param ctx Passed to every call of hash
+ * @param keys The keys, count keys of key_size bytes each or, when key_size is 0, count pointers to NUL terminated keys
+ * @param key_size The size of a key in bytes, 0 for NUL terminated keys
+ * @param count The number of keys, at least 1
+ * @param load_factor The load factor of the map (0 for the default of 70)
+ * @param high_bits 1 when the map takes the bucket from the high bits of the hash (TL_KEY_IS_INT), otherwise 0
+ * @param out --Out-- The analysis
+ * @return
+ * 	TLOK on success
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+tlhash_quality(tlhash_quality_fn* hash, void* ctx, const void* keys, const size_t key_size, const size_t count,
+	const size_t load_factor, const int high_bits, struct tlhash_quality* out)
+{
+	assert(hash != NULL);
+	assert(keys != NULL);
+	assert(count > 0);
+	assert(load_factor <= 100);
+	assert(out != NULL);
+
+	memset(out, 0, sizeof(*out));
+
+	struct tlhash_quality_entry* entries = tlmalloc(count * sizeof(struct tlhash_quality_entry));
+	size_t* hashes = tlmalloc(count * sizeof(size_t));
+	if (!entries || !hashes) {
+		tlfree(entries);
+		tlfree(hashes);
+		return TL_ERR_MEM;
+	}
+	const size_t distinct = tlhash_quality_dedupe(hash, ctx, keys, key_size, count, entries, hashes, out);
+	tlfree(entries);
+
+	const size_t factor = (load_factor != 0) ? load_factor : 70u;
+	size_t num_buckets = TLHASH_QUALITY_MIN_BUCKETS;
+	while (((num_buckets * tl_util_log2n(num_buckets)) * factor) / 100u < distinct) {
+		num_buckets <<= 1u;
+	}
+
+	size_t* fills = tlmalloc(num_buckets * sizeof(size_t));
+	if (!fills) {
+		tlfree(hashes);
+		return TL_ERR_MEM;
+	}
+
+	out->count = distinct;
+	out->num_buckets = num_buckets;
+	out->bucket_max = tl_util_log2n(num_buckets);
+	out->max_fill = tlhash_quality_fill(hashes, distinct, num_buckets, high_bits, fills, &out->overflow_buckets);
+	out->oob_probability = tlhash_quality_oob_uniform(distinct, num_buckets, out->bucket_max);
+
+	const double expected = (double)distinct / (double)num_buckets;
+	double chi = 0.0;
+	for (size_t b = 0; b < num_buckets; b++) {
+		const double d = (double)fills[b] - expected;
+		chi += d * d / expected;
+	}
+	out->chi_squared = chi / (double)(num_buckets - 1u);
+	tlfree(fills);
+
+	/* the hash bits selecting the bucket: the low ones, or the high ones with high_bits */
+	unsigned bits[64];
+	const unsigned hash_bits = (unsigned)(sizeof(size_t) * 8u);
+	out->bucket_bits = 0;
+	while (((size_t)1u << out->bucket_bits) < num_buckets) out->bucket_bits++;
+	for (unsigned b = 0; b < out->bucket_bits; b++) {
+		bits[b] = high_bits ? hash_bits - 1u - b : b;
+
+		size_t ones = 0;
+		for (size_t i = 0; i < distinct; i++) {
+			ones += (hashes[i] >> bits[b]) & 1u;
+		}
+		double bias = (double)ones / (double)distinct - 0.5;
+		bias = (bias < 0.0) ? -bias : bias;
+		if (b == 0 || bias > out->worst_bit_bias) {
+			out->worst_bit_bias = bias;
+			out->worst_bit = bits[b];
+		}
+	}
+
+	/* double the buckets until the sample fits, like a map taking TL_OOB grows. Sorted by the bucket selecting end of
+	 * the hash, the keys of every bucket are adjacent at any size. */
+	for (size_t i = 0; i < distinct; i++) {
+		hashes[i] = high_bits ? hashes[i] : tlhash_quality_reverse(hashes[i]);
+	}
+	qsort(hashes, distinct, sizeof(size_t), &tlhash_quality_size_cmp);
+
+	size_t fit_buckets = num_buckets;
+	unsigned fit_bits = out->bucket_bits;
+	size_t overflows = out->overflow_buckets;
+	while (overflows != 0 && out->oob_grows < TLHASH_QUALITY_MAX_GROWS && fit_bits + 2u < hash_bits) {
+		fit_buckets <<= 1u;
+		fit_bits++;
+		overflows = tlhash_quality_overflows(hashes, distinct, fit_bits, tl_util_log2n(fit_buckets));
+		out->oob_grows++;
+	}
+
+	if (overflows == 0) {
+		const size_t fit_capacity = fit_buckets * tl_util_log2n(fit_buckets);
+		out->recommended_buckets = fit_buckets;
+		out->recommended_load_factor = (distinct * 100u + fit_capacity - 1u) / fit_capacity;
+		if (out->recommended_load_factor == 0)
+			out->recommended_load_factor = 1;
+	}
+
+	const enum tl_status status = tlhash_quality_avalanche(hash, ctx, keys, key_size, count, bits, out->bucket_bits,
+		out);
+	tlfree(hashes);
+	return status;
+}
+
+#endif //TEMPLATE_LIB_HASH_QUALITY_H
@@ -0,0 +1,131 @@
+#ifndef TEMPLATE_LIB_MAP_SCAN_H
+#define TEMPLATE_LIB_MAP_SCAN_H
+
+/**
+ * Kernel finding the used (occupied or collided) slots of a map, 64 slots per call. Whole table walks (rehash, export,
+ * freeze...) skip empty and deleted slots a bitmap word at a time instead of testing every slot:
+ *
+ * for (size_t base = 0; base < capacity; base += 64u) {
+ * 	for (uint64_t used = tl_map_used_bits(info + base, capacity - base); used != 0; used &= used - 1u) {
+ * 		const size_t slot = base + tl_cpu_ctz64(used);
+ * 		...
+ * 	}
+ * }
+ */
+
+#include "cpu.h"
+#include "map_slot_state.h"
+
+typedef uint64_t tl_map_scan_fn(const enum tl_map_slot_state* info);
+
+/**
+ * Used slots have the TL_MAPSS_OCCUPIED bit set (TL_MAPSS_COLLIDED is TL_MAPSS_OCCUPIED + 1).
+ */
+#define TL_MAP_SCAN_USED_BIT 1u
+
+/**
+ * tl_map_scan_portable is for internal use only
+ */
+static inline uint64_t
+tl_map_scan_portable(const enum tl_map_slot_state* info)
+{
+	uint64_t used = 0;
+	for (unsigned i = 0; i < 64u; i++) {
+		used |= (uint64_t)(((unsigned)info[i] >> TL_MAP_SCAN_USED_BIT) & 1u) << i;
+	}
+	return used;
+}
+
+#ifdef TL_CPU_X86
+/**
+ * tl_map_scan_sse2 is for internal use only
+ * Shift the used bit of each 32-bit state into its sign bit and gather the sign bits, 4 slots at a time.
+ */
+static inline TL_CPU_TARGET("sse2") uint64_t
+tl_map_scan_sse2(const enum tl_map_slot_state* info)
+{
+	uint64_t used = 0;
+	for (unsigned i = 0; i < 64u; i += 4u) {
+		const __m128i states = _mm_loadu_si128((const __m128i*)(info + i));
+		const __m128i signs = _mm_slli_epi32(states, 31 - TL_MAP_SCAN_USED_BIT);
+		used |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(signs)) << i;
+	}
+	return used;
+}
+
+/**
+ * tl_map_scan_avx2 is for internal use only
+ * The sse2 kernel 8 slots at a time.
+ */
+static inline TL_CPU_TARGET("avx2") uint64_t
+tl_map_scan_avx2(const enum tl_map_slot_state* info)
+{
+	uint64_t used = 0;
+	for (unsigned i = 0; i < 64u; i += 8u) {
+		const __m256i states = _mm256_loadu_si256((const __m256i*)(info + i));
+		const __m256i signs = _mm256_slli_epi32(states, 31 - TL_MAP_SCAN_USED_BIT);
+		used |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(signs)) << i;
+	}
+	return used;
+}
+
+/**
+ * tl_map_scan_avx512 is for internal use only
+ * Test the used bit of 16 slots at a time straight into a mask register.
+ */
+static inline TL_CPU_TARGET("avx512f") uint64_t
+tl_map_scan_avx512(const enum tl_map_slot_state* info)
+{
+	const __m512i bit = _mm512_set1_epi32(1 << TL_MAP_SCAN_USED_BIT);
+	uint64_t used = 0;
+	for (unsigned i = 0; i < 64u; i += 16u) {
+		const __m512i states = _mm512_loadu_si512((const void*)(info + i));
+		used |= (uint64_t)_mm512_test_epi32_mask(states, bit) << i;
+	}
+	return used;
+}
+#endif
+
+/**
+ * tl_map_scan_select is for internal use only
+ */
+static inline tl_map_scan_fn*
+tl_map_scan_select(const unsigned features)
+{
+#ifdef TL_CPU_X86
+	/* the vector kernels read the states as 32-bit lanes */
+	if (sizeof(enum tl_map_slot_state) == sizeof(int32_t)) {
+		if (features & TL_CPU_AVX512) return &tl_map_scan_avx512;
+		if (features & TL_CPU_AVX2) return &tl_map_scan_avx2;
+		if (features & TL_CPU_SSE2) return &tl_map_scan_sse2;
+	}
+#endif
+	(void)features;
+	return &tl_map_scan_portable;
+}
+
+/**
+ * tl_map_used_bits
+ * Bitmap of the used slots among the first 64 (or count if fewer) slot states, bit i standing for info[i].
+ *
+ * @param info The slot states
+ * @param count The number of states left from info on, only the first 64 are scanned
+ * @return The bitmap
+ */
+static inline uint64_t
+tl_map_used_bits(const enum tl_map_slot_state* info, const size_t count)
+{
+	if (count < 64u) {
+		uint64_t used = 0;
+		for (size_t i = 0; i < count; i++) {
+			used |= (uint64_t)(((unsigned)info[i] >> TL_MAP_SCAN_USED_BIT) & 1u) << i;
+		}
+		return used;
+	}
+
+	return tl_map_scan_select(tl_cpu_features())(info);
+}
+
+#undef TL_MAP_SCAN_USED_BIT
+
+#endif //TEMPLATE_LIB_MAP_SCAN_H
@@ -0,0 +1,85 @@
+#ifndef TEMPLATE_LIB_RADIX_H
+#define TEMPLATE_LIB_RADIX_H
+
+/**
+ * Radix keys: order preserving maps of the signed integer and floating point types onto uint64_t, for the
+ * array_radix_keyfn of array.h. The unsigned integer types are their own keys.
+ *
+ * #define TL_T double
+ * #define array_radix_keyfn(element) tlradix_key_f64((element))
+ * #include "array.h"
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * The digit of the LSD radix sort, 8 bits (8 passes over a 64 bit key at most, 256 buckets per pass)
+ */
+#define TLRADIX_DIGIT_BITS 8u
+#define TLRADIX_BUCKETS (1u << TLRADIX_DIGIT_BITS)
+#define TLRADIX_PASSES (64u / TLRADIX_DIGIT_BITS)
+
+/**
+ * tlradix_key_i64
+ * Flip the sign bit, so that the negative values come before the positive ones.
+ *
+ * @param value The value to make a key of
+ * @return The radix key of value
+ */
+static inline uint64_t
+tlradix_key_i64(const int64_t value)
+{
+	return (uint64_t)value ^ (UINT64_C(1) << 63u);
+}
+
+/**
+ * tlradix_key_i32
+ * tlradix_key_i64 for 32 bit values. The key only uses the low 32 bits, so the radix sort skips the upper passes.
+ *
+ * @param value The value to make a key of
+ * @return The radix key of value
+ */
+static inline uint64_t
+tlradix_key_i32(const int32_t value)
+{
+	return (uint64_t)((uint32_t)value ^ (UINT32_C(1) << 31u));
+}
+
+/**
+ * tlradix_key_f64
+ * Flip every bit of the negative values and only the sign bit of the others, so that the IEEE 754 bit patterns order
+ * like the values.
+ *
+ * Note:
+ * -Orders -0.0 before 0.0, negative NaNs before everything and positive NaNs after everything
+ *
+ * @param value The value to make a key of
+ * @return The radix key of value
+ */
+static inline uint64_t
+tlradix_key_f64(const double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint64_t mask = (uint64_t)0u - (bits >> 63u);
+	return bits ^ (mask | (UINT64_C(1) << 63u));
+}
+
+/**
+ * tlradix_key_f32
+ * tlradix_key_f64 for 32 bit floats. The key only uses the low 32 bits, so the radix sort skips the upper passes.
+ *
+ * @param value The value to make a key of
+ * @return The radix key of value
+ */
+static inline uint64_t
+tlradix_key_f32(const float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32_t mask = (uint32_t)0u - (bits >> 31u);
+	return (uint64_t)(bits ^ (mask | (UINT32_C(1) << 31u)));
+}
+
+#endif //TEMPLATE_LIB_RADIX_H
@@ -0,0 +1,68 @@
+#ifndef TEMPLATE_LIB_THREADS_H
+#define TEMPLATE_LIB_THREADS_H
+
+/**
+ * Minimal fork/join helper used by the multithreaded paths of the containers. Only included when TL_THREADS is
+ * defined, in which case the program must be linked against pthreads.
+ */
+
+#include <pthread.h>
+#include <unistd.h>        /* sysconf */
+
+#ifndef TL_MAX_THREADS
+#define TL_MAX_THREADS 64u
+#endif
+
+typedef void* tl_thread_fn(void* arg);
+
+/**
+ * tl_thread_count
+ * Returns the number of online processors, clamped to [1, TL_MAX_THREADS].
+ *
+ * @return The number of threads worth spawning for a parallel operation
+ */
+static inline size_t
+tl_thread_count(void)
+{
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (online < 1) return 1u;
+	if ((size_t)online > TL_MAX_THREADS) return TL_MAX_THREADS;
+	return (size_t)online;
+}
+
+/**
+ * tl_thread_run
+ * Run fn once for each of nthreads argument blocks and wait for all of them to finish. The calling thread runs the
+ * first block itself. When a thread cannot be created its block is run on the calling thread instead, so every block
+ * is always run exactly once.
+ *
+ * @param nthreads The number of argument blocks (at most TL_MAX_THREADS)
+ * @param fn The function to run
+ * @param args Pointer to the first of nthreads contiguous argument blocks
+ * @param arg_size The size of a single argument block
+ */
+static inline void
+tl_thread_run(const size_t nthreads, tl_thread_fn* fn, void* args, const size_t arg_size)
+{
+	assert(nthreads <= TL_MAX_THREADS);
+	pthread_t threads[TL_MAX_THREADS];
+	unsigned char started[TL_MAX_THREADS];
+	unsigned char* arg = args;
+
+	for (size_t i = 1; i < nthreads; i++) {
+		started[i] = (pthread_create(&threads[i], NULL, fn, arg + (i * arg_size)) == 0);
+	}
+
+	if (nthreads > 0)
+		fn(arg);
+
+	for (size_t i = 1; i < nthreads; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			fn(arg + (i * arg_size));
+	}
+}
+
+#endif //TEMPLATE_LIB_THREADS_H
@@ -0,0 +1,671 @@
+/**
+ * Ttlcache is a map whose pairs expire after a time to live. A flatmap index finds the entry of a key and a
+ * hierarchical timer wheel orders the entries by expiry, so expiring the due entries costs O(expired) instead of a scan
+ * over the whole table.
+ *
+ * Time is a plain uint64_t tick count chosen by the user (milliseconds, seconds, ...). The cache never reads a clock:
+ * entries only expire when ttl_<TL_NAME>_advance(now) is called, which keeps expiry deterministic and testable.
+ * Lookups already treat an entry as absent once its expiry is not after the last time given to advance.
+ *
+ * The wheel has 11 levels of 64 slots. Level 0 holds entries expiring within the current 64 ticks, one slot per tick.
+ * Each higher level covers 64 times the range of the one below it, and its slots are cascaded down as time reaches
+ * them. The top level reaches the end of the 64 bit tick range, so every entry has a slot and is moved down at most
+ * once per level. Advancing skips straight over ticks at which nothing can happen, so a large jump in time is as cheap
+ * as a small one.
+ *
+ * Note:
+ * -Must define TL_K to set the key type
+ * -Must define TL_V to set the value type
+ * -Must define TL_NAME to set the provided name. Unlike the other templates there is no default, because the flatmap
+ * 	instantiated for the index redefines TL_K/TL_V.
+ * -A ttlcache holds at most 2^32 - 1 entries
+ *
+ * -All user #define are consumed by the #include and must be redefined again to include again!
+ *
+ * Options:
+ * -Define ttl_key_equalsfn(left,right) to override the key equality test behavior
+ * 	-Default behavior is a simple equality operator
+ * -Define ttl_hashfn(key) to provide your own hashing function (must accept key type and return size_t)
+ * 	-Default is the flatmap default
+ * -Define TL_NO_ZERO_MEM to stop the zeroing of memory in non-critical code
+ * -Define TL_KEY_IS_NT to hash keys with tlhash_ntfnv1a(key)
+ * -Define TL_KEY_IS_INT when TL_K is an integer type to hash keys with the flatmap fibhash
+ * -Define TL_SEEDED_HASH to hash keys with the flatmap seeded hash
+ * -Define TL_TTL_BATCH to the number of expired entries handed to the expiry callback at once
+ * 	-Default is 64
+ *
+ *
+ * Examples:
+ *
+ * ---------- Example with primitive types:
+ * static void on_expire(const struct ttl_intint_entry* expired, size_t count, void* ctx) { ... }
+ *
+ * #define TL_K int
+ * #define TL_V int
+ * #define TL_NAME intint
+ * #include <ttlcache.h>
+ *
+ * struct ttl_intint cache;
+ * ttl_intint_init(&cache, now_ms(), on_expire, NULL);
+ * ttl_intint_put(&cache, session_id, state, 30000);
+ * ...
+ * ttl_intint_advance(&cache, now_ms());
+ * ttl_intint_deinit(&cache);
+ */
+
+#ifndef TL_K
+#error "TL_K not defined for ttlcache.h"
+#endif
+
+#ifndef TL_V
+#error "TL_V not defined for ttlcache.h"
+#endif
+
+#include <stdint.h>
+
+#include "private/common.h"
+
+#ifndef TL_NAME
+#error "TL_NAME not defined for ttlcache.h"
+#endif
+
+/**
+ * ttl_<TL_NAME>_key and ttl_<TL_NAME>_value
+ * The key and value types, named so that they outlive the flatmap instantiation below (which consumes TL_K/TL_V).
+ */
+typedef TL_K TLSYMBOL(TLSYMBOL(ttl,TL_NAME), key);
+typedef TL_V TLSYMBOL(TLSYMBOL(ttl,TL_NAME), value);
+#undef TL_K
+#undef TL_V
+
+/**
+ * ttl_<TL_NAME>_index
+ * The key index, a flatmap.h instantiation of key to entry position providing the ttl_<TL_NAME>_index_* functions.
+ */
+#ifdef ttl_key_equalsfn
+#define fmap_key_equalsfn(left, right) ttl_key_equalsfn(left, right)
+#endif
+#ifdef ttl_hashfn
+#define fmap_hashfn(key) ttl_hashfn(key)
+#endif
+#define TL_K TLSYMBOL(TLSYMBOL(ttl,TL_NAME), key)
+#define TL_V uint32_t
+#define TL_FMAP_PFX TLSYMBOL(TLSYMBOL(ttl,TL_NAME), index)
+#include "flatmap.h"
+
+#define _PFX TLSYMBOL(ttl,TL_NAME)
+#define TL_TTL_K TLSYMBOL(_PFX, key)
+#define TL_TTL_V TLSYMBOL(_PFX, value)
+
+#ifndef TL_TTL_BATCH
+#define TL_TTL_BATCH 64u
+#endif
+
+#define TL_TTL_NIL UINT32_MAX
+#define TL_TTL_BITS 6u
+#define TL_TTL_SLOTS 64u
+#define TL_TTL_LEVELS 11u
+#define TL_TTL_DUE (TL_TTL_LEVELS * TL_TTL_SLOTS)
+#define TL_TTL_LISTS (TL_TTL_DUE + 1u)
+
+
+/**
+ * ttl_<TL_NAME>_entry
+ * ttlcache entry containing a key, value pair, its expiry and its links in the wheel.
+ */
+struct TLSYMBOL(_PFX, entry)
+{
+	TL_TTL_K key;
+	TL_TTL_V value;
+	uint64_t expires;
+	uint32_t prev;
+	uint32_t next;
+	uint32_t list;
+};
+
+/**
+ * ttl_<TL_NAME>_expire_fn
+ * Called by ttl_<TL_NAME>_advance with up to TL_TTL_BATCH expired entries at a time. The entries have already been
+ * removed from the cache. The cache must not be modified from within.
+ */
+typedef void TLSYMBOL(_PFX, expire_fn)(const struct TLSYMBOL(_PFX, entry)* expired, size_t count, void* ctx);
+
+/**
+ * size        - (public) The number of live or not yet expired elements in the cache
+ * now         - (public) The last time given to advance (or init). Read only!
+ * index       - (private) The key index
+ * entries     - (private) The entries
+ * capacity    - (private) The number of entries allocated
+ * used        - (private) The number of entries ever handed out, entries past it have never been used
+ * free        - (private) The first entry of the free list (linked through next)
+ * lists       - (private) The first entry of each wheel slot, followed by the due list
+ * level_size  - (private) The number of entries held by each wheel level
+ * expire      - (private) The expiry callback, may be NULL
+ * expire_ctx  - (private) The context handed to expire
+ */
+struct _PFX
+{
+	size_t size;
+	uint64_t now;
+	struct TLSYMBOL(_PFX, index) index;
+	struct TLSYMBOL(_PFX, entry)* entries;
+	uint32_t capacity;
+	uint32_t used;
+	uint32_t free;
+	uint32_t lists[TL_TTL_LISTS];
+	size_t level_size[TL_TTL_LEVELS];
+	TLSYMBOL(_PFX, expire_fn)* expire;
+	void* expire_ctx;
+};
+
+
+/**
+ * ttl_<TL_NAME>_init
+ * Initialize a ttl_<TL_NAME> starting at time now.
+ *
+ * @param ttl The ttl_<TL_NAME> to initialize
+ * @param now The current time in ticks
+ * @param expire Called by ttl_<TL_NAME>_advance with the expired entries. May be NULL.
+ * @param expire_ctx Passed to every call of expire
+ * @return
+ * 	TLOK on successful initialization
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, init)(struct _PFX* ttl, const uint64_t now, TLSYMBOL(_PFX, expire_fn)* expire, void* expire_ctx)
+{
+	assert(ttl != NULL);
+
+	const uint32_t capacity = 16u;
+	ttl->entries = tlmalloc_large(capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+	if (!ttl->entries)
+		return TL_ERR_MEM;
+
+	if (TLSYMBOL(_PFX, index_init)(&ttl->index) != TLOK) {
+		tlfree_large(ttl->entries, capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+		return TL_ERR_MEM;
+	}
+
+	ttl->size = 0u;
+	ttl->now = now;
+	ttl->capacity = capacity;
+	ttl->used = 0u;
+	ttl->free = TL_TTL_NIL;
+	tlmemset(ttl->lists, 0xff, sizeof(ttl->lists));
+	tlmemset(ttl->level_size, 0, sizeof(ttl->level_size));
+	ttl->expire = expire;
+	ttl->expire_ctx = expire_ctx;
+	return TLOK;
+}
+
+
+/**
+ * ttl_<TL_NAME>_deinit
+ * Deinitialize an initialized ttl_<TL_NAME> without calling the expiry callback. Deinitialization frees the backing
+ * memory stores.
+ *
+ * Note:
+ * -Keys and Values are *not* freed. The user must do so.
+ *
+ * @param ttl The ttl_<TL_NAME> to deinitialize
+ */
+static inline void
+TLSYMBOL(_PFX, deinit)(struct _PFX* ttl)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	const size_t entry_bytes = ttl->capacity * sizeof(struct TLSYMBOL(_PFX, entry));
+	TLSYMBOL(_PFX, index_deinit)(&ttl->index);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(ttl->entries, TL_INIT_VAL, entry_bytes);
+	ttl->size = 0u;
+	ttl->capacity = 0u;
+	ttl->used = 0u;
+#endif
+	tlfree_large(ttl->entries, entry_bytes);
+	ttl->entries = NULL;
+}
+
+
+/**
+ * ttl_<TL_NAME>_new
+ * Heap allocate and initialize a new ttl_<TL_NAME> and then return a pointer to it.
+ *
+ * @param now The current time in ticks
+ * @param expire Called by ttl_<TL_NAME>_advance with the expired entries. May be NULL.
+ * @param expire_ctx Passed to every call of expire
+ * @return
+ * 	Pointer to a ttl_<TL_NAME> struct on success
+ * 	NULL if any error occurred acquiring memory
+ */
+static inline struct _PFX*
+TLSYMBOL(_PFX, new)(const uint64_t now, TLSYMBOL(_PFX, expire_fn)* expire, void* expire_ctx)
+{
+	struct _PFX* tmp = tlmalloc(sizeof(struct _PFX));
+	if (!tmp)
+		return NULL;
+
+	if (TLSYMBOL(_PFX, init)(tmp, now, expire, expire_ctx) != TLOK) {
+		tlfree(tmp);
+		return NULL;
+	}
+	return tmp;
+}
+
+
+/**
+ * ttl_<TL_NAME>_delete
+ * Deinitialize and delete a heap allocated ttl_<TL_NAME>. The given pointer is set to NULL.
+ *
+ * @param ttl The ttl_<TL_NAME> to delete.
+ */
+static inline void
+TLSYMBOL(_PFX, delete)(struct _PFX** ttl)
+{
+	assert(*ttl != NULL);
+
+	TLSYMBOL(_PFX, deinit)(*ttl);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(*ttl, TL_INIT_VAL, sizeof(struct _PFX));
+#endif
+	tlfree(*ttl);
+	*ttl = NULL;
+}
+
+
+/**
+ * list_level is for internal use only
+ * The level_size index of a list, or TL_TTL_LEVELS for the due list which is not counted.
+ */
+static inline size_t
+TLSYMBOL(_PFX, list_level)(const uint32_t list)
+{
+	return list / TL_TTL_SLOTS;
+}
+
+/**
+ * link is for internal use only
+ * Put an entry in the wheel slot (or list) matching its expiry relative to ttl->now.
+ */
+static inline void
+TLSYMBOL(_PFX, link)(struct _PFX* ttl, const uint32_t at)
+{
+	struct TLSYMBOL(_PFX, entry)* entry = &ttl->entries[at];
+	const uint64_t diff = entry->expires ^ ttl->now;
+	uint32_t list = TL_TTL_DUE;
+
+	if (entry->expires > ttl->now) {
+		/* climb until the parent slot one level up is shared with now, the top level has no parent */
+		uint32_t level = 0;
+		while (level + 1u < TL_TTL_LEVELS && (diff >> (TL_TTL_BITS * (level + 1u))) != 0) level++;
+		list = level * TL_TTL_SLOTS + (uint32_t)((entry->expires >> (TL_TTL_BITS * level)) & (TL_TTL_SLOTS - 1u));
+	}
+
+	entry->list = list;
+	entry->prev = TL_TTL_NIL;
+	entry->next = ttl->lists[list];
+	if (entry->next != TL_TTL_NIL) ttl->entries[entry->next].prev = at;
+	ttl->lists[list] = at;
+
+	const size_t level = TLSYMBOL(_PFX, list_level)(list);
+	if (level < TL_TTL_LEVELS) ttl->level_size[level]++;
+}
+
+/**
+ * unlink is for internal use only
+ * Take an entry out of its wheel slot.
+ */
+static inline void
+TLSYMBOL(_PFX, unlink)(struct _PFX* ttl, const uint32_t at)
+{
+	struct TLSYMBOL(_PFX, entry)* entry = &ttl->entries[at];
+
+	if (entry->prev != TL_TTL_NIL) ttl->entries[entry->prev].next = entry->next;
+	else ttl->lists[entry->list] = entry->next;
+	if (entry->next != TL_TTL_NIL) ttl->entries[entry->next].prev = entry->prev;
+
+	const size_t level = TLSYMBOL(_PFX, list_level)(entry->list);
+	if (level < TL_TTL_LEVELS) ttl->level_size[level]--;
+}
+
+/**
+ * release is for internal use only
+ * Return an entry to the free list.
+ */
+static inline void
+TLSYMBOL(_PFX, release)(struct _PFX* ttl, const uint32_t at)
+{
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(&ttl->entries[at], TL_INIT_VAL, sizeof(struct TLSYMBOL(_PFX, entry)));
+#endif
+	ttl->entries[at].next = ttl->free;
+	ttl->free = at;
+	ttl->size--;
+}
+
+/**
+ * acquire is for internal use only
+ * Hand out a free entry, growing the entry array when necessary. Returns TL_TTL_NIL when out of memory.
+ */
+static inline uint32_t
+TLSYMBOL(_PFX, acquire)(struct _PFX* ttl)
+{
+	if (ttl->free != TL_TTL_NIL) {
+		const uint32_t at = ttl->free;
+		ttl->free = ttl->entries[at].next;
+		return at;
+	}
+
+	if (ttl->used == ttl->capacity) {
+		if (ttl->capacity >= TL_TTL_NIL / 2u)
+			return TL_TTL_NIL;
+
+		const size_t old_bytes = ttl->capacity * sizeof(struct TLSYMBOL(_PFX, entry));
+		struct TLSYMBOL(_PFX, entry)* tmp = tlrealloc_large(ttl->entries, old_bytes, old_bytes * 2u);
+		if (!tmp)
+			return TL_TTL_NIL;
+
+		ttl->entries = tmp;
+		ttl->capacity *= 2u;
+	}
+	return ttl->used++;
+}
+
+
+/**
+ * ttl_<TL_NAME>_put
+ * Add a key/value pair expiring ttl_ticks after the current time, or replace the value and expiry of an existing key.
+ *
+ * @param ttl The ttl_<TL_NAME> to add the key/value pair to
+ * @param key The key
+ * @param value The value
+ * @param ttl_ticks The time to live. 0 expires the pair on the next call to advance.
+ * @return
+ * 	TLOK when the key was added
+ * 	TL_EAE when the key already existed and its value and expiry were replaced
+ * 	TL_ERR_MEM if there was an issue acquiring memory
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, put)(struct _PFX* ttl, TL_TTL_K key, TL_TTL_V value, const uint64_t ttl_ticks)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	const uint64_t expires = (ttl_ticks > UINT64_MAX - ttl->now) ? UINT64_MAX : ttl->now + ttl_ticks;
+	uint32_t at;
+
+	if (TLSYMBOL(_PFX, index_try_get)(&ttl->index, key, &at) == TLOK) {
+		TLSYMBOL(_PFX, unlink)(ttl, at);
+		ttl->entries[at].value = value;
+		ttl->entries[at].expires = expires;
+		TLSYMBOL(_PFX, link)(ttl, at);
+		return TL_EAE;
+	}
+
+	at = TLSYMBOL(_PFX, acquire)(ttl);
+	if (at == TL_TTL_NIL)
+		return TL_ERR_MEM;
+
+	if (TLSYMBOL(_PFX, index_insert)(&ttl->index, key, at) != TLOK) {
+		ttl->entries[at].next = ttl->free;
+		ttl->free = at;
+		return TL_ERR_MEM;
+	}
+
+	ttl->entries[at].key = key;
+	ttl->entries[at].value = value;
+	ttl->entries[at].expires = expires;
+	TLSYMBOL(_PFX, link)(ttl, at);
+	ttl->size++;
+	return TLOK;
+}
+
+
+/**
+ * ttl_<TL_NAME>_try_get
+ * Acquire a value for a given key that has not expired yet.
+ *
+ * @param ttl The ttl_<TL_NAME> to acquire the value from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- The value found for the given key
+ * @return
+ * 	TLOK when the key was found
+ * 	TL_ENF when the key was not found or has expired
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, try_get)(struct _PFX* ttl, TL_TTL_K key, TL_TTL_V* out_value)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	uint32_t at;
+	if (TLSYMBOL(_PFX, index_try_get)(&ttl->index, key, &at) != TLOK || ttl->entries[at].expires <= ttl->now)
+		return TL_ENF;
+
+	*out_value = ttl->entries[at].value;
+	return TLOK;
+}
+
+
+/**
+ * ttl_<TL_NAME>_get
+ * Returns the value for a given key that has not expired yet, or 0 if there is none.
+ *
+ * Note:
+ * -This function is not suitable if 0 is a valid value for you! use ttl_<TL_NAME>_try_get instead.
+ *
+ * @param ttl The ttl_<TL_NAME> to get a value from
+ * @param key The key to use for lookup
+ * @return The value paired with the given key
+ */
+static inline TL_TTL_V
+TLSYMBOL(_PFX, get)(struct _PFX* ttl, TL_TTL_K key)
+{
+	TL_TTL_V value;
+
+	if (TLSYMBOL(_PFX, try_get)(ttl, key, &value) != TLOK)
+		tlmemset(&value, TL_INIT_VAL, sizeof(TL_TTL_V));
+
+	return value;
+}
+
+
+/**
+ * ttl_<TL_NAME>_touch
+ * Reset the expiry of a key that has not expired yet to ttl_ticks after the current time.
+ *
+ * @param ttl The ttl_<TL_NAME> holding the key
+ * @param key The key to use for lookup
+ * @param ttl_ticks The new time to live
+ * @return
+ * 	TLOK when the expiry was reset
+ * 	TL_ENF when the key was not found or has expired
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, touch)(struct _PFX* ttl, TL_TTL_K key, const uint64_t ttl_ticks)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	uint32_t at;
+	if (TLSYMBOL(_PFX, index_try_get)(&ttl->index, key, &at) != TLOK || ttl->entries[at].expires <= ttl->now)
+		return TL_ENF;
+
+	TLSYMBOL(_PFX, unlink)(ttl, at);
+	ttl->entries[at].expires = (ttl_ticks > UINT64_MAX - ttl->now) ? UINT64_MAX : ttl->now + ttl_ticks;
+	TLSYMBOL(_PFX, link)(ttl, at);
+	return TLOK;
+}
+
+
+/**
+ * ttl_<TL_NAME>_remove
+ * Remove a key/value pair, expired or not, without calling the expiry callback.
+ *
+ * @param ttl The ttl_<TL_NAME> to remove an element from
+ * @param key The key to use for lookup
+ * @param out_value --Out-- Receives the removed value. May be NULL.
+ * @return
+ * 	TLOK upon successful removal
+ * 	TL_ENF if the key was not found. out_value will not be assigned.
+ */
+static inline enum tl_status
+TLSYMBOL(_PFX, remove)(struct _PFX* ttl, TL_TTL_K key, TL_TTL_V* out_value)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	uint32_t at;
+	if (TLSYMBOL(_PFX, index_remove)(&ttl->index, key, &at) != TLOK)
+		return TL_ENF;
+
+	if (out_value) *out_value = ttl->entries[at].value;
+	TLSYMBOL(_PFX, unlink)(ttl, at);
+	TLSYMBOL(_PFX, release)(ttl, at);
+	return TLOK;
+}
+
+
+/**
+ * expire_list is for internal use only
+ * Remove every entry of a wheel list, collecting them into batch and flushing full batches to the callback.
+ */
+static inline size_t
+TLSYMBOL(_PFX, expire_list)(struct _PFX* ttl, const uint32_t list, struct TLSYMBOL(_PFX, entry)* batch,
+	size_t* batch_size)
+{
+	size_t expired = 0;
+
+	while (ttl->lists[list] != TL_TTL_NIL) {
+		const uint32_t at = ttl->lists[list];
+
+		TLSYMBOL(_PFX, unlink)(ttl, at);
+		TLSYMBOL(_PFX, index_erase)(&ttl->index, ttl->entries[at].key);
+		batch[(*batch_size)++] = ttl->entries[at];
+		TLSYMBOL(_PFX, release)(ttl, at);
+		expired++;
+
+		if (*batch_size == TL_TTL_BATCH) {
+			if (ttl->expire) ttl->expire(batch, *batch_size, ttl->expire_ctx);
+			*batch_size = 0;
+		}
+	}
+	return expired;
+}
+
+/**
+ * cascade is for internal use only
+ * Move every entry of a higher level slot down to the slot matching ttl->now.
+ */
+static inline void
+TLSYMBOL(_PFX, cascade)(struct _PFX* ttl, const uint32_t list)
+{
+	uint32_t at = ttl->lists[list];
+
+	while (at != TL_TTL_NIL) {
+		const uint32_t next = ttl->entries[at].next;
+		TLSYMBOL(_PFX, unlink)(ttl, at);
+		TLSYMBOL(_PFX, link)(ttl, at);
+		at = next;
+	}
+}
+
+
+/**
+ * ttl_<TL_NAME>_advance
+ * Move the current time forward to now and remove every pair whose expiry is not after it. The removed pairs are
+ * handed to the expiry callback in batches of up to TL_TTL_BATCH, in expiry order between batches.
+ *
+ * Note:
+ * -Costs O(expired) plus at most a few steps per wheel level, however far time moves.
+ * -A now before the current time is ignored.
+ *
+ * @param ttl The ttl_<TL_NAME> to advance
+ * @param now The new current time in ticks
+ * @return The number of expired pairs
+ */
+static inline size_t
+TLSYMBOL(_PFX, advance)(struct _PFX* ttl, const uint64_t now)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	struct TLSYMBOL(_PFX, entry) batch[TL_TTL_BATCH];
+	size_t batch_size = 0;
+	size_t expired = TLSYMBOL(_PFX, expire_list)(ttl, TL_TTL_DUE, batch, &batch_size);
+
+	while (ttl->now < now) {
+		uint32_t level;
+		for (level = 0; level < TL_TTL_LEVELS && ttl->level_size[level] == 0; level++);
+		if (level == TL_TTL_LEVELS) {
+			ttl->now = now;
+			break;
+		}
+
+		/* nothing can happen before the next tick at which the lowest occupied level cascades */
+		const uint64_t span_bits = TL_TTL_BITS * level;
+		const uint64_t next = ((ttl->now >> span_bits) + 1u) << span_bits;
+		if (next == 0 || next > now) {
+			ttl->now = now;
+			break;
+		}
+		ttl->now = next;
+
+		for (uint32_t l = TL_TTL_LEVELS - 1u; l > 0; l--) {
+			if ((next & ((UINT64_C(1) << (TL_TTL_BITS * l)) - 1u)) == 0)
+				TLSYMBOL(_PFX, cascade)(ttl, l * TL_TTL_SLOTS + (uint32_t)((next >> (TL_TTL_BITS * l)) & (TL_TTL_SLOTS - 1u)));
+		}
+
+		expired += TLSYMBOL(_PFX, expire_list)(ttl, (uint32_t)(next & (TL_TTL_SLOTS - 1u)), batch, &batch_size);
+		expired += TLSYMBOL(_PFX, expire_list)(ttl, TL_TTL_DUE, batch, &batch_size);
+	}
+
+	if (batch_size != 0 && ttl->expire)
+		ttl->expire(batch, batch_size, ttl->expire_ctx);
+
+	return expired;
+}
+
+
+/**
+ * ttl_<TL_NAME>_clear
+ * Empty the cache without calling the expiry callback.
+ *
+ * @param ttl the ttl_<TL_NAME> to clear
+ */
+static inline void
+TLSYMBOL(_PFX, clear)(struct _PFX* ttl)
+{
+	assert(ttl != NULL);
+	assert(ttl->entries != NULL);
+
+	TLSYMBOL(_PFX, index_clear)(&ttl->index);
+#ifndef TL_NO_ZERO_MEM
+	tlmemset(ttl->entries, TL_INIT_VAL, ttl->capacity * sizeof(struct TLSYMBOL(_PFX, entry)));
+#endif
+	tlmemset(ttl->lists, 0xff, sizeof(ttl->lists));
+	tlmemset(ttl->level_size, 0, sizeof(ttl->level_size));
+	ttl->size = 0u;
+	ttl->used = 0u;
+	ttl->free = TL_TTL_NIL;
+}
+
+
+
+#undef TL_TTL_LISTS
+#undef TL_TTL_DUE
+#undef TL_TTL_LEVELS
+#undef TL_TTL_SLOTS
+#undef TL_TTL_BITS
+#undef TL_TTL_NIL
+#undef TL_TTL_BATCH
+#undef TL_TTL_V
+#undef TL_TTL_K
+#undef ttl_hashfn
+#undef ttl_key_equalsfn
+#undef _PFX
+#undef TL_NAME
+#undef TL_NO_ZERO_MEM
+#undef TL_KEY_IS_INT
+#undef TL_SEEDED_HASH
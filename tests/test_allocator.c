@@ -0,0 +1,135 @@
+#include <unity.h>
+
+#include <stdint.h>
+
+#define TL_HUGE_PAGES
+#define TL_HUGE_PAGE_THRESHOLD ((size_t)64u * 1024u)
+
+#define TL_T int
+#include "array.h"
+
+#define TL_K int
+#define TL_V int
+#include "flatmap.h"
+
+
+void setUp(void)
+{}
+
+void tearDown(void)
+{}
+
+
+void test_large_below_threshold(void)
+{
+	unsigned char* ptr = tlcalloc_large(16, 16);
+
+	TEST_ASSERT_NOT_NULL(ptr);
+	for (size_t i = 0; i < 256; i++) {
+		TEST_ASSERT_EQUAL_INT(0, ptr[i]);
+	}
+
+	tlfree_large(ptr, 256);
+}
+
+void test_large_above_threshold(void)
+{
+	const size_t size = TL_HUGE_PAGE_THRESHOLD * 2u;
+	unsigned char* ptr = tlcalloc_large(1, size);
+
+	TEST_ASSERT_NOT_NULL(ptr);
+	TEST_ASSERT_EQUAL_size_t(0, (size_t)ptr & (TL_HUGE_PAGE_SIZE - 1u));
+	for (size_t i = 0; i < size; i += 4096) {
+		TEST_ASSERT_EQUAL_INT(0, ptr[i]);
+	}
+	ptr[size - 1] = 10;
+
+	tlfree_large(ptr, size);
+}
+
+void test_large_calloc_overflow(void)
+{
+	TEST_ASSERT_NULL(tlcalloc_large(SIZE_MAX / 2u + 1u, 2u));
+	TEST_ASSERT_NULL(tlcalloc_large(2u, SIZE_MAX / 2u + 1u));
+}
+
+void test_large_realloc_across_threshold(void)
+{
+	const size_t small = TL_HUGE_PAGE_THRESHOLD / 2u;
+	const size_t large = TL_HUGE_PAGE_THRESHOLD * 3u;
+	unsigned char* ptr = tlmalloc_large(small);
+
+	TEST_ASSERT_NOT_NULL(ptr);
+	memset(ptr, 0x5a, small);
+
+	ptr = tlrealloc_large(ptr, small, large);
+	TEST_ASSERT_NOT_NULL(ptr);
+	TEST_ASSERT_EQUAL_INT(0x5a, ptr[0]);
+	TEST_ASSERT_EQUAL_INT(0x5a, ptr[small - 1]);
+	ptr[large - 1] = 0x11;
+
+	ptr = tlrealloc_large(ptr, large, small);
+	TEST_ASSERT_NOT_NULL(ptr);
+	TEST_ASSERT_EQUAL_INT(0x5a, ptr[0]);
+	TEST_ASSERT_EQUAL_INT(0x5a, ptr[small - 1]);
+
+	tlfree_large(ptr, small);
+}
+
+void test_array_grow_across_threshold(void)
+{
+	struct array_int array;
+	array_int_init(&array);
+
+	const int count = (int)(TL_HUGE_PAGE_THRESHOLD / sizeof(int)) * 4;
+	for (int i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, array_int_append(&array, i));
+	}
+
+	TEST_ASSERT_EQUAL_size_t((size_t)count, array.size);
+	for (int i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT(i, array.data[i]);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, array_int_shrink_to_fit(&array));
+	TEST_ASSERT_EQUAL_INT(count - 1, array.data[count - 1]);
+
+	array_int_deinit(&array);
+}
+
+void test_flatmap_grow_across_threshold(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	const int count = 50000;
+	for (int i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_insert(&fm, i, i * 3));
+	}
+
+	TEST_ASSERT(fm.capacity * sizeof(struct fmap_intint_node) >= TL_HUGE_PAGE_THRESHOLD);
+	TEST_ASSERT_EQUAL_size_t((size_t)count, fm.size);
+
+	int value = 0;
+	for (int i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, i, &value));
+		TEST_ASSERT_EQUAL_INT(i * 3, value);
+	}
+
+	fmap_intint_deinit(&fm);
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_large_below_threshold);
+	RUN_TEST(test_large_above_threshold);
+	RUN_TEST(test_large_calloc_overflow);
+	RUN_TEST(test_large_realloc_across_threshold);
+	RUN_TEST(test_array_grow_across_threshold);
+	RUN_TEST(test_flatmap_grow_across_threshold);
+
+	return UNITY_END();
+}
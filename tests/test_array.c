@@ -1,12 +1,32 @@
 #include "unity.h"
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define TL_THREADS
 #define TL_T int
+#define array_cmpfn(left, right) (((left) > (right)) - ((left) < (right)))
+#define array_radix_keyfn(element) tlradix_key_i32((element))
 
 #include "array.h"
 
+struct record
+{
+	uint32_t id;
+	uint32_t order;
+};
+
+#define TL_T struct record
+#define TL_NAME record
+#define array_cmpfn(left, right) (((left).id > (right).id) - ((left).id < (right).id))
+#define array_radix_keyfn(element) ((element).id)
+#include "array.h"
+
+#define TL_T double
+#define array_radix_keyfn(element) tlradix_key_f64((element))
+#include "array.h"
+
 void setUp(void)
 {}
 
@@ -162,6 +182,120 @@ void test_append_over_grow_bound(void)
 }
 
 
+void test_append_fractional_grow_factor(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 1.5f);
+
+	for (int i = 0; i < 5; i++) {
+		array_int_append(&array, i);
+	}
+
+	TEST_ASSERT_EQUAL_INT(array.size, 5);
+	TEST_ASSERT_EQUAL_INT(array.capacity, 6);
+
+	array_int_deinit(&array);
+}
+
+
+/**********************************************************************************************************************
+ * append_n, extend and append_fill Tests
+ **********************************************************************************************************************/
+
+void test_append_n_single_grow(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 2.0f);
+	int values[100];
+	for (int i = 0; i < 100; i++) {
+		values[i] = i * 3;
+	}
+
+	array_int_append(&array, -1);
+	TEST_ASSERT_EQUAL_INT(array_int_append_n(&array, values, 100), TLOK);
+
+	TEST_ASSERT_EQUAL_INT(array.size, 101);
+	TEST_ASSERT_EQUAL_INT(array.capacity, 101);
+	TEST_ASSERT_EQUAL_INT(array.data[0], -1);
+	for (int i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL_INT(array.data[i + 1], values[i]);
+	}
+
+	/* a small append_n on a full array still grows by the grow factor */
+	TEST_ASSERT_EQUAL_INT(array_int_append_n(&array, values, 2), TLOK);
+	TEST_ASSERT_EQUAL_INT(array.size, 103);
+	TEST_ASSERT_EQUAL_INT(array.capacity, 202);
+
+	TEST_ASSERT_EQUAL_INT(array_int_append_n(&array, NULL, 0), TLOK);
+	TEST_ASSERT_EQUAL_INT(array.size, 103);
+
+	array_int_deinit(&array);
+}
+
+void test_append_n_from_itself(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 2.0f);
+	for (int i = 0; i < 4; i++) {
+		array_int_append(&array, i);
+	}
+
+	/* the source range lives in the block that gets reallocated */
+	TEST_ASSERT_EQUAL_INT(array_int_append_n(&array, array.data + 1, 3), TLOK);
+
+	int expected[] = {0, 1, 2, 3, 1, 2, 3};
+	TEST_ASSERT_EQUAL_INT(array.size, 7);
+	for (int i = 0; i < 7; i++) {
+		TEST_ASSERT_EQUAL_INT(array.data[i], expected[i]);
+	}
+
+	array_int_deinit(&array);
+}
+
+void test_extend(void)
+{
+	struct array_int array;
+	struct array_int other;
+	array_int_init_all(&array, 4, 2.0f);
+	array_int_init_all(&other, 4, 2.0f);
+	array_int_append(&array, 10);
+	array_int_append(&other, 20);
+	array_int_append(&other, 30);
+
+	TEST_ASSERT_EQUAL_INT(array_int_extend(&array, &other), TLOK);
+	TEST_ASSERT_EQUAL_INT(array_int_extend(&array, &array), TLOK);
+
+	int expected[] = {10, 20, 30, 10, 20, 30};
+	TEST_ASSERT_EQUAL_INT(array.size, 6);
+	TEST_ASSERT_EQUAL_INT(array.capacity, 8);
+	for (int i = 0; i < 6; i++) {
+		TEST_ASSERT_EQUAL_INT(array.data[i], expected[i]);
+	}
+	TEST_ASSERT_EQUAL_INT(other.size, 2);
+
+	array_int_deinit(&other);
+	array_int_deinit(&array);
+}
+
+void test_append_fill(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 2.0f);
+	array_int_append(&array, 1);
+
+	TEST_ASSERT_EQUAL_INT(array_int_append_fill(&array, 7, 1000), TLOK);
+	TEST_ASSERT_EQUAL_INT(array_int_append_fill(&array, 9, 0), TLOK);
+
+	TEST_ASSERT_EQUAL_INT(array.size, 1001);
+	TEST_ASSERT_EQUAL_INT(array.capacity, 1001);
+	TEST_ASSERT_EQUAL_INT(array.data[0], 1);
+	for (int i = 1; i < 1001; i++) {
+		TEST_ASSERT_EQUAL_INT(array.data[i], 7);
+	}
+
+	array_int_deinit(&array);
+}
+
 
 /**********************************************************************************************************************
  * push Tests
@@ -689,6 +823,396 @@ void test_clear(void)
 	array_int_deinit(&array);
 }
 
+/**********************************************************************************************************************
+ * sort Tests
+ **********************************************************************************************************************/
+
+static int
+int_compare(const void* left, const void* right)
+{
+	const int l = *(const int*)left;
+	const int r = *(const int*)right;
+	return (l > r) - (l < r);
+}
+
+static unsigned int sort_state = 12345u;
+
+static int
+sort_random(void)
+{
+	sort_state ^= sort_state << 13;
+	sort_state ^= sort_state >> 17;
+	sort_state ^= sort_state << 5;
+	return (int)(sort_state & 0x7fffffffu);
+}
+
+/* fill an array of size elements with one of the input patterns and check the sort against qsort */
+static void
+check_sort_pattern(const int pattern, const size_t size)
+{
+	struct array_int array;
+	array_int_init_all(&array, size + 2, 2.0f);
+	int* expected = malloc((size + 1) * sizeof(int));
+
+	for (size_t i = 0; i < size; i++) {
+		int value;
+		switch (pattern) {
+		case 0: value = sort_random(); break;                                   /* random */
+		case 1: value = (int)i; break;                                          /* sorted */
+		case 2: value = (int)(size - i); break;                                 /* reversed */
+		case 3: value = 7; break;                                               /* all equal */
+		case 4: value = sort_random() % 4; break;                               /* few distinct */
+		case 5: value = (int)((i < size / 2) ? i : size - i); break;            /* organ pipe */
+		case 6: value = (int)(i % 16); break;                                   /* sawtooth */
+		default: value = (i % 100 == 0) ? sort_random() : (int)i; break;       /* sorted with noise */
+		}
+		array_int_append(&array, value);
+		expected[i] = value;
+	}
+
+	qsort(expected, size, sizeof(int), &int_compare);
+	array_int_sort(&array);
+
+	TEST_ASSERT_EQUAL_INT(array.size, size);
+	for (size_t i = 0; i < size; i++) {
+		TEST_ASSERT_EQUAL_INT(expected[i], array.data[i]);
+	}
+
+	free(expected);
+	array_int_deinit(&array);
+}
+
+void test_sort_small(void)
+{
+	for (int pattern = 0; pattern < 8; pattern++) {
+		for (size_t size = 0; size <= 64; size++) {
+			check_sort_pattern(pattern, size);
+		}
+	}
+}
+
+void test_sort_networks(void)
+{
+	/* a network sorting every 0/1 input sorts every input */
+	struct array_int array;
+	array_int_init_all(&array, 8, 2.0f);
+
+	for (size_t size = 2; size <= 5; size++) {
+		for (unsigned bits = 0; bits < (1u << size); bits++) {
+			array_int_clear(&array);
+			unsigned ones = 0;
+			for (size_t i = 0; i < size; i++) {
+				array_int_append(&array, (int)((bits >> i) & 1u));
+				ones += (bits >> i) & 1u;
+			}
+			array_int_sort(&array);
+			for (size_t i = 0; i < size; i++) {
+				TEST_ASSERT_EQUAL_INT((i >= size - ones) ? 1 : 0, array.data[i]);
+			}
+		}
+	}
+
+	array_int_deinit(&array);
+}
+
+void test_sort_large(void)
+{
+	for (int pattern = 0; pattern < 8; pattern++) {
+		check_sort_pattern(pattern, 100000);
+	}
+}
+
+
+/**********************************************************************************************************************
+ * radix_sort Tests
+ **********************************************************************************************************************/
+
+void test_radix_sort_ints(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 2.0f);
+	int* expected = malloc(100002 * sizeof(int));
+
+	/* below the insertion sort threshold, the LSD passes, then the most significant digit split, with negatives */
+	const size_t sizes[] = {0, 1, 2, 63, 64, 50000, 100000};
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		array_int_clear(&array);
+		for (size_t i = 0; i < sizes[s]; i++) {
+			const int value = sort_random() - 0x40000000;
+			array_int_append(&array, value);
+			expected[i] = value;
+		}
+		array_int_append(&array, INT_MIN);
+		array_int_append(&array, INT_MAX);
+		expected[sizes[s]] = INT_MIN;
+		expected[sizes[s] + 1] = INT_MAX;
+
+		qsort(expected, array.size, sizeof(int), &int_compare);
+		TEST_ASSERT_EQUAL_INT(array_int_radix_sort(&array), TLOK);
+		for (size_t i = 0; i < array.size; i++) {
+			TEST_ASSERT_EQUAL_INT(expected[i], array.data[i]);
+		}
+	}
+
+	free(expected);
+	array_int_deinit(&array);
+}
+
+void test_radix_sort_stable_by_field(void)
+{
+	struct array_record array;
+	array_record_init_all(&array, 4, 2.0f);
+
+	/* few distinct ids in the low byte only, so the upper passes are skipped */
+	for (uint32_t i = 0; i < 10000; i++) {
+		struct record rec;
+		rec.id = (uint32_t)sort_random() % 37u;
+		rec.order = i;
+		array_record_append(&array, rec);
+	}
+
+	TEST_ASSERT_EQUAL_INT(array_record_radix_sort(&array), TLOK);
+	TEST_ASSERT_EQUAL_INT(array.size, 10000);
+	for (size_t i = 1; i < array.size; i++) {
+		TEST_ASSERT_TRUE(array.data[i - 1].id <= array.data[i].id);
+		if (array.data[i - 1].id == array.data[i].id) {
+			TEST_ASSERT_TRUE(array.data[i - 1].order < array.data[i].order);
+		}
+	}
+
+	array_record_deinit(&array);
+}
+
+void test_radix_sort_stable_large(void)
+{
+	struct array_record array;
+	array_record_init_all(&array, 4, 2.0f);
+
+	/* 17 bit ids over enough records to split on the most significant digit first */
+	for (uint32_t i = 0; i < 200000; i++) {
+		struct record rec;
+		rec.id = (uint32_t)sort_random() % 100000u;
+		rec.order = i;
+		array_record_append(&array, rec);
+	}
+
+	TEST_ASSERT_EQUAL_INT(array_record_radix_sort(&array), TLOK);
+	for (size_t i = 1; i < array.size; i++) {
+		TEST_ASSERT_TRUE(array.data[i - 1].id <= array.data[i].id);
+		if (array.data[i - 1].id == array.data[i].id) {
+			TEST_ASSERT_TRUE(array.data[i - 1].order < array.data[i].order);
+		}
+	}
+
+	array_record_deinit(&array);
+}
+
+void test_radix_sort_doubles(void)
+{
+	struct array_double array;
+	array_double_init_all(&array, 4, 2.0f);
+
+	const double specials[] = {-1e300, -2.5, -0.0, 0.0, 1e-310, 3.0, 1e300};
+	for (size_t i = 0; i < 1000; i++) {
+		array_double_append(&array, (double)(sort_random() % 2001 - 1000) / 8.0);
+	}
+	for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); i++) {
+		array_double_append(&array, specials[i]);
+	}
+
+	TEST_ASSERT_EQUAL_INT(array_double_radix_sort(&array), TLOK);
+	TEST_ASSERT_EQUAL_INT(array.size, 1007);
+	TEST_ASSERT_TRUE(array.data[0] == -1e300);
+	TEST_ASSERT_TRUE(array.data[1006] == 1e300);
+	for (size_t i = 1; i < array.size; i++) {
+		TEST_ASSERT_TRUE(array.data[i - 1] <= array.data[i]);
+	}
+
+	array_double_deinit(&array);
+}
+
+
+/**********************************************************************************************************************
+ * par_sort and par_stable_sort Tests
+ **********************************************************************************************************************/
+
+void test_par_sort(void)
+{
+	const size_t size = 300001;
+	const size_t threads[] = {0, 1, 2, 3, 8};
+	struct array_int array;
+	array_int_init_all(&array, size, 2.0f);
+	int* expected = malloc(size * sizeof(int));
+
+	for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+		array_int_clear(&array);
+		for (size_t i = 0; i < size; i++) {
+			const int value = sort_random() % 1000;
+			array_int_append(&array, value);
+			expected[i] = value;
+		}
+
+		qsort(expected, size, sizeof(int), &int_compare);
+		TEST_ASSERT_EQUAL_INT(array_int_par_sort(&array, threads[t]), TLOK);
+		for (size_t i = 0; i < size; i++) {
+			TEST_ASSERT_EQUAL_INT(expected[i], array.data[i]);
+		}
+	}
+
+	/* below the threshold */
+	array_int_clear(&array);
+	array_int_append(&array, 3);
+	array_int_append(&array, 1);
+	array_int_append(&array, 2);
+	TEST_ASSERT_EQUAL_INT(array_int_par_sort(&array, 4), TLOK);
+	TEST_ASSERT_EQUAL_INT(array.data[0], 1);
+	TEST_ASSERT_EQUAL_INT(array.data[1], 2);
+	TEST_ASSERT_EQUAL_INT(array.data[2], 3);
+
+	free(expected);
+	array_int_deinit(&array);
+}
+
+void test_par_stable_sort(void)
+{
+	const size_t size = 250000;
+	const size_t threads[] = {1, 3, 4, 7};
+	struct array_record original;
+	struct array_record reference;
+	struct array_record array;
+	array_record_init_all(&original, size, 2.0f);
+	array_record_init_all(&reference, size, 2.0f);
+	array_record_init_all(&array, size, 2.0f);
+
+	for (uint32_t i = 0; i < size; i++) {
+		struct record rec;
+		rec.id = (uint32_t)sort_random() % 5000u;
+		rec.order = i;
+		array_record_append(&original, rec);
+	}
+	array_record_extend(&reference, &original);
+	TEST_ASSERT_EQUAL_INT(array_record_radix_sort(&reference), TLOK);
+
+	/* the order of equal ids is kept, so every thread count gives the result of the (stable) radix sort */
+	for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+		array_record_clear(&array);
+		array_record_extend(&array, &original);
+
+		TEST_ASSERT_EQUAL_INT(array_record_par_stable_sort(&array, threads[t]), TLOK);
+		for (size_t i = 0; i < size; i++) {
+			TEST_ASSERT_EQUAL_UINT32(reference.data[i].id, array.data[i].id);
+			TEST_ASSERT_EQUAL_UINT32(reference.data[i].order, array.data[i].order);
+		}
+	}
+
+	array_record_deinit(&array);
+	array_record_deinit(&reference);
+	array_record_deinit(&original);
+}
+
+/**********************************************************************************************************************
+ * lower_bound, upper_bound, equal_range, contains_sorted and insert_sorted Tests
+ **********************************************************************************************************************/
+
+void test_bounds(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 2.0f);
+
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, 5), 0);
+	TEST_ASSERT_EQUAL_INT(array_int_upper_bound(&array, 5), 0);
+
+	/* 0, 2, 2, 2, 4, 6, ... 198 */
+	for (int i = 0; i < 100; i++) {
+		array_int_append(&array, i * 2);
+	}
+	array_int_insert(&array, 1, 2);
+	array_int_insert(&array, 1, 2);
+
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, -1), 0);
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, 0), 0);
+	TEST_ASSERT_EQUAL_INT(array_int_upper_bound(&array, 0), 1);
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, 2), 1);
+	TEST_ASSERT_EQUAL_INT(array_int_upper_bound(&array, 2), 4);
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, 3), 4);
+	TEST_ASSERT_EQUAL_INT(array_int_upper_bound(&array, 3), 4);
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, 198), 101);
+	TEST_ASSERT_EQUAL_INT(array_int_upper_bound(&array, 198), 102);
+	TEST_ASSERT_EQUAL_INT(array_int_lower_bound(&array, 1000), 102);
+
+	/* every size up to 40 against a linear scan */
+	for (size_t size = 0; size <= 40; size++) {
+		array_int_clear(&array);
+		for (size_t i = 0; i < size; i++) {
+			array_int_append(&array, (int)(i / 3));
+		}
+		for (int value = -1; value <= (int)(size / 3) + 1; value++) {
+			size_t lower = 0;
+			size_t upper = 0;
+			while (lower < size && array.data[lower] < value) lower++;
+			while (upper < size && array.data[upper] <= value) upper++;
+			TEST_ASSERT_EQUAL_INT(lower, array_int_lower_bound(&array, value));
+			TEST_ASSERT_EQUAL_INT(upper, array_int_upper_bound(&array, value));
+		}
+	}
+
+	array_int_deinit(&array);
+}
+
+void test_equal_range_and_contains(void)
+{
+	struct array_int array;
+	array_int_init_all(&array, 4, 2.0f);
+	const int values[] = {1, 3, 3, 3, 3, 7, 9};
+	array_int_append_n(&array, values, 7);
+
+	size_t first = 0;
+	size_t last = 0;
+	array_int_equal_range(&array, 3, &first, &last);
+	TEST_ASSERT_EQUAL_INT(first, 1);
+	TEST_ASSERT_EQUAL_INT(last, 5);
+	array_int_equal_range(&array, 5, &first, &last);
+	TEST_ASSERT_EQUAL_INT(first, 5);
+	TEST_ASSERT_EQUAL_INT(last, 5);
+	array_int_equal_range(&array, 10, &first, &last);
+	TEST_ASSERT_EQUAL_INT(first, 7);
+	TEST_ASSERT_EQUAL_INT(last, 7);
+
+	TEST_ASSERT_TRUE(array_int_contains_sorted(&array, 1));
+	TEST_ASSERT_TRUE(array_int_contains_sorted(&array, 3));
+	TEST_ASSERT_TRUE(array_int_contains_sorted(&array, 9));
+	TEST_ASSERT_FALSE(array_int_contains_sorted(&array, 0));
+	TEST_ASSERT_FALSE(array_int_contains_sorted(&array, 5));
+	TEST_ASSERT_FALSE(array_int_contains_sorted(&array, 10));
+
+	array_int_deinit(&array);
+}
+
+void test_insert_sorted(void)
+{
+	struct array_record array;
+	array_record_init_all(&array, 2, 2.0f);
+
+	for (uint32_t i = 0; i < 1000; i++) {
+		struct record rec;
+		rec.id = (uint32_t)sort_random() % 50u;
+		rec.order = i;
+		TEST_ASSERT_EQUAL_INT(array_record_insert_sorted(&array, rec), TLOK);
+	}
+
+	/* equal ids are inserted after each other, so they stay in insertion order */
+	TEST_ASSERT_EQUAL_INT(array.size, 1000);
+	for (size_t i = 1; i < array.size; i++) {
+		TEST_ASSERT_TRUE(array.data[i - 1].id <= array.data[i].id);
+		if (array.data[i - 1].id == array.data[i].id) {
+			TEST_ASSERT_TRUE(array.data[i - 1].order < array.data[i].order);
+		}
+	}
+
+	array_record_deinit(&array);
+}
+
+
 
 
 
@@ -711,6 +1235,12 @@ int main(void)
 	RUN_TEST(test_append_two);
 	RUN_TEST(test_append_pre_grow_bound);
 	RUN_TEST(test_append_over_grow_bound);
+	RUN_TEST(test_append_fractional_grow_factor);
+
+	RUN_TEST(test_append_n_single_grow);
+	RUN_TEST(test_append_n_from_itself);
+	RUN_TEST(test_extend);
+	RUN_TEST(test_append_fill);
 
 	RUN_TEST(test_push_one);
 	RUN_TEST(test_push_two);
@@ -743,6 +1273,22 @@ int main(void)
 	RUN_TEST(test_ensure_capacity_above);
 	RUN_TEST(test_clear);
 
+	RUN_TEST(test_sort_small);
+	RUN_TEST(test_sort_networks);
+	RUN_TEST(test_sort_large);
+
+	RUN_TEST(test_radix_sort_ints);
+	RUN_TEST(test_radix_sort_stable_by_field);
+	RUN_TEST(test_radix_sort_stable_large);
+	RUN_TEST(test_radix_sort_doubles);
+
+	RUN_TEST(test_par_sort);
+	RUN_TEST(test_par_stable_sort);
+
+	RUN_TEST(test_bounds);
+	RUN_TEST(test_equal_range_and_contains);
+	RUN_TEST(test_insert_sorted);
+
 	return UNITY_END();
 }
 
@@ -0,0 +1,82 @@
+#include <unity.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "private/map_scan.h"
+
+
+void setUp(void)
+{}
+
+void tearDown(void)
+{
+	tl_cpu_limit(~0u);
+}
+
+
+void test_features(void)
+{
+	const unsigned features = tl_cpu_features();
+
+	/* every wider instruction set implies the narrower ones */
+	if (features & TL_CPU_AVX512) TEST_ASSERT(features & TL_CPU_AVX2);
+	if (features & TL_CPU_AVX2) TEST_ASSERT(features & TL_CPU_SSE42);
+	if (features & TL_CPU_SSE42) TEST_ASSERT(features & TL_CPU_SSE2);
+
+	tl_cpu_limit(TL_CPU_SSE2);
+	TEST_ASSERT_EQUAL_UINT(features & TL_CPU_SSE2, tl_cpu_features());
+	tl_cpu_limit(0);
+	TEST_ASSERT_EQUAL_UINT(0, tl_cpu_features());
+	tl_cpu_limit(~0u);
+	TEST_ASSERT_EQUAL_UINT(features, tl_cpu_features());
+}
+
+void test_ctz64(void)
+{
+	TEST_ASSERT_EQUAL_UINT(0, tl_cpu_ctz64(1));
+	TEST_ASSERT_EQUAL_UINT(5, tl_cpu_ctz64(0x60));
+	TEST_ASSERT_EQUAL_UINT(63, tl_cpu_ctz64(UINT64_C(1) << 63));
+}
+
+void test_map_used_bits_variants(void)
+{
+	const unsigned limits[] = {0, TL_CPU_SSE2, TL_CPU_SSE2 | TL_CPU_SSE42 | TL_CPU_AVX2, ~0u};
+	enum tl_map_slot_state info[64 * 4 + 17];
+	const size_t count = sizeof(info) / sizeof(info[0]);
+
+	srand(7);
+	for (size_t round = 0; round < 50; round++) {
+		for (size_t i = 0; i < count; i++) {
+			info[i] = (enum tl_map_slot_state)(rand() % 4);
+		}
+
+		for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++) {
+			tl_cpu_limit(limits[l]);
+
+			/* every start, so partial words and unaligned loads are covered */
+			for (size_t start = 0; start < count; start += 7) {
+				const uint64_t used = tl_map_used_bits(info + start, count - start);
+				const size_t n = (count - start < 64) ? count - start : 64;
+
+				for (size_t i = 0; i < 64; i++) {
+					const int expect = i < n && (info[start + i] == TL_MAPSS_OCCUPIED
+						|| info[start + i] == TL_MAPSS_COLLIDED);
+					TEST_ASSERT_EQUAL_INT(expect, (int)((used >> i) & 1u));
+				}
+			}
+		}
+	}
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_features);
+	RUN_TEST(test_ctz64);
+	RUN_TEST(test_map_used_bits_variants);
+
+	return UNITY_END();
+}
@@ -0,0 +1,234 @@
+#include <unity.h>
+
+#include <stdint.h>
+
+static size_t hash_calls = 0;
+
+static size_t
+counting_hash(int key)
+{
+	hash_calls++;
+	return (size_t)key * 0x9e3779b9u;
+}
+
+#define TL_FMAP_SMALL 8
+#define fmap_hashfn(key) counting_hash(key)
+#define TL_K int
+#define TL_V int
+#include "flatmap.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_FMAP_SMALL 4
+#define fmap_value_copyfn(value) ((value) + 1000)
+#define TL_K int
+#define TL_V int
+#define TL_NAME nzm
+#include "flatmap.h"
+
+
+void setUp(void)
+{
+	hash_calls = 0;
+}
+
+void tearDown(void)
+{}
+
+
+void test_init_is_inline(void)
+{
+	struct fmap_intint fm;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_init(&fm));
+	TEST_ASSERT_EQUAL_PTR(fm.small_nodes, fm.nodes);
+	TEST_ASSERT_EQUAL_PTR(fm.small_info, fm.info);
+	TEST_ASSERT_EQUAL_size_t(8, fm.capacity);
+	TEST_ASSERT_EQUAL_size_t(0, fm.size);
+
+	fmap_intint_deinit(&fm);
+	TEST_ASSERT_NULL(fm.nodes);
+}
+
+void test_small_no_hashing(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 7; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_insert(&fm, i, i * 2));
+	}
+	TEST_ASSERT_EQUAL_INT(TL_EAE, fmap_intint_add(&fm, 3, 0));
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_add(&fm, 7, 14));
+
+	int value = 0;
+	for (int i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, i, &value));
+		TEST_ASSERT_EQUAL_INT(i * 2, value);
+		TEST_ASSERT_EQUAL_INT(i * 2, fmap_intint_get(&fm, i));
+	}
+	TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_try_get(&fm, 100, &value));
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_erase(&fm, 2));
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_remove(&fm, 5, &value));
+	TEST_ASSERT_EQUAL_INT(10, value);
+	TEST_ASSERT_EQUAL_size_t(6, fm.size);
+
+	TEST_ASSERT_EQUAL_PTR(fm.small_nodes, fm.nodes);
+	TEST_ASSERT_EQUAL_size_t(0, hash_calls);
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_spill_to_hashed(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_add(&fm, i, -i));
+	}
+
+	TEST_ASSERT(fm.nodes != fm.small_nodes);
+	TEST_ASSERT(hash_calls > 0);
+	TEST_ASSERT_EQUAL_size_t(100, fm.size);
+	for (int i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL_INT(-i, fmap_intint_get(&fm, i));
+	}
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_spill_colliding_keys(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	/* every inline key lands in the last of the default 8 buckets of 3 slots, so the first hashed layout overflows */
+	int keys[8];
+	int found = 0;
+	for (int k = 0; found < 8; k++) {
+		if ((((size_t)k * 0x9e3779b9u) & 7u) == 7u) keys[found++] = k;
+	}
+	for (int i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_add(&fm, keys[i], i));
+	}
+	TEST_ASSERT_EQUAL_PTR(fm.small_nodes, fm.nodes);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_add(&fm, 1000, 1000));
+	TEST_ASSERT(fm.nodes != fm.small_nodes);
+	TEST_ASSERT(fm.num_buckets > 8);
+	TEST_ASSERT_EQUAL_size_t(9, fm.size);
+	for (int i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_INT(i, fmap_intint_get(&fm, keys[i]));
+	}
+	TEST_ASSERT_EQUAL_INT(1000, fmap_intint_get(&fm, 1000));
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_reserve_from_small(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+	fmap_intint_insert(&fm, 1, 1);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_reserve(&fm, 4));
+	TEST_ASSERT_EQUAL_PTR(fm.small_nodes, fm.nodes);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_reserve(&fm, 50));
+	TEST_ASSERT(fm.nodes != fm.small_nodes);
+	TEST_ASSERT(fm.load_max >= 50);
+	TEST_ASSERT_EQUAL_INT(1, fmap_intint_get(&fm, 1));
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_new_delete_small(void)
+{
+	struct fmap_intint* fm = fmap_intint_new();
+
+	TEST_ASSERT_NOT_NULL(fm);
+	TEST_ASSERT_EQUAL_PTR(fm->small_nodes, fm->nodes);
+	fmap_intint_insert(fm, 7, 70);
+	TEST_ASSERT_EQUAL_INT(70, fmap_intint_get(fm, 7));
+
+	fmap_intint_delete(&fm);
+	TEST_ASSERT_NULL(fm);
+}
+
+void test_init_all_is_hashed(void)
+{
+	struct fmap_intint fm;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_init_all(&fm, 16, 70));
+	TEST_ASSERT(fm.nodes != fm.small_nodes);
+	fmap_intint_insert(&fm, 1, 2);
+	TEST_ASSERT_EQUAL_INT(2, fmap_intint_get(&fm, 1));
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_clone_small(void)
+{
+	struct fmap_nzm src;
+	struct fmap_nzm dst;
+	fmap_nzm_init(&src);
+
+	for (int i = 0; i < 3; i++) {
+		fmap_nzm_insert(&src, i, i);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_nzm_clone(&dst, &src));
+	TEST_ASSERT_EQUAL_PTR(dst.small_nodes, dst.nodes);
+	TEST_ASSERT_EQUAL_PTR(dst.small_info, dst.info);
+	for (int i = 0; i < 3; i++) {
+		TEST_ASSERT_EQUAL_INT(i, fmap_nzm_get(&src, i));
+		TEST_ASSERT_EQUAL_INT(i + 1000, fmap_nzm_get(&dst, i));
+	}
+
+	fmap_nzm_deinit(&src);
+	fmap_nzm_deinit(&dst);
+}
+
+void test_tombstones_spill(void)
+{
+	struct fmap_nzm fm;
+	fmap_nzm_init(&fm);
+
+	for (int round = 0; round < 10; round++) {
+		for (int i = 0; i < 4; i++) {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_nzm_insert(&fm, round * 10 + i, i));
+		}
+		for (int i = 0; i < 4; i++) {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_nzm_erase(&fm, round * 10 + i));
+		}
+	}
+	TEST_ASSERT_EQUAL_size_t(0, fm.size);
+
+	for (int i = 0; i < 20; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_nzm_insert(&fm, i, i));
+	}
+	for (int i = 0; i < 20; i++) {
+		TEST_ASSERT_EQUAL_INT(i, fmap_nzm_get(&fm, i));
+	}
+
+	fmap_nzm_deinit(&fm);
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_init_is_inline);
+	RUN_TEST(test_small_no_hashing);
+	RUN_TEST(test_spill_to_hashed);
+	RUN_TEST(test_spill_colliding_keys);
+	RUN_TEST(test_reserve_from_small);
+	RUN_TEST(test_new_delete_small);
+	RUN_TEST(test_init_all_is_hashed);
+	RUN_TEST(test_clone_small);
+	RUN_TEST(test_tombstones_spill);
+
+	return UNITY_END();
+}
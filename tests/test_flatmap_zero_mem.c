@@ -2,8 +2,50 @@
 
 #include <stdint.h>
 
+#define TL_T int
+#include "array.h"
+
+#ifdef TEST_TL_NO_ZERO_MEM
+#define TL_NO_ZERO_MEM
+#endif
+#define TL_THREADS
+#define TL_FMAP_PARALLEL_THRESHOLD 5000u
+#define TL_FMAP_KEY_ARRAY array_int
+#define TL_FMAP_VALUE_ARRAY array_int
+#define TL_K int
+#define TL_V int
+#include "flatmap.h"
+
+#define fmap_value_copyfn(value) ((value) + 1000)
+#define TL_K int
+#define TL_V int
+#define TL_NAME deep
+#include "flatmap.h"
+
+#define TL_FMAP_HASH_QUALITY
+#define TL_KEY_IS_INT
+#define TL_K int
+#define TL_V int
+#define TL_NAME intkey
+#include "flatmap.h"
+
+#define TL_SEEDED_HASH
+#define TL_K int
+#define TL_V int
+#define TL_NAME seeded
+#include "flatmap.h"
+
+#define fmap_hashfn(key) ((size_t)(key) & 0xffu)
+#define TL_K int
+#define TL_V int
+#define TL_NAME lowbyte
+#include "flatmap.h"
+
+#define TL_FMAP_FROZEN_SEEDS 2u
+#define TL_FMAP_FROZEN_MAX_DISP 1u
 #define TL_K int
 #define TL_V int
+#define TL_NAME nodisp
 #include "flatmap.h"
 
 
@@ -2065,7 +2107,729 @@ void test_remove_all(void)
 
 #endif
 
+void test_erase_insert_reuses_slots(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init_all(&fm, 8, 70);
+
+	int key = find_key_in_bucket(3, fm.slot_mask, 19385);
+	const size_t capacity = fm.capacity;
+
+	/* with TL_NO_ZERO_MEM the erased slot is a tombstone, which the insert must take again instead of growing */
+	for (int i = 0; i < 1000; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_insert(&fm, key, i));
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_erase(&fm, key));
+	}
+
+	TEST_ASSERT_EQUAL_size_t(0u, fm.size);
+	TEST_ASSERT_EQUAL_size_t(capacity, fm.capacity);
+
+	fmap_intint_deinit(&fm);
+}
+
+
+
+
+/**********************************************************************************************************************
+ * bulk Tests
+ **********************************************************************************************************************/
+
+void test_reserve(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
 
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_reserve(&fm, 1000));
+
+	TEST_ASSERT_EQUAL_size_t(256, fm.num_buckets);
+	TEST_ASSERT_EQUAL_size_t(8, fm.bucket_max);
+	TEST_ASSERT_EQUAL_size_t(255, fm.slot_mask);
+	TEST_ASSERT_EQUAL_size_t(2048, fm.capacity);
+	TEST_ASSERT_EQUAL_size_t(1433, fm.load_max);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_reserve(&fm, 10));
+	TEST_ASSERT_EQUAL_size_t(256, fm.num_buckets);
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_reserve_keeps_elements(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 10; i++) {
+		fmap_intint_add(&fm, i, i + 100);
+	}
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_reserve(&fm, 5000));
+
+	int value = 0;
+	for (int i = 0; i < 10; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, i, &value));
+		TEST_ASSERT_EQUAL_INT(i + 100, value);
+	}
+	TEST_ASSERT_EQUAL_size_t(10, fm.size);
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_insert_n(void)
+{
+	const int count = 3000;
+	int* keys = tlmalloc(count * sizeof(int));
+	int* values = tlmalloc(count * sizeof(int));
+
+	for (int i = 0; i < count; i++) {
+		keys[i] = i % 2000;
+		values[i] = i;
+	}
+
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+	fmap_intint_add(&fm, 5, 1);
+	fmap_intint_add(&fm, 900000, 2);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_insert_n(&fm, keys, values, count));
+	TEST_ASSERT_EQUAL_size_t(2001, fm.size);
+
+	int value = 0;
+	for (int i = 0; i < 2000; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, i, &value));
+		TEST_ASSERT_EQUAL_INT((i < 1000) ? i + 2000 : i, value);
+	}
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, 900000, &value));
+	TEST_ASSERT_EQUAL_INT(2, value);
+
+	tlfree(keys);
+	tlfree(values);
+	fmap_intint_deinit(&fm);
+}
+
+void test_insert_n_parallel(void)
+{
+	const int count = 40000;
+	int* keys = generate_list(count, 0);
+	int* values = tlmalloc(count * sizeof(int));
+
+	for (int i = 0; i < count; i++) {
+		values[i] = i;
+	}
+	keys[count - 1] = keys[0];		/* the last duplicate wins */
+
+	struct fmap_intint fm;
+	struct fmap_intint check;
+	fmap_intint_init(&fm);
+	fmap_intint_init(&check);
+	for (int i = 0; i < count; i++) {
+		fmap_intint_insert(&check, keys[i], values[i]);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_insert_n(&fm, keys, values, count));
+	TEST_ASSERT_EQUAL_size_t(check.size, fm.size);
+
+	int value = 0;
+	for (int i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, keys[i], &value));
+		TEST_ASSERT_EQUAL_INT(fmap_intint_get(&check, keys[i]), value);
+	}
+	TEST_ASSERT_EQUAL_INT(count - 1, fmap_intint_get(&fm, keys[0]));
+
+	tlfree(keys);
+	tlfree(values);
+	fmap_intint_deinit(&check);
+	fmap_intint_deinit(&fm);
+}
+
+void test_init_from(void)
+{
+	int keys[] = {10, 20, 30, 40, 50};
+	int values[] = {1, 2, 3, 4, 5};
+
+	struct fmap_intint fm;
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_init_from(&fm, keys, values, 5, 0));
+
+	TEST_ASSERT_EQUAL_size_t(8, fm.num_buckets);
+	TEST_ASSERT_EQUAL_size_t(70u, fm.load_factor);
+	TEST_ASSERT_EQUAL_size_t(5, fm.size);
+	for (int i = 0; i < 5; i++) {
+		TEST_ASSERT_EQUAL_INT(values[i], fmap_intint_get(&fm, keys[i]));
+	}
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_export(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 100; i++) {
+		fmap_intint_add(&fm, i, i * 2);
+	}
+	fmap_intint_erase(&fm, 50);
+
+	int keys[100];
+	int values[100];
+	TEST_ASSERT_EQUAL_size_t(99, fmap_intint_export(&fm, keys, values));
+	for (int i = 0; i < 99; i++) {
+		TEST_ASSERT(keys[i] != 50);
+		TEST_ASSERT_EQUAL_INT(keys[i] * 2, values[i]);
+	}
+
+	int only_values[100];
+	TEST_ASSERT_EQUAL_size_t(99, fmap_intint_export(&fm, NULL, only_values));
+	for (int i = 0; i < 99; i++) {
+		TEST_ASSERT_EQUAL_INT(values[i], only_values[i]);
+	}
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_arrays_round_trip(void)
+{
+	struct array_int keys;
+	struct array_int values;
+	array_int_init(&keys);
+	array_int_init(&values);
+
+	for (int i = 0; i < 500; i++) {
+		array_int_append(&keys, i * 7);
+		array_int_append(&values, i);
+	}
+
+	struct fmap_intint fm;
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_init_from_arrays(&fm, &keys, &values, 50));
+	TEST_ASSERT_EQUAL_size_t(50u, fm.load_factor);
+	TEST_ASSERT_EQUAL_size_t(500, fm.size);
+
+	array_int_clear(&keys);
+	array_int_append(&values, -1);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_export_keys(&fm, &keys));
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_export_values(&fm, &values));
+	TEST_ASSERT_EQUAL_size_t(500, keys.size);
+	TEST_ASSERT_EQUAL_size_t(1001, values.size);
+	TEST_ASSERT_EQUAL_INT(-1, values.data[500]);
+	for (size_t i = 0; i < 500; i++) {
+		TEST_ASSERT_EQUAL_INT(keys.data[i], values.data[501 + i] * 7);
+	}
+
+	array_int_deinit(&keys);
+	array_int_deinit(&values);
+	fmap_intint_deinit(&fm);
+}
+
+
+int sum_values(int dst_value, int src_value, void* ctx)
+{
+	*(int*)ctx += 1;
+	return dst_value + src_value;
+}
+
+void test_merge_same_geometry(void)
+{
+	struct fmap_intint dst;
+	struct fmap_intint src;
+	fmap_intint_init_all(&dst, 64, 70);
+	fmap_intint_init_all(&src, 64, 70);
+
+	for (int i = 0; i < 10; i++) {
+		fmap_intint_add(&dst, i, i);
+		fmap_intint_add(&src, i + 5, 100);
+	}
+
+	int calls = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_merge(&dst, &src, &sum_values, &calls));
+
+	TEST_ASSERT_EQUAL_INT(5, calls);
+	TEST_ASSERT_EQUAL_size_t(64, dst.num_buckets);
+	TEST_ASSERT_EQUAL_size_t(15, dst.size);
+	TEST_ASSERT_EQUAL_size_t(10, src.size);
+	for (int i = 0; i < 15; i++) {
+		const int expect = (i < 5) ? i : (i < 10) ? i + 100 : 100;
+		TEST_ASSERT_EQUAL_INT(expect, fmap_intint_get(&dst, i));
+	}
+
+	fmap_intint_deinit(&dst);
+	fmap_intint_deinit(&src);
+}
+
+void test_merge_diff_geometry(void)
+{
+	struct fmap_intint dst;
+	struct fmap_intint src;
+	fmap_intint_init(&dst);
+	fmap_intint_init_all(&src, 1024, 70);
+
+	int* keys = generate_list(600, 1);
+	for (int i = 0; i < 600; i++) {
+		fmap_intint_add(&src, keys[i], i);
+	}
+	fmap_intint_add(&dst, keys[0], -5);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_merge(&dst, &src, NULL, NULL));
+
+	TEST_ASSERT_EQUAL_size_t(600, dst.size);
+	int value = 0;
+	for (int i = 0; i < 600; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&dst, keys[i], &value));
+		TEST_ASSERT_EQUAL_INT(i, value);
+	}
+
+	tlfree(keys);
+	fmap_intint_deinit(&dst);
+	fmap_intint_deinit(&src);
+}
+
+void test_intersect(void)
+{
+	struct fmap_intint dst;
+	struct fmap_intint src;
+	fmap_intint_init_all(&dst, 64, 70);
+	fmap_intint_init_all(&src, 64, 70);
+
+	for (int i = 0; i < 200; i++) {
+		fmap_intint_add(&dst, i, i);
+		if (i % 3 == 0)
+			fmap_intint_add(&src, i, 1);
+	}
+
+	int calls = 0;
+	fmap_intint_intersect(&dst, &src, &sum_values, &calls);
+
+	TEST_ASSERT_EQUAL_INT(67, calls);
+	TEST_ASSERT_EQUAL_size_t(67, dst.size);
+	int value = 0;
+	for (int i = 0; i < 200; i++) {
+		if (i % 3 == 0) {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&dst, i, &value));
+			TEST_ASSERT_EQUAL_INT(i + 1, value);
+		} else {
+			TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_try_get(&dst, i, &value));
+		}
+	}
+
+	fmap_intint_deinit(&dst);
+	fmap_intint_deinit(&src);
+}
+
+void test_intersect_diff_geometry(void)
+{
+	struct fmap_intint dst;
+	struct fmap_intint src;
+	fmap_intint_init(&dst);
+	fmap_intint_init(&src);
+
+	for (int i = 0; i < 100; i++) {
+		fmap_intint_add(&dst, i, i);
+	}
+	fmap_intint_add(&src, 7, 0);
+	fmap_intint_add(&src, 70, 0);
+	fmap_intint_add(&src, 700, 0);
+
+	fmap_intint_intersect(&dst, &src, NULL, NULL);
+
+	TEST_ASSERT_EQUAL_size_t(2, dst.size);
+	TEST_ASSERT_EQUAL_INT(7, fmap_intint_get(&dst, 7));
+	TEST_ASSERT_EQUAL_INT(70, fmap_intint_get(&dst, 70));
+
+	size_t occupied = 0;
+	for (size_t i = 0; i < dst.capacity; i++) {
+		if (dst.info[i] == TL_MAPSS_OCCUPIED || dst.info[i] == TL_MAPSS_COLLIDED) occupied++;
+	}
+	TEST_ASSERT_EQUAL_size_t(2, occupied);
+
+	fmap_intint_deinit(&dst);
+	fmap_intint_deinit(&src);
+}
+
+void test_subtract(void)
+{
+	struct fmap_intint dst;
+	struct fmap_intint big;
+	struct fmap_intint small;
+	fmap_intint_init(&dst);
+	fmap_intint_init(&big);
+	fmap_intint_init(&small);
+
+	for (int i = 0; i < 300; i++) {
+		fmap_intint_add(&dst, i, i);
+		if (i % 2 == 0)
+			fmap_intint_add(&big, i, 0);
+	}
+	fmap_intint_add(&small, 1, 0);
+	fmap_intint_add(&small, 3, 0);
+	fmap_intint_add(&small, 1000, 0);
+
+	fmap_intint_subtract(&dst, &big);
+	TEST_ASSERT_EQUAL_size_t(150, dst.size);
+
+	fmap_intint_subtract(&dst, &small);
+	TEST_ASSERT_EQUAL_size_t(148, dst.size);
+
+	int value = 0;
+	for (int i = 0; i < 300; i++) {
+		const int expect = (i % 2 == 0 || i == 1 || i == 3) ? TL_ENF : TLOK;
+		TEST_ASSERT_EQUAL_INT(expect, fmap_intint_try_get(&dst, i, &value));
+	}
+
+	fmap_intint_deinit(&dst);
+	fmap_intint_deinit(&big);
+	fmap_intint_deinit(&small);
+}
+
+
+int keep_odd_and_double(int key, int* value, void* ctx)
+{
+	(void)ctx;
+	*value *= 2;
+	return key % 2;
+}
+
+int keep_none(int key, int* value, void* ctx)
+{
+	(void)key;
+	(void)value;
+	(void)ctx;
+	return 0;
+}
+
+void test_retain(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 500; i++) {
+		fmap_intint_add(&fm, i, i);
+	}
+	fmap_intint_erase(&fm, 1);
+
+	TEST_ASSERT_EQUAL_size_t(250, fmap_intint_retain(&fm, &keep_odd_and_double, NULL));
+	TEST_ASSERT_EQUAL_size_t(249, fm.size);
+
+	int value = 0;
+	for (int i = 0; i < 500; i++) {
+		if (i % 2 && i != 1) {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_try_get(&fm, i, &value));
+			TEST_ASSERT_EQUAL_INT(i * 2, value);
+		} else {
+			TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_try_get(&fm, i, &value));
+		}
+	}
+
+	/* every bucket is compacted: pairs first, then only empty slots */
+	for (size_t bucket = 0; bucket < fm.capacity; bucket += fm.bucket_max) {
+		int seen_empty = 0;
+		for (size_t slot = bucket; slot < bucket + fm.bucket_max; slot++) {
+			TEST_ASSERT(fm.info[slot] != TL_MAPSS_DELETED);
+			if (fm.info[slot] == TL_MAPSS_EMPTY) {
+				seen_empty = 1;
+			} else {
+				TEST_ASSERT(!seen_empty);
+				TEST_ASSERT_EQUAL_INT((slot == bucket) ? TL_MAPSS_OCCUPIED : TL_MAPSS_COLLIDED, fm.info[slot]);
+			}
+		}
+	}
+
+	fmap_intint_deinit(&fm);
+}
+
+void test_retain_none(void)
+{
+	struct fmap_intint fm;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 50; i++) {
+		fmap_intint_add(&fm, i, i);
+	}
+
+	TEST_ASSERT_EQUAL_size_t(50, fmap_intint_retain(&fm, &keep_none, NULL));
+	TEST_ASSERT_EQUAL_size_t(0, fm.size);
+	for (size_t i = 0; i < fm.capacity; i++) {
+		TEST_ASSERT_EQUAL_INT(TL_MAPSS_EMPTY, fm.info[i]);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_add(&fm, 3, 4));
+	TEST_ASSERT_EQUAL_INT(4, fmap_intint_get(&fm, 3));
+
+	fmap_intint_deinit(&fm);
+}
+
+
+void test_clone(void)
+{
+	struct fmap_intint src;
+	struct fmap_intint dst;
+	fmap_intint_init(&src);
+
+	for (int i = 0; i < 300; i++) {
+		fmap_intint_add(&src, i, i + 1);
+	}
+	fmap_intint_erase(&src, 10);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_clone(&dst, &src));
+
+	TEST_ASSERT_EQUAL_size_t(src.num_buckets, dst.num_buckets);
+	TEST_ASSERT_EQUAL_size_t(src.bucket_max, dst.bucket_max);
+	TEST_ASSERT_EQUAL_size_t(src.capacity, dst.capacity);
+	TEST_ASSERT_EQUAL_size_t(src.load_max, dst.load_max);
+	TEST_ASSERT_EQUAL_size_t(src.slot_mask, dst.slot_mask);
+	TEST_ASSERT_EQUAL_size_t(src.load_factor, dst.load_factor);
+	TEST_ASSERT_EQUAL_size_t(299, dst.size);
+	TEST_ASSERT(src.nodes != dst.nodes);
+	TEST_ASSERT(src.info != dst.info);
+	for (size_t i = 0; i < src.capacity; i++) {
+		TEST_ASSERT_EQUAL_INT(src.info[i], dst.info[i]);
+	}
+
+	fmap_intint_insert(&dst, 5, -5);
+	fmap_intint_erase(&dst, 6);
+	TEST_ASSERT_EQUAL_INT(6, fmap_intint_get(&src, 5));
+	TEST_ASSERT_EQUAL_INT(7, fmap_intint_get(&src, 6));
+	TEST_ASSERT_EQUAL_INT(-5, fmap_intint_get(&dst, 5));
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_try_get(&dst, 10, &value));
+	TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_try_get(&dst, 6, &value));
+
+	fmap_intint_deinit(&src);
+	fmap_intint_deinit(&dst);
+}
+
+void test_clone_deep_copy(void)
+{
+	struct fmap_deep src;
+	struct fmap_deep dst;
+	fmap_deep_init(&src);
+
+	for (int i = 0; i < 20; i++) {
+		fmap_deep_add(&src, i, i);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_deep_clone(&dst, &src));
+	TEST_ASSERT_EQUAL_size_t(20, dst.size);
+	for (int i = 0; i < 20; i++) {
+		TEST_ASSERT_EQUAL_INT(i, fmap_deep_get(&src, i));
+		TEST_ASSERT_EQUAL_INT(i + 1000, fmap_deep_get(&dst, i));
+	}
+
+	fmap_deep_deinit(&src);
+	fmap_deep_deinit(&dst);
+}
+
+void test_freeze(void)
+{
+	struct fmap_intint fm;
+	struct fmap_intint_frozen frozen;
+	fmap_intint_init(&fm);
+
+	srand(7);
+	for (int i = 0; i < 5000; i++) {
+		fmap_intint_insert(&fm, rand(), i);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_freeze(&fm, &frozen));
+	TEST_ASSERT_EQUAL_size_t(fm.size, frozen.size);
+
+	int value = 0;
+	for (size_t i = 0; i < fm.capacity; i++) {
+		if (fm.info[i] == TL_MAPSS_OCCUPIED || fm.info[i] == TL_MAPSS_COLLIDED) {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_frozen_try_get(&frozen, fm.nodes[i].key, &value));
+			TEST_ASSERT_EQUAL_INT(fm.nodes[i].value, value);
+			TEST_ASSERT_EQUAL_INT(fm.nodes[i].value, fmap_intint_frozen_get(&frozen, fm.nodes[i].key));
+		}
+	}
+
+	for (int key = -1; key > -100; key--) {
+		TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_frozen_try_get(&frozen, key, &value));
+	}
+
+	fmap_intint_frozen_deinit(&frozen);
+	fmap_intint_deinit(&fm);
+}
+
+void test_freeze_empty(void)
+{
+	struct fmap_intint fm;
+	struct fmap_intint_frozen frozen;
+	fmap_intint_init(&fm);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_freeze(&fm, &frozen));
+	TEST_ASSERT_EQUAL_size_t(0, frozen.size);
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_frozen_try_get(&frozen, 0, &value));
+
+	fmap_intint_frozen_deinit(&frozen);
+	fmap_intint_deinit(&fm);
+}
+
+void test_freeze_equal_hashes(void)
+{
+	struct fmap_lowbyte fm;
+	struct fmap_lowbyte_frozen frozen;
+	fmap_lowbyte_init(&fm);
+
+	/* 0x105 and 0x205 both hash to 0x05, no seed can tell them apart */
+	for (int i = 0; i < 64; i++) {
+		fmap_lowbyte_insert(&fm, i, i);
+	}
+	fmap_lowbyte_insert(&fm, 0x105, 1);
+	fmap_lowbyte_insert(&fm, 0x205, 2);
+
+	TEST_ASSERT_EQUAL_INT(TL_EAE, fmap_lowbyte_freeze(&fm, &frozen));
+
+	fmap_lowbyte_deinit(&fm);
+}
+
+void test_freeze_seeds_exhausted(void)
+{
+	struct fmap_nodisp fm;
+	struct fmap_nodisp_frozen frozen;
+	fmap_nodisp_init(&fm);
+
+	/* a single displacement per bucket cannot place 1000 keys, so every seed fails */
+	for (int i = 0; i < 1000; i++) {
+		fmap_nodisp_insert(&fm, i, i);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TL_ERROR, fmap_nodisp_freeze(&fm, &frozen));
+
+	fmap_nodisp_deinit(&fm);
+}
+
+void test_freeze_after_erase(void)
+{
+	struct fmap_intint fm;
+	struct fmap_intint_frozen frozen;
+	fmap_intint_init(&fm);
+
+	for (int i = 0; i < 100; i++) {
+		fmap_intint_insert(&fm, i, i * 2);
+	}
+	for (int i = 0; i < 100; i += 3) {
+		fmap_intint_erase(&fm, i);
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_freeze(&fm, &frozen));
+	fmap_intint_deinit(&fm);
+
+	int value = 0;
+	for (int i = 0; i < 100; i++) {
+		if (i % 3 == 0) {
+			TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intint_frozen_try_get(&frozen, i, &value));
+		} else {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_frozen_try_get(&frozen, i, &value));
+			TEST_ASSERT_EQUAL_INT(i * 2, value);
+		}
+	}
+
+	fmap_intint_frozen_deinit(&frozen);
+}
+
+
+void test_int_key_high_bits(void)
+{
+	/* sequential keys and keys sharing their low bits must both grow with the load, not with overflowing buckets */
+	const int strides[] = {1, 1 << 8, 1 << 14};
+
+	for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+		struct fmap_intkey fm;
+		struct fmap_intkey reserved;
+		const int count = 100000 / (int)(s + 1);
+
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_init(&fm));
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_init(&reserved));
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_reserve(&reserved, (size_t)count));
+
+		for (int i = 0; i < count; i++) {
+			TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_insert(&fm, i * strides[s], i));
+		}
+		for (int i = 0; i < count; i++) {
+			TEST_ASSERT_EQUAL_INT(i, fmap_intkey_get(&fm, i * strides[s]));
+		}
+		TEST_ASSERT_LESS_OR_EQUAL_size_t(2 * reserved.num_buckets, fm.num_buckets);
+
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_erase(&fm, strides[s]));
+		TEST_ASSERT_EQUAL_INT(TL_ENF, fmap_intkey_erase(&fm, strides[s]));
+		TEST_ASSERT_EQUAL_size_t(count - 1, fm.size);
+
+		fmap_intkey_deinit(&reserved);
+		fmap_intkey_deinit(&fm);
+	}
+}
+
+void test_hash_quality(void)
+{
+	struct fmap_intkey fm;
+	struct tlhash_quality q;
+	const int count = 20000;
+	int* keys = tlmalloc(count * sizeof(int));
+	for (int i = 0; i < count; i++) {
+		keys[i] = i << 14;
+	}
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_init(&fm));
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_hash_quality(&fm, keys, (size_t)count, &q));
+	TEST_ASSERT_EQUAL_size_t((size_t)count, q.count);
+	TEST_ASSERT(q.max_fill <= q.bucket_max);
+	TEST_ASSERT_EQUAL_size_t(0, q.oob_grows);
+	TEST_ASSERT_EQUAL_size_t(q.num_buckets, q.recommended_buckets);
+
+	/* the recommendation holds the sample without growing */
+	struct fmap_intkey sized;
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_init_all(&sized, q.recommended_buckets, q.recommended_load_factor));
+	const size_t buckets = sized.num_buckets;
+	for (int i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intkey_insert(&sized, keys[i], i));
+	}
+	TEST_ASSERT_EQUAL_size_t(buckets, sized.num_buckets);
+
+	fmap_intkey_deinit(&sized);
+	fmap_intkey_deinit(&fm);
+	tlfree(keys);
+}
+void test_seeded_hash(void)
+{
+	struct fmap_intint plain;
+	struct fmap_seeded seeded;
+	struct fmap_seeded other;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_init_all(&plain, 1024, 0));
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_seeded_init_all(&seeded, 1024, 0));
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_seeded_init(&other));
+	TEST_ASSERT(memcmp(seeded.hash_seed, other.hash_seed, sizeof(seeded.hash_seed)) != 0);
+
+	/* keys crafted to share a bucket of the unseeded hash force it to grow, but not a seeded map */
+	int key = 0;
+	for (int i = 0; i < 300; i++) {
+		key = find_key_in_bucket(7, 1023, key + 1);
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_insert(&plain, key, i));
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_seeded_insert(&seeded, key, i));
+		TEST_ASSERT_EQUAL_INT(TLOK, fmap_seeded_insert(&other, key * 3, i));
+	}
+	TEST_ASSERT_EQUAL_size_t(1024, seeded.num_buckets);
+	TEST_ASSERT(plain.num_buckets >= 4 * seeded.num_buckets);
+
+	/* differently seeded maps must not reuse each other's buckets */
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_seeded_merge(&other, &seeded, NULL, NULL));
+	TEST_ASSERT_EQUAL_size_t(600, other.size);
+	key = 0;
+	for (int i = 0; i < 300; i++) {
+		key = find_key_in_bucket(7, 1023, key + 1);
+		TEST_ASSERT_EQUAL_INT(i, fmap_seeded_get(&other, key));
+		TEST_ASSERT_EQUAL_INT(i, fmap_seeded_get(&other, key * 3));
+	}
+
+	struct fmap_seeded_frozen frozen;
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_seeded_freeze(&other, &frozen));
+	TEST_ASSERT_EQUAL_INT(299, fmap_seeded_frozen_get(&frozen, key));
+	fmap_seeded_frozen_deinit(&frozen);
+
+	fmap_seeded_deinit(&other);
+	fmap_seeded_deinit(&seeded);
+	fmap_intint_deinit(&plain);
+}
 
 int main(void)
 {
@@ -2144,7 +2908,32 @@ int main(void)
 	RUN_TEST(test_remove_last_in_last_bucket);
 	RUN_TEST(test_remove_only_hits_requested_node);
 	RUN_TEST(test_remove_all);
-
+	RUN_TEST(test_erase_insert_reuses_slots);
+
+	RUN_TEST(test_reserve);
+	RUN_TEST(test_reserve_keeps_elements);
+	RUN_TEST(test_insert_n);
+	RUN_TEST(test_insert_n_parallel);
+	RUN_TEST(test_init_from);
+	RUN_TEST(test_export);
+	RUN_TEST(test_arrays_round_trip);
+	RUN_TEST(test_merge_same_geometry);
+	RUN_TEST(test_merge_diff_geometry);
+	RUN_TEST(test_intersect);
+	RUN_TEST(test_intersect_diff_geometry);
+	RUN_TEST(test_subtract);
+	RUN_TEST(test_retain);
+	RUN_TEST(test_retain_none);
+	RUN_TEST(test_clone);
+	RUN_TEST(test_clone_deep_copy);
+	RUN_TEST(test_freeze);
+	RUN_TEST(test_freeze_empty);
+	RUN_TEST(test_freeze_after_erase);
+	RUN_TEST(test_freeze_equal_hashes);
+	RUN_TEST(test_freeze_seeds_exhausted);
+	RUN_TEST(test_int_key_high_bits);
+	RUN_TEST(test_hash_quality);
+	RUN_TEST(test_seeded_hash);
 
 	return UNITY_END();
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #include <unity.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "private/common.h"
 
 #define _PFX fmap_test
 #define TL_K int
 #include "private/hash_algorithm.h"
+#include "private/hash_quality.h"
 
 
 void setUp(void)
@@ -29,6 +35,115 @@ void test_typed_fnv1a(void)
 	TEST_ASSERT(0x50d090ef4acbcc21u == val);
 }
 
+void test_ntwy_matches_wy(void)
+{
+	const char text[] = "the quick brown fox jumps over the lazy dog, then does it all again";
+
+	/* every length and start alignment, so each tail and page check path is taken */
+	for (size_t start = 0; start < 8; start++) {
+		for (size_t len = 0; start + len < sizeof(text); len++) {
+			char buffer[sizeof(text)];
+			memcpy(buffer, text + start, len);
+			buffer[len] = 0;
+			TEST_ASSERT_EQUAL_size_t(tlhash_wy(buffer, len), tlhash_ntwy(buffer));
+		}
+	}
+
+	TEST_ASSERT_NOT_EQUAL_size_t(tlhash_ntwy("a"), tlhash_ntwy(""));
+	TEST_ASSERT_NOT_EQUAL_size_t(tlhash_ntwy("abcdefgh"), tlhash_ntwy("abcdefg"));
+}
+
+void test_ntwy_page_end(void)
+{
+	/* a string ending right at the end of a page must not be read past, the page after it faults on any access */
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	char* pages = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	TEST_ASSERT(pages != MAP_FAILED);
+	TEST_ASSERT_EQUAL_INT(0, mprotect(pages + page, page, PROT_NONE));
+
+	for (size_t len = 0; len < 24; len++) {
+		char* str = pages + page - 1 - len;
+		memset(str, 'x', len);
+		str[len] = 0;
+		TEST_ASSERT_EQUAL_size_t(tlhash_wy(str, len), tlhash_ntwy(str));
+	}
+	munmap(pages, 2 * page);
+}
+
+void test_typed_wyhash(void)
+{
+	int key = 1952805748;
+	TEST_ASSERT_EQUAL_size_t(tlhash_wy(&key, sizeof(key)), fmap_test_wyhash(key));
+
+	/* consecutive integers must not collide in the low bits used for bucket selection */
+	static unsigned char seen[1u << 16];
+	size_t collisions = 0;
+	for (int i = 0; i < (1 << 14); i++) {
+		const size_t slot = fmap_test_wyhash(i) & ((1u << 16) - 1u);
+		collisions += seen[slot];
+		seen[slot] = 1;
+	}
+	TEST_ASSERT(collisions < 2500);
+}
+
+void test_high_bits(void)
+{
+	TEST_ASSERT_EQUAL_size_t(0, tlhash_high_bits(SIZE_MAX, 1));
+	TEST_ASSERT_EQUAL_size_t(1, tlhash_high_bits(SIZE_MAX / 2u + 1u, 2));
+	TEST_ASSERT_EQUAL_size_t(0, tlhash_high_bits(SIZE_MAX / 2u, 2));
+	TEST_ASSERT_EQUAL_size_t(1023, tlhash_high_bits(SIZE_MAX, 1024));
+	TEST_ASSERT_EQUAL_size_t(SIZE_MAX >> (sizeof(size_t) * 8u - 10u), tlhash_high_bits(SIZE_MAX, 1024));
+}
+
+void test_sip13(void)
+{
+	uint64_t seed[2] = {0, 0};
+	uint64_t other[2];
+	tlhash_seed(seed, &seed);
+	tlhash_seed(other, &seed);
+	TEST_ASSERT(seed[0] != other[0] || seed[1] != other[1]);
+
+	TEST_ASSERT_EQUAL_size_t(tlhash_sip13("hello world", 11, seed), tlhash_ntsip13("hello world", seed));
+	TEST_ASSERT_NOT_EQUAL_size_t(tlhash_sip13("hello world", 11, seed), tlhash_sip13("hello world", 11, other));
+	TEST_ASSERT_NOT_EQUAL_size_t(tlhash_sip13("hello world", 11, seed), tlhash_sip13("hello world", 10, seed));
+
+	int key = 1952805748;
+	TEST_ASSERT_EQUAL_size_t(tlhash_sip13(&key, sizeof(key), seed), fmap_test_siphash(key, seed));
+}
+
+void test_fnv1a_many(void)
+{
+	const unsigned limits[] = {0, TL_CPU_SSE2 | TL_CPU_SSE42 | TL_CPU_AVX2, ~0u};
+	unsigned char keys[37 * 16];
+	size_t hashes[37];
+
+	for (size_t i = 0; i < sizeof(keys); i++) {
+		keys[i] = (unsigned char)(i * 131u + 7u);
+	}
+
+	for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++) {
+		tl_cpu_limit(limits[l]);
+		for (size_t key_size = 1; key_size <= 16; key_size++) {
+			for (size_t count = 0; count <= 37; count += 3) {
+				tlhash_fnv1a_many(keys, key_size, count, hashes);
+				for (size_t i = 0; i < count; i++) {
+					size_t expect = (sizeof(size_t) == 8) ? 0xcbf29ce484222325u : 0x811c9dc5u;
+					for (size_t b = 0; b < key_size; b++) {
+						expect = (keys[(i * key_size) + b] ^ expect) * ((sizeof(size_t) == 8) ? 0x100000001b3u : 0x01000193u);
+					}
+					TEST_ASSERT_EQUAL_size_t(expect, hashes[i]);
+				}
+			}
+		}
+	}
+	tl_cpu_limit(~0u);
+
+	const int ints[9] = {1952805748, 1, 2, 3, 4, 5, 6, 7, 8};
+	fmap_test_fnv1a_many(ints, 9, hashes);
+	TEST_ASSERT(0x50d090ef4acbcc21u == hashes[0]);
+	TEST_ASSERT_EQUAL_size_t(fmap_test_fnv1a(8), hashes[8]);
+}
+
 
 struct point
 {
@@ -52,13 +167,154 @@ void test_struct_fnv1a(void)
 }
 
 
+#undef _PFX
+#undef TL_K
+#define _PFX fmap_test_int
+#define TL_K unsigned
+#define TL_KEY_IS_INT
+
+#include "private/hash_algorithm.h"
+
+void test_int_hashes(void)
+{
+	TEST_ASSERT_EQUAL_size_t(tlhash_mix(12345u), fmap_test_int_murmurhash(12345u));
+	TEST_ASSERT_EQUAL_size_t(0, fmap_test_int_fibhash(0));
+
+	/* the high bits of consecutive keys spread evenly over the buckets */
+	static unsigned char seen[1u << 12];
+	size_t collisions = 0;
+	for (unsigned i = 0; i < (1u << 12); i++) {
+		const size_t bucket = tlhash_high_bits(fmap_test_int_fibhash(i), 1u << 12);
+		collisions += seen[bucket];
+		seen[bucket] = 1;
+	}
+	TEST_ASSERT(collisions < (1u << 12) / 4u);
+}
+
+static size_t
+identity_hash(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return (size_t)*(const unsigned*)key;
+}
+
+static size_t
+mixed_hash(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return tlhash_mix((size_t)*(const unsigned*)key + 1u);
+}
+
+static size_t
+grouped_hash(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return tlhash_mix((size_t)(*(const unsigned*)key / 64u) + 1u);
+}
+
+static size_t
+string_hash(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return tlhash_ntwy(key);
+}
+
+void test_hash_quality(void)
+{
+	struct tlhash_quality q;
+	const size_t count = 10000;
+	unsigned* keys = malloc(count * sizeof(unsigned));
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = (unsigned)(i << 12u);
+	}
+
+	/* keys sharing their low bits all land in the first bucket of an identity hash */
+	TEST_ASSERT_EQUAL_INT(TLOK, tlhash_quality(&identity_hash, NULL, keys, sizeof(unsigned), count, 0, 0, &q));
+	TEST_ASSERT_EQUAL_size_t(count, q.max_fill);
+	TEST_ASSERT_EQUAL_size_t(1, q.overflow_buckets);
+	TEST_ASSERT(q.oob_grows > 0);
+	TEST_ASSERT_EQUAL_size_t(q.num_buckets << q.oob_grows, q.recommended_buckets);
+	TEST_ASSERT(q.worst_bit_bias == 0.5);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, tlhash_quality(&mixed_hash, NULL, keys, sizeof(unsigned), count, 0, 0, &q));
+	TEST_ASSERT(q.max_fill < 2 * q.bucket_max);
+	TEST_ASSERT(q.chi_squared > 0.5 && q.chi_squared < 1.5);
+	TEST_ASSERT(q.worst_bit_bias < 0.05);
+	TEST_ASSERT(q.avalanche_mean < 0.05);
+	TEST_ASSERT_EQUAL_size_t(q.num_buckets << q.oob_grows, q.recommended_buckets);
+	TEST_ASSERT(q.recommended_load_factor >= 1 && q.recommended_load_factor <= 70);
+
+	/* NUL terminated keys */
+	char** strs = malloc(count * sizeof(char*));
+	for (size_t i = 0; i < count; i++) {
+		strs[i] = malloc(16);
+		sprintf(strs[i], "key-%u", (unsigned)i);
+	}
+	TEST_ASSERT_EQUAL_INT(TLOK, tlhash_quality(&string_hash, NULL, strs, 0, count, 70, 0, &q));
+	TEST_ASSERT_EQUAL_size_t(count, q.count);
+	TEST_ASSERT(q.chi_squared > 0.5 && q.chi_squared < 1.5);
+	TEST_ASSERT(q.avalanche_mean < 0.05);
+
+	for (size_t i = 0; i < count; i++) {
+		free(strs[i]);
+	}
+	free(strs);
+	free(keys);
+}
+
+void test_hash_quality_duplicates(void)
+{
+	struct tlhash_quality q;
+	const size_t count = 2000;
+	const size_t dups = 100;
+	unsigned* keys = malloc((count + dups) * sizeof(unsigned));
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = (unsigned)i;
+	}
+	for (size_t i = 0; i < dups; i++) {
+		keys[count + i] = 7u;
+	}
+
+	/* repeated keys are dropped before fitting instead of growing the map forever */
+	TEST_ASSERT_EQUAL_INT(TLOK, tlhash_quality(&mixed_hash, NULL, keys, sizeof(unsigned), count + dups, 0, 0, &q));
+	TEST_ASSERT_EQUAL_size_t(count, q.count);
+	TEST_ASSERT_EQUAL_size_t(dups, q.duplicate_keys);
+	TEST_ASSERT_EQUAL_size_t(0, q.inseparable_keys);
+	TEST_ASSERT(q.oob_grows < 4);
+	TEST_ASSERT_EQUAL_size_t(q.num_buckets << q.oob_grows, q.recommended_buckets);
+
+	/* 64 distinct keys per full hash cannot be separated, the fit gives up after the last doubling */
+	TEST_ASSERT_EQUAL_INT(TLOK, tlhash_quality(&grouped_hash, NULL, keys, sizeof(unsigned), count + dups, 0, 1, &q));
+	TEST_ASSERT_EQUAL_size_t(count, q.count);
+	TEST_ASSERT_EQUAL_size_t(dups, q.duplicate_keys);
+	TEST_ASSERT_EQUAL_size_t(count, q.inseparable_keys);
+	TEST_ASSERT_EQUAL_size_t(TLHASH_QUALITY_MAX_GROWS, q.oob_grows);
+	TEST_ASSERT_EQUAL_size_t(0, q.recommended_buckets);
+	TEST_ASSERT_EQUAL_size_t(0, q.recommended_load_factor);
+
+	free(keys);
+}
+
 int main(void)
 {
 	UNITY_BEGIN();
 
 	RUN_TEST(test_null_term_fnv1a);
 	RUN_TEST(test_typed_fnv1a);
+	RUN_TEST(test_ntwy_matches_wy);
+	RUN_TEST(test_ntwy_page_end);
+	RUN_TEST(test_typed_wyhash);
+	RUN_TEST(test_high_bits);
+	RUN_TEST(test_sip13);
+	RUN_TEST(test_fnv1a_many);
+	RUN_TEST(test_int_hashes);
 	RUN_TEST(test_struct_fnv1a);
+	RUN_TEST(test_hash_quality);
+	RUN_TEST(test_hash_quality_duplicates);
 
 	return UNITY_END();
 }
\ No newline at end of file
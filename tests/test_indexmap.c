@@ -0,0 +1,201 @@
+#include <unity.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define TL_K int
+#define TL_V int
+#include "indexmap.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_KEY_IS_NT
+#define imap_key_equalsfn(left, right) (strcmp((left), (right)) == 0)
+#define TL_K char*
+#define TL_V int
+#define TL_NAME str
+#include "indexmap.h"
+
+/* the host's TL_NAME must not leak into a later array instantiation */
+#define TL_T int
+#include "array.h"
+
+
+void setUp(void)
+{}
+
+void tearDown(void)
+{}
+
+
+void test_init(void)
+{
+	struct imap_intint im;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_init(&im));
+	TEST_ASSERT_EQUAL_size_t(0, im.entries.size);
+	TEST_ASSERT_EQUAL_size_t(8, im.num_buckets);
+	TEST_ASSERT_EQUAL_size_t(24, im.capacity);
+
+	imap_intint_deinit(&im);
+	TEST_ASSERT_NULL(im.index);
+}
+
+void test_insertion_order(void)
+{
+	struct imap_intint im;
+	imap_intint_init(&im);
+
+	for (int i = 0; i < 1000; i++) {
+		TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_insert(&im, (i * 7919) % 1000, i));
+	}
+
+	TEST_ASSERT_EQUAL_size_t(1000, im.entries.size);
+	for (int i = 0; i < 1000; i++) {
+		TEST_ASSERT_EQUAL_INT((i * 7919) % 1000, im.entries.data[i].key);
+		TEST_ASSERT_EQUAL_INT(i, im.entries.data[i].value);
+		TEST_ASSERT_EQUAL_INT(i, imap_intint_get(&im, (i * 7919) % 1000));
+	}
+
+	imap_intint_deinit(&im);
+}
+
+void test_insert_replace_keeps_position(void)
+{
+	struct imap_intint im;
+	imap_intint_init(&im);
+
+	imap_intint_insert(&im, 1, 10);
+	imap_intint_insert(&im, 2, 20);
+	imap_intint_insert(&im, 3, 30);
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_insert(&im, 1, 11));
+	TEST_ASSERT_EQUAL_INT(TL_EAE, imap_intint_add(&im, 2, 21));
+
+	TEST_ASSERT_EQUAL_size_t(3, im.entries.size);
+	TEST_ASSERT_EQUAL_INT(1, im.entries.data[0].key);
+	TEST_ASSERT_EQUAL_INT(11, im.entries.data[0].value);
+	TEST_ASSERT_EQUAL_INT(20, imap_intint_get(&im, 2));
+
+	size_t at = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_index_of(&im, 3, &at));
+	TEST_ASSERT_EQUAL_size_t(2, at);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, imap_intint_index_of(&im, 4, &at));
+
+	imap_intint_deinit(&im);
+}
+
+void test_swap_remove(void)
+{
+	struct imap_intint im;
+	imap_intint_init(&im);
+
+	for (int i = 0; i < 5; i++) {
+		imap_intint_insert(&im, i, i * 10);
+	}
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_swap_remove(&im, 1, &value));
+	TEST_ASSERT_EQUAL_INT(10, value);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, imap_intint_swap_remove(&im, 1, NULL));
+	TEST_ASSERT_EQUAL_size_t(4, im.entries.size);
+	TEST_ASSERT_EQUAL_INT(4, im.entries.data[1].key);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_swap_remove(&im, 4, NULL));
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_swap_remove(&im, 3, NULL));
+	TEST_ASSERT_EQUAL_size_t(2, im.entries.size);
+
+	TEST_ASSERT_EQUAL_INT(TL_ENF, imap_intint_try_get(&im, 4, &value));
+	TEST_ASSERT_EQUAL_INT(0, imap_intint_get(&im, 0));
+	TEST_ASSERT_EQUAL_INT(20, imap_intint_get(&im, 2));
+
+	imap_intint_deinit(&im);
+}
+
+void test_shift_remove(void)
+{
+	struct imap_intint im;
+	imap_intint_init(&im);
+
+	for (int i = 0; i < 100; i++) {
+		imap_intint_insert(&im, i, i);
+	}
+	for (int i = 0; i < 100; i += 2) {
+		TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_shift_remove(&im, i, NULL));
+	}
+
+	TEST_ASSERT_EQUAL_size_t(50, im.entries.size);
+	for (int i = 0; i < 50; i++) {
+		size_t at = 0;
+		TEST_ASSERT_EQUAL_INT(i * 2 + 1, im.entries.data[i].key);
+		TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_index_of(&im, i * 2 + 1, &at));
+		TEST_ASSERT_EQUAL_size_t((size_t)i, at);
+	}
+
+	imap_intint_deinit(&im);
+}
+
+void test_reserve_and_clear(void)
+{
+	struct imap_intint im;
+	imap_intint_init(&im);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, imap_intint_reserve(&im, 5000));
+	TEST_ASSERT(im.load_max >= 5000);
+	TEST_ASSERT(im.entries.capacity >= 5000);
+
+	for (int i = 0; i < 5000; i++) {
+		imap_intint_add(&im, i, i);
+	}
+	imap_intint_clear(&im);
+	TEST_ASSERT_EQUAL_size_t(0, im.entries.size);
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TL_ENF, imap_intint_try_get(&im, 10, &value));
+	imap_intint_insert(&im, 10, 1);
+	TEST_ASSERT_EQUAL_INT(1, imap_intint_get(&im, 10));
+
+	imap_intint_deinit(&im);
+}
+
+void test_string_keys(void)
+{
+	struct imap_str* im = imap_str_new();
+	char first[] = "first";
+	char second[] = "second";
+	char lookup[] = "second";
+
+	TEST_ASSERT_NOT_NULL(im);
+	imap_str_insert(im, first, 1);
+	imap_str_insert(im, second, 2);
+	TEST_ASSERT_EQUAL_INT(2, imap_str_get(im, lookup));
+	TEST_ASSERT_EQUAL_STRING("first", im->entries.data[0].key);
+
+	imap_str_delete(&im);
+	TEST_ASSERT_NULL(im);
+}
+
+void test_array_after_indexmap(void)
+{
+	struct array_int array;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, array_int_init(&array));
+	array_int_append(&array, 3);
+	TEST_ASSERT_EQUAL_INT(3, array_int_get(&array, 0));
+	array_int_deinit(&array);
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_init);
+	RUN_TEST(test_insertion_order);
+	RUN_TEST(test_insert_replace_keeps_position);
+	RUN_TEST(test_swap_remove);
+	RUN_TEST(test_shift_remove);
+	RUN_TEST(test_reserve_and_clear);
+	RUN_TEST(test_string_keys);
+	RUN_TEST(test_array_after_indexmap);
+
+	return UNITY_END();
+}
@@ -0,0 +1,189 @@
+#include <unity.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define TL_K int
+#define TL_V int
+#include "lrucache.h"
+
+/* every key lands in the same index slot, exercising probing and backward shifts */
+#define lru_hashfn(key) ((size_t)((key) & 1))
+#define TL_K int
+#define TL_V int
+#define TL_NAME clash
+#include "lrucache.h"
+
+
+static int evicted_keys[64];
+static int evicted_values[64];
+static size_t evicted = 0;
+
+static void
+on_evict(int key, int value, void* ctx)
+{
+	(void)ctx;
+	if (evicted < 64) {
+		evicted_keys[evicted] = key;
+		evicted_values[evicted] = value;
+	}
+	evicted++;
+}
+
+void setUp(void)
+{
+	evicted = 0;
+}
+
+void tearDown(void)
+{}
+
+
+void test_init(void)
+{
+	struct lru_intint lru;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, lru_intint_init(&lru, 10, NULL, NULL));
+	TEST_ASSERT_EQUAL_size_t(0, lru.size);
+	TEST_ASSERT_EQUAL_size_t(10, lru.capacity);
+	TEST_ASSERT_EQUAL_size_t(31, lru.index_mask);
+
+	lru_intint_deinit(&lru);
+	TEST_ASSERT_NULL(lru.entries);
+}
+
+void test_put_get(void)
+{
+	struct lru_intint lru;
+	lru_intint_init(&lru, 4, on_evict, NULL);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, lru_intint_put(&lru, 1, 10));
+	TEST_ASSERT_EQUAL_INT(TLOK, lru_intint_put(&lru, 2, 20));
+	TEST_ASSERT_EQUAL_INT(TL_EAE, lru_intint_put(&lru, 1, 11));
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, lru_intint_try_get(&lru, 1, &value));
+	TEST_ASSERT_EQUAL_INT(11, value);
+	TEST_ASSERT_EQUAL_INT(20, lru_intint_get(&lru, 2));
+	TEST_ASSERT_EQUAL_INT(TL_ENF, lru_intint_try_get(&lru, 3, &value));
+	TEST_ASSERT_EQUAL_size_t(2, lru.size);
+	TEST_ASSERT_EQUAL_size_t(0, evicted);
+
+	lru_intint_deinit(&lru);
+}
+
+void test_evicts_least_recent(void)
+{
+	struct lru_intint lru;
+	lru_intint_init(&lru, 3, on_evict, NULL);
+
+	lru_intint_put(&lru, 1, 10);
+	lru_intint_put(&lru, 2, 20);
+	lru_intint_put(&lru, 3, 30);
+	lru_intint_get(&lru, 1);        /* 2 is now the oldest */
+	lru_intint_put(&lru, 4, 40);
+
+	TEST_ASSERT_EQUAL_size_t(1, evicted);
+	TEST_ASSERT_EQUAL_INT(2, evicted_keys[0]);
+	TEST_ASSERT_EQUAL_INT(20, evicted_values[0]);
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TL_ENF, lru_intint_peek(&lru, 2, &value));
+	TEST_ASSERT_EQUAL_INT(TLOK, lru_intint_peek(&lru, 3, &value));   /* peek does not promote */
+	lru_intint_put(&lru, 5, 50);
+	TEST_ASSERT_EQUAL_INT(3, evicted_keys[1]);
+
+	/* iteration from most to least recent */
+	int expected[] = {5, 4, 1};
+	size_t i = 0;
+	for (uint32_t at = lru.head; at != UINT32_MAX; at = lru.entries[at].next) {
+		TEST_ASSERT_EQUAL_INT(expected[i++], lru.entries[at].key);
+	}
+	TEST_ASSERT_EQUAL_size_t(3, i);
+
+	lru_intint_deinit(&lru);
+}
+
+void test_remove_and_reuse(void)
+{
+	struct lru_intint lru;
+	lru_intint_init(&lru, 2, on_evict, NULL);
+
+	lru_intint_put(&lru, 1, 10);
+	lru_intint_put(&lru, 2, 20);
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, lru_intint_remove(&lru, 1, &value));
+	TEST_ASSERT_EQUAL_INT(10, value);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, lru_intint_remove(&lru, 1, NULL));
+
+	lru_intint_put(&lru, 3, 30);
+	TEST_ASSERT_EQUAL_size_t(0, evicted);
+	TEST_ASSERT_EQUAL_size_t(2, lru.size);
+	TEST_ASSERT_EQUAL_INT(2, (int)lru.used);
+
+	lru_intint_clear(&lru);
+	TEST_ASSERT_EQUAL_size_t(0, lru.size);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, lru_intint_try_get(&lru, 2, &value));
+	lru_intint_put(&lru, 2, 21);
+	TEST_ASSERT_EQUAL_INT(21, lru_intint_get(&lru, 2));
+
+	lru_intint_deinit(&lru);
+}
+
+void test_clashing_hashes(void)
+{
+	struct lru_clash* lru = lru_clash_new(8, on_evict, NULL);
+	TEST_ASSERT_NOT_NULL(lru);
+
+	for (int round = 0; round < 50; round++) {
+		for (int i = 0; i < 12; i++) {
+			lru_clash_put(lru, round * 100 + i, i);
+		}
+		lru_clash_remove(lru, round * 100 + 5, NULL);
+		lru_clash_remove(lru, round * 100 + 8, NULL);
+
+		int value = 0;
+		for (int i = 0; i < 12; i++) {
+			const enum tl_status expect = (i < 4 || i == 5 || i == 8) ? TL_ENF : TLOK;
+			TEST_ASSERT_EQUAL_INT(expect, lru_clash_peek(lru, round * 100 + i, &value));
+		}
+	}
+
+	lru_clash_delete(&lru);
+	TEST_ASSERT_NULL(lru);
+}
+
+void test_steady_state(void)
+{
+	struct lru_intint lru;
+	lru_intint_init(&lru, 64, NULL, NULL);
+
+	for (int i = 0; i < 100000; i++) {
+		lru_intint_put(&lru, i % 1000, i);
+	}
+	TEST_ASSERT_EQUAL_size_t(64, lru.size);
+
+	int value = 0;
+	for (int i = 0; i < 1000; i++) {
+		const int hit = (i >= 1000 - 64);
+		TEST_ASSERT_EQUAL_INT(hit ? TLOK : TL_ENF, lru_intint_peek(&lru, i, &value));
+	}
+
+	lru_intint_deinit(&lru);
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_init);
+	RUN_TEST(test_put_get);
+	RUN_TEST(test_evicts_least_recent);
+	RUN_TEST(test_remove_and_reuse);
+	RUN_TEST(test_clashing_hashes);
+	RUN_TEST(test_steady_state);
+
+	return UNITY_END();
+}
@@ -0,0 +1,74 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "phash_keyword.h"
+#include "phash_field.h"
+
+
+void setUp(void)
+{}
+
+void tearDown(void)
+{}
+
+
+static const char* keywords[] = {"GET", "POST", "PUT", "DELETE", "HEAD", "OPTIONS", "PATCH", "TRACE", "CONNECT"};
+
+void test_count(void)
+{
+	TEST_ASSERT_EQUAL_size_t(9, PHASH_KEYWORD_COUNT);
+	TEST_ASSERT_EQUAL_size_t(12, PHASH_FIELD_COUNT);
+}
+
+void test_all_keys_found(void)
+{
+	unsigned char seen[PHASH_KEYWORD_COUNT] = {0};
+
+	for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+		const size_t slot = phash_keyword_find(keywords[i]);
+		TEST_ASSERT(slot < PHASH_KEYWORD_COUNT);
+		TEST_ASSERT_EQUAL_STRING(keywords[i], phash_keyword_keys[slot]);
+		TEST_ASSERT_EQUAL_INT(0, seen[slot]);
+		seen[slot] = 1;
+	}
+}
+
+void test_misses(void)
+{
+	TEST_ASSERT_EQUAL_size_t(PHASH_KEYWORD_COUNT, phash_keyword_find("get"));
+	TEST_ASSERT_EQUAL_size_t(PHASH_KEYWORD_COUNT, phash_keyword_find(""));
+	TEST_ASSERT_EQUAL_size_t(PHASH_KEYWORD_COUNT, phash_keyword_find("GETS"));
+	TEST_ASSERT_EQUAL_size_t(PHASH_KEYWORD_COUNT, phash_keyword_index("GETS", 2));
+	TEST_ASSERT_EQUAL_INT(1, phash_keyword_contains("GETS", 3));
+	TEST_ASSERT_EQUAL_INT(0, phash_keyword_contains("POS", 3));
+}
+
+void test_values(void)
+{
+	int value = 0;
+
+	TEST_ASSERT_EQUAL_INT(1, phash_field_try_get("host", 4, &value));
+	TEST_ASSERT_EQUAL_INT(1, value);
+	TEST_ASSERT_EQUAL_INT(1, phash_field_try_get("cache-control", 13, &value));
+	TEST_ASSERT_EQUAL_INT(11, value);
+	TEST_ASSERT_EQUAL_INT(1, phash_field_try_get("x-\"quoted\"\\?", 12, &value));
+	TEST_ASSERT_EQUAL_INT(12, value);
+
+	value = -1;
+	TEST_ASSERT_EQUAL_INT(0, phash_field_try_get("hosts", 5, &value));
+	TEST_ASSERT_EQUAL_INT(-1, value);
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_count);
+	RUN_TEST(test_all_keys_found);
+	RUN_TEST(test_misses);
+	RUN_TEST(test_values);
+
+	return UNITY_END();
+}
@@ -0,0 +1,264 @@
+#include <unity.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define TL_K int
+#define TL_V int
+#define TL_NAME intint
+#include "ttlcache.h"
+
+#define TL_NO_ZERO_MEM
+#define TL_TTL_BATCH 4u
+#define TL_K int
+#define TL_V int
+#define TL_NAME small_batch
+#include "ttlcache.h"
+
+/* the host's TL_NAME and TL_NO_ZERO_MEM must not leak into a later flatmap instantiation */
+#define TL_K int
+#define TL_V int
+#include "flatmap.h"
+
+
+static int expired_keys[4096];
+static size_t expired_count = 0;
+static size_t batches = 0;
+static size_t largest_batch = 0;
+
+static void
+on_expire(const struct ttl_intint_entry* expired, size_t count, void* ctx)
+{
+	(void)ctx;
+	for (size_t i = 0; i < count; i++) {
+		expired_keys[expired_count++] = expired[i].key;
+	}
+	batches++;
+	if (count > largest_batch) largest_batch = count;
+}
+
+static void
+on_expire_small(const struct ttl_small_batch_entry* expired, size_t count, void* ctx)
+{
+	(void)expired;
+	*(size_t*)ctx += count;
+	batches++;
+	if (count > largest_batch) largest_batch = count;
+}
+
+static void
+on_expire_ordered(const struct ttl_intint_entry* expired, size_t count, void* ctx)
+{
+	uint64_t* last = ctx;
+	for (size_t i = 0; i < count; i++) {
+		TEST_ASSERT(expired[i].expires >= *last);
+		*last = expired[i].expires;
+	}
+}
+
+void setUp(void)
+{
+	expired_count = 0;
+	batches = 0;
+	largest_batch = 0;
+}
+
+void tearDown(void)
+{}
+
+
+void test_put_get(void)
+{
+	struct ttl_intint ttl;
+	TEST_ASSERT_EQUAL_INT(TLOK, ttl_intint_init(&ttl, 1000, on_expire, NULL));
+
+	TEST_ASSERT_EQUAL_INT(TLOK, ttl_intint_put(&ttl, 1, 10, 5));
+	TEST_ASSERT_EQUAL_INT(TL_EAE, ttl_intint_put(&ttl, 1, 11, 5));
+	TEST_ASSERT_EQUAL_size_t(1, ttl.size);
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, ttl_intint_try_get(&ttl, 1, &value));
+	TEST_ASSERT_EQUAL_INT(11, value);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, ttl_intint_try_get(&ttl, 2, &value));
+
+	TEST_ASSERT_EQUAL_size_t(0, ttl_intint_advance(&ttl, 1004));
+	TEST_ASSERT_EQUAL_INT(11, ttl_intint_get(&ttl, 1));
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, 1005));
+	TEST_ASSERT_EQUAL_size_t(0, ttl.size);
+	TEST_ASSERT_EQUAL_size_t(1, expired_count);
+	TEST_ASSERT_EQUAL_INT(1, expired_keys[0]);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, ttl_intint_try_get(&ttl, 1, &value));
+
+	ttl_intint_deinit(&ttl);
+}
+
+void test_expires_in_order_across_levels(void)
+{
+	struct ttl_intint ttl;
+	ttl_intint_init(&ttl, 7, on_expire, NULL);
+
+	/* spans level 0 up to level 4 */
+	const uint64_t ttls[] = {1, 63, 64, 65, 4095, 4096, 4097, 300000, 262144, 16777215, 16777216, 40000000, 0};
+	const size_t count = sizeof(ttls) / sizeof(ttls[0]);
+	for (size_t i = 0; i < count; i++) {
+		ttl_intint_put(&ttl, (int)i, 0, ttls[i]);
+	}
+
+	/* walk time with uneven steps and check nothing expires early or late */
+	uint64_t now = 7;
+	size_t seen = 0;
+	while (seen < count) {
+		const uint64_t before = now;
+		now += 1 + (now % 977);
+		ttl_intint_advance(&ttl, now);
+		for (; seen < expired_count; seen++) {
+			const uint64_t expires = 7 + ttls[expired_keys[seen]];
+			TEST_ASSERT(expires <= now);
+			TEST_ASSERT(expires > before || ttls[expired_keys[seen]] == 0);
+		}
+		for (size_t i = 0; i < count; i++) {
+			int value;
+			const int live = ttl_intint_try_get(&ttl, (int)i, &value) == TLOK;
+			TEST_ASSERT_EQUAL_INT(7 + ttls[i] > now, live);
+		}
+	}
+	TEST_ASSERT_EQUAL_size_t(0, ttl.size);
+
+	ttl_intint_deinit(&ttl);
+}
+
+void test_exact_tick_expiry(void)
+{
+	struct ttl_intint ttl;
+	ttl_intint_init(&ttl, 0, on_expire, NULL);
+
+	for (int i = 0; i < 2000; i++) {
+		ttl_intint_put(&ttl, i, i, (uint64_t)(i * 37 % 5000) + 1);
+	}
+	for (uint64_t now = 1; now <= 5001; now++) {
+		const size_t before = expired_count;
+		ttl_intint_advance(&ttl, now);
+		for (size_t i = before; i < expired_count; i++) {
+			TEST_ASSERT_EQUAL_UINT64(now, (uint64_t)(expired_keys[i] * 37 % 5000) + 1);
+		}
+	}
+	TEST_ASSERT_EQUAL_size_t(2000, expired_count);
+
+	ttl_intint_deinit(&ttl);
+}
+
+void test_big_jump(void)
+{
+	struct ttl_intint ttl;
+	ttl_intint_init(&ttl, 0, on_expire, NULL);
+
+	ttl_intint_put(&ttl, 1, 1, UINT64_C(1) << 40);
+	ttl_intint_put(&ttl, 2, 2, 10);
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, UINT64_C(1) << 39));
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, UINT64_C(1) << 41));
+	TEST_ASSERT_EQUAL_INT(2, expired_keys[0]);
+	TEST_ASSERT_EQUAL_INT(1, expired_keys[1]);
+
+	ttl_intint_deinit(&ttl);
+}
+
+void test_far_future_gap(void)
+{
+	struct ttl_intint ttl;
+	uint64_t last = 0;
+	ttl_intint_init(&ttl, 0, on_expire_ordered, &last);
+
+	/* many entries far beyond the lower levels, crossed with a few huge jumps */
+	for (int i = 0; i < 20000; i++) {
+		ttl_intint_put(&ttl, i, i, (UINT64_C(1) << 40) + (uint64_t)i * 1000003u);
+	}
+	ttl_intint_put(&ttl, -1, -1, UINT64_C(1) << 62);
+	ttl_intint_put(&ttl, -2, -2, UINT64_MAX);
+
+	TEST_ASSERT_EQUAL_size_t(0, ttl_intint_advance(&ttl, UINT64_C(1) << 36));
+	TEST_ASSERT_EQUAL_size_t(10000, ttl_intint_advance(&ttl, (UINT64_C(1) << 40) + UINT64_C(9999) * 1000003u));
+	TEST_ASSERT_EQUAL_INT(TL_ENF, ttl_intint_touch(&ttl, 9999, 1));
+	TEST_ASSERT_EQUAL_INT(TLOK, ttl_intint_touch(&ttl, 10000, (UINT64_C(1) << 20) * 1000003u));
+	TEST_ASSERT_EQUAL_size_t(10000, ttl_intint_advance(&ttl, UINT64_C(1) << 50));
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, UINT64_MAX - 1u));
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, UINT64_MAX));
+	TEST_ASSERT_EQUAL_size_t(0, ttl.size);
+
+	ttl_intint_deinit(&ttl);
+}
+
+void test_touch_remove(void)
+{
+	struct ttl_intint ttl;
+	ttl_intint_init(&ttl, 0, on_expire, NULL);
+
+	ttl_intint_put(&ttl, 1, 10, 10);
+	ttl_intint_put(&ttl, 2, 20, 10);
+	ttl_intint_put(&ttl, 3, 30, 0);
+
+	TEST_ASSERT_EQUAL_INT(TLOK, ttl_intint_touch(&ttl, 1, 100));
+	TEST_ASSERT_EQUAL_INT(TL_ENF, ttl_intint_touch(&ttl, 3, 100));   /* already expired */
+
+	int value = 0;
+	TEST_ASSERT_EQUAL_INT(TLOK, ttl_intint_remove(&ttl, 2, &value));
+	TEST_ASSERT_EQUAL_INT(20, value);
+	TEST_ASSERT_EQUAL_INT(TL_ENF, ttl_intint_remove(&ttl, 2, NULL));
+
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, 50));
+	TEST_ASSERT_EQUAL_INT(3, expired_keys[0]);
+	TEST_ASSERT_EQUAL_INT(10, ttl_intint_get(&ttl, 1));
+	TEST_ASSERT_EQUAL_size_t(1, ttl_intint_advance(&ttl, 100));
+	TEST_ASSERT_EQUAL_INT(1, expired_keys[1]);
+
+	ttl_intint_put(&ttl, 4, 40, 5);
+	ttl_intint_clear(&ttl);
+	TEST_ASSERT_EQUAL_size_t(0, ttl.size);
+	TEST_ASSERT_EQUAL_size_t(0, ttl_intint_advance(&ttl, 1000));
+
+	ttl_intint_deinit(&ttl);
+}
+
+void test_batches(void)
+{
+	size_t total = 0;
+	struct ttl_small_batch* ttl = ttl_small_batch_new(0, on_expire_small, &total);
+	TEST_ASSERT_NOT_NULL(ttl);
+
+	for (int i = 0; i < 10; i++) {
+		ttl_small_batch_put(ttl, i, i, 3);
+	}
+	TEST_ASSERT_EQUAL_size_t(10, ttl_small_batch_advance(ttl, 3));
+	TEST_ASSERT_EQUAL_size_t(10, total);
+	TEST_ASSERT_EQUAL_size_t(3, batches);
+	TEST_ASSERT_EQUAL_size_t(4, largest_batch);
+
+	ttl_small_batch_delete(&ttl);
+	TEST_ASSERT_NULL(ttl);
+}
+
+void test_flatmap_after_ttlcache(void)
+{
+	struct fmap_intint fm;
+
+	TEST_ASSERT_EQUAL_INT(TLOK, fmap_intint_init(&fm));
+	fmap_intint_insert(&fm, 1, 2);
+	TEST_ASSERT_EQUAL_INT(2, fmap_intint_get(&fm, 1));
+	fmap_intint_deinit(&fm);
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	RUN_TEST(test_put_get);
+	RUN_TEST(test_expires_in_order_across_levels);
+	RUN_TEST(test_exact_tick_expiry);
+	RUN_TEST(test_big_jump);
+	RUN_TEST(test_far_future_gap);
+	RUN_TEST(test_touch_remove);
+	RUN_TEST(test_batches);
+	RUN_TEST(test_flatmap_after_ttlcache);
+
+	return UNITY_END();
+}
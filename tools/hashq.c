@@ -0,0 +1,297 @@
+/**
+ * tl_hashq
+ * Hash quality report for a sample of flatmap keys.
+ *
+ * Reads one key per line and reports, for each provided hash, how it spreads the keys over the buckets of a flatmap
+ * sized for them (see src/private/hash_quality.h): the fullest bucket, the buckets that overflow (each one a TL_OOB
+ * grow), the chi squared of the bucket fill, the bias of the bucket selecting bits, the avalanche of the key bits into
+ * them and the num_buckets and load factor to initialize a map with so the sample goes in without any grow.
+ * Repeated keys are reported and left out, and keys sharing a full hash are reported as inseparable.
+ *
+ * Usage:
+ * 	tl_hashq [--int] [--hash <name>] [--load-factor <n>] <keys file>
+ *
+ * Without --int the keys are strings (TL_KEY_IS_NT maps) and the hashes are ntfnv1a, ntwy and ntsip13. With --int
+ * every line is an unsigned decimal or 0x prefixed hexadecimal integer, hashed as a uint64_t key with fnv1a, wyhash,
+ * siphash, fibhash and murmurhash. fibhash and murmurhash take the bucket from the high bits of the hash like a map
+ * with TL_KEY_IS_INT, the others from the low bits. --hash restricts the report to a single hash. Empty lines are
+ * skipped.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private/common.h"
+
+#define _PFX hashq
+#define TL_K uint64_t
+#define TL_KEY_IS_INT
+#include "private/hash_algorithm.h"
+#undef TL_KEY_IS_INT
+#undef TL_K
+#undef _PFX
+
+#include "private/hash_quality.h"
+
+struct hashq_keys
+{
+	char** strs;
+	uint64_t* ints;
+	size_t count;
+	size_t capacity;
+};
+
+struct hashq_hash
+{
+	const char* name;
+	tlhash_quality_fn* fn;
+	int high_bits;
+};
+
+static size_t
+hashq_str_fnv1a(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return tlhash_ntfnv1a(key);
+}
+
+static size_t
+hashq_str_wy(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return tlhash_ntwy(key);
+}
+
+static size_t
+hashq_str_sip(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	return tlhash_ntsip13(key, ctx);
+}
+
+static uint64_t
+hashq_int(const void* key)
+{
+	uint64_t value;
+	memcpy(&value, key, sizeof(value));
+	return value;
+}
+
+static size_t
+hashq_int_fnv1a(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return hashq_fnv1a(hashq_int(key));
+}
+
+static size_t
+hashq_int_wy(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return hashq_wyhash(hashq_int(key));
+}
+
+static size_t
+hashq_int_sip(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	return hashq_siphash(hashq_int(key), ctx);
+}
+
+static size_t
+hashq_int_fib(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return hashq_fibhash(hashq_int(key));
+}
+
+static size_t
+hashq_int_murmur(const void* key, size_t len, void* ctx)
+{
+	(void)len;
+	(void)ctx;
+	return hashq_murmurhash(hashq_int(key));
+}
+
+static const struct hashq_hash hashq_str_hashes[] = {
+	{"ntfnv1a", &hashq_str_fnv1a, 0},
+	{"ntwy", &hashq_str_wy, 0},
+	{"ntsip13", &hashq_str_sip, 0},
+};
+
+static const struct hashq_hash hashq_int_hashes[] = {
+	{"fnv1a", &hashq_int_fnv1a, 0},
+	{"wyhash", &hashq_int_wy, 0},
+	{"siphash", &hashq_int_sip, 0},
+	{"fibhash", &hashq_int_fib, 1},
+	{"murmurhash", &hashq_int_murmur, 1},
+};
+
+static int
+hashq_read(struct hashq_keys* keys, const char* path, int ints)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		fprintf(stderr, "tl_hashq: cannot open %s\n", path);
+		return 0;
+	}
+
+	char line[4096];
+	size_t lineno = 0;
+	while (fgets(line, sizeof(line), file)) {
+		size_t len = strlen(line);
+		lineno++;
+
+		if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+			fprintf(stderr, "tl_hashq: %s:%zu: line too long\n", path, lineno);
+			fclose(file);
+			return 0;
+		}
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+			line[--len] = '\0';
+		}
+		if (len == 0)
+			continue;
+
+		if (keys->count == keys->capacity) {
+			keys->capacity = keys->capacity ? keys->capacity * 2 : 1024;
+			if (ints) {
+				uint64_t* grown = realloc(keys->ints, keys->capacity * sizeof(uint64_t));
+				if (grown) keys->ints = grown;
+				else keys->capacity = 0;
+			} else {
+				char** grown = realloc(keys->strs, keys->capacity * sizeof(char*));
+				if (grown) keys->strs = grown;
+				else keys->capacity = 0;
+			}
+			if (keys->capacity == 0) {
+				fprintf(stderr, "tl_hashq: out of memory\n");
+				fclose(file);
+				return 0;
+			}
+		}
+
+		if (ints) {
+			char* end = NULL;
+			keys->ints[keys->count] = (uint64_t)strtoull(line, &end, 0);
+			if (end == line || *end != '\0') {
+				fprintf(stderr, "tl_hashq: %s:%zu: not an integer\n", path, lineno);
+				fclose(file);
+				return 0;
+			}
+		} else {
+			keys->strs[keys->count] = malloc(len + 1);
+			if (!keys->strs[keys->count]) {
+				fprintf(stderr, "tl_hashq: out of memory\n");
+				fclose(file);
+				return 0;
+			}
+			memcpy(keys->strs[keys->count], line, len + 1);
+		}
+		keys->count++;
+	}
+
+	fclose(file);
+	if (keys->count == 0) {
+		fprintf(stderr, "tl_hashq: %s holds no keys\n", path);
+		return 0;
+	}
+	return 1;
+}
+
+static void
+hashq_print(const struct hashq_hash* hash, const struct tlhash_quality* q)
+{
+	printf("%s (%s bits)\n", hash->name, hash->high_bits ? "high" : "low");
+	printf("  buckets            %zu x %zu slots for %zu keys\n", q->num_buckets, q->bucket_max, q->count);
+	printf("  duplicate keys     %zu (left out)\n", q->duplicate_keys);
+	printf("  inseparable keys   %zu (sharing a full hash)\n", q->inseparable_keys);
+	printf("  max bucket fill    %zu\n", q->max_fill);
+	printf("  overflow buckets   %zu (uniform hash overflow chance %.4f)\n", q->overflow_buckets,
+		q->oob_probability);
+	printf("  TL_OOB grows       %zu\n", q->oob_grows);
+	printf("  chi squared / df   %.3f\n", q->chi_squared);
+	printf("  worst bit bias     %.4f (hash bit %u, %u bucket bits)\n", q->worst_bit_bias, q->worst_bit,
+		q->bucket_bits);
+	printf("  avalanche bias     %.4f worst, %.4f mean\n", q->avalanche_bias, q->avalanche_mean);
+	if (q->recommended_buckets != 0) {
+		printf("  recommended        num_buckets %zu, load factor >= %zu\n\n", q->recommended_buckets,
+			q->recommended_load_factor);
+	} else {
+		printf("  recommended        none, the sample still overflows after %u doublings\n\n",
+			TLHASH_QUALITY_MAX_GROWS);
+	}
+}
+
+int
+main(int argc, char** argv)
+{
+	const char* only = NULL;
+	const char* path = NULL;
+	size_t load_factor = 70;
+	int ints = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--int") == 0) {
+			ints = 1;
+		} else if (i + 1 < argc && strcmp(argv[i], "--hash") == 0) {
+			only = argv[++i];
+		} else if (i + 1 < argc && strcmp(argv[i], "--load-factor") == 0) {
+			load_factor = (size_t)strtoul(argv[++i], NULL, 10);
+		} else if (!path && argv[i][0] != '-') {
+			path = argv[i];
+		} else {
+			path = NULL;
+			break;
+		}
+	}
+	if (!path || load_factor == 0 || load_factor > 100) {
+		fprintf(stderr, "usage: %s [--int] [--hash <name>] [--load-factor <1-100>] <keys file>\n", argv[0]);
+		return 2;
+	}
+
+	struct hashq_keys keys;
+	memset(&keys, 0, sizeof(keys));
+	int ok = hashq_read(&keys, path, ints);
+
+	const struct hashq_hash* hashes = ints ? hashq_int_hashes : hashq_str_hashes;
+	const size_t hash_count = ints ? sizeof(hashq_int_hashes) / sizeof(hashq_int_hashes[0])
+		: sizeof(hashq_str_hashes) / sizeof(hashq_str_hashes[0]);
+	uint64_t seed[2];
+	tlhash_seed(seed, &keys);
+
+	size_t reported = 0;
+	for (size_t h = 0; ok && h < hash_count; h++) {
+		if (only && strcmp(only, hashes[h].name) != 0)
+			continue;
+
+		struct tlhash_quality q;
+		const void* data = ints ? (const void*)keys.ints : (const void*)keys.strs;
+		if (tlhash_quality(hashes[h].fn, seed, data, ints ? sizeof(uint64_t) : 0, keys.count, load_factor,
+			hashes[h].high_bits, &q) != TLOK) {
+			fprintf(stderr, "tl_hashq: out of memory\n");
+			ok = 0;
+			break;
+		}
+		hashq_print(&hashes[h], &q);
+		reported++;
+	}
+	if (ok && reported == 0) {
+		fprintf(stderr, "tl_hashq: unknown hash %s\n", only);
+		ok = 0;
+	}
+
+	for (size_t i = 0; keys.strs && i < keys.count; i++) {
+		free(keys.strs[i]);
+	}
+	free(keys.strs);
+	free(keys.ints);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,513 @@
+/**
+ * tl_phgen
+ * Build-time perfect hash generator for static key sets.
+ *
+ * Reads one key per line and writes a self-contained C header holding a minimal perfect hash over those keys as
+ * static tables plus inline lookup functions. Nothing is allocated and nothing has to be initialized at runtime, so a
+ * lookup of a literal key can be folded by the compiler.
+ *
+ * Usage:
+ * 	tl_phgen <name> <keys file> <output header> [value type]
+ *
+ * Without a value type every line is a key. With a value type every line is `key<TAB>value` where value is a C
+ * expression of that type, copied verbatim into the generated table. Empty lines are skipped and keys may not contain
+ * tabs, newlines or NUL bytes.
+ *
+ * Generated symbols, for a <name> of kw:
+ * 	PHASH_KW_COUNT                                      - The number of keys
+ * 	phash_kw_keys[]                                     - The keys, in slot order
+ * 	phash_kw_values[]                                   - The values, in slot order (only with a value type)
+ * 	size_t phash_kw_index(const char* key, size_t len)  - The slot of key, or PHASH_KW_COUNT when not a member
+ * 	size_t phash_kw_find(const char* key)               - phash_kw_index for a NUL terminated key
+ * 	int phash_kw_contains(const char* key, size_t len)  - 1 when key is a member, otherwise 0
+ * 	int phash_kw_try_get(const char* key, size_t len, <value type>* out_value)
+ * 	                                                    - 1 and out_value set when found (only with a value type)
+ *
+ * The hash is a seeded 64 bit FNV-1a followed by the murmur3 finalizer. It is written with fixed width types so the
+ * generated header gives the same results on every platform, independent of the size of size_t.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PHGEN_DIRECT 0x80000000u
+#define PHGEN_MAX_DISP (1u << 20u)
+#define PHGEN_SEEDS 64u
+
+struct phgen_key
+{
+	char* key;
+	size_t len;
+	char* value;
+	uint64_t hash;
+	uint64_t mixed;
+};
+
+struct phgen
+{
+	struct phgen_key* keys;
+	size_t count;
+	size_t capacity;
+	size_t num_buckets;
+	uint64_t seed;
+	uint32_t* disp;
+	size_t* slot_of;
+};
+
+static uint64_t
+phgen_mix(uint64_t hash)
+{
+	hash ^= hash >> 33u;
+	hash *= 0xff51afd7ed558ccdu;
+	hash ^= hash >> 33u;
+	hash *= 0xc4ceb9fe1a85ec53u;
+	hash ^= hash >> 33u;
+	return hash;
+}
+
+static uint64_t
+phgen_fnv1a(const char* key, size_t len)
+{
+	const unsigned char* data = (const unsigned char*)key;
+	uint64_t hash = 0xcbf29ce484222325u;
+
+	while (len-- != 0) {
+		hash = (*data ^ hash) * 0x00000100000001b3u;
+		data += 1;
+	}
+	return hash;
+}
+
+static size_t
+phgen_slot(uint64_t mixed, uint32_t disp, size_t count)
+{
+	if (disp & PHGEN_DIRECT)
+		return disp ^ PHGEN_DIRECT;
+	return (size_t)(((phgen_mix(mixed ^ disp) >> 32u) * (uint64_t)count) >> 32u);
+}
+
+static int
+phgen_read(struct phgen* gen, const char* path, int with_values)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		fprintf(stderr, "tl_phgen: cannot open %s\n", path);
+		return 0;
+	}
+
+	char line[4096];
+	size_t lineno = 0;
+	while (fgets(line, sizeof(line), file)) {
+		size_t len = strlen(line);
+		lineno++;
+
+		if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+			fprintf(stderr, "tl_phgen: %s:%zu: line too long\n", path, lineno);
+			fclose(file);
+			return 0;
+		}
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+			line[--len] = '\0';
+		}
+		if (len == 0)
+			continue;
+
+		char* value = NULL;
+		char* tab = memchr(line, '\t', len);
+		if (with_values) {
+			if (!tab) {
+				fprintf(stderr, "tl_phgen: %s:%zu: expected key<TAB>value\n", path, lineno);
+				fclose(file);
+				return 0;
+			}
+			*tab = '\0';
+			value = tab + 1;
+			len = (size_t)(tab - line);
+		} else if (tab) {
+			fprintf(stderr, "tl_phgen: %s:%zu: tab in key (pass a value type for key/value input)\n", path,
+				lineno);
+			fclose(file);
+			return 0;
+		}
+
+		if (gen->count == gen->capacity) {
+			gen->capacity = gen->capacity ? gen->capacity * 2 : 64;
+			gen->keys = realloc(gen->keys, gen->capacity * sizeof(struct phgen_key));
+			if (!gen->keys) {
+				fclose(file);
+				return 0;
+			}
+		}
+
+		struct phgen_key* entry = &gen->keys[gen->count++];
+		entry->key = malloc(len + 1);
+		entry->value = value ? malloc(strlen(value) + 1) : NULL;
+		if (!entry->key || (value && !entry->value)) {
+			fclose(file);
+			return 0;
+		}
+		memcpy(entry->key, line, len + 1);
+		entry->len = len;
+		if (value) strcpy(entry->value, value);
+		entry->hash = phgen_fnv1a(entry->key, len);
+	}
+
+	fclose(file);
+	return 1;
+}
+
+static int
+phgen_cmp_hash(const void* left, const void* right)
+{
+	const struct phgen_key* const* l = left;
+	const struct phgen_key* const* r = right;
+	return ((*l)->hash > (*r)->hash) - ((*l)->hash < (*r)->hash);
+}
+
+static int
+phgen_check_duplicates(const struct phgen* gen)
+{
+	if (gen->count < 2)
+		return 1;
+
+	const struct phgen_key** sorted = malloc(gen->count * sizeof(struct phgen_key*));
+	if (!sorted)
+		return 0;
+	for (size_t i = 0; i < gen->count; i++) {
+		sorted[i] = &gen->keys[i];
+	}
+	qsort(sorted, gen->count, sizeof(struct phgen_key*), phgen_cmp_hash);
+
+	int ok = 1;
+	for (size_t i = 1; i < gen->count && ok; i++) {
+		const struct phgen_key* l = sorted[i - 1];
+		const struct phgen_key* r = sorted[i];
+		if (l->hash != r->hash)
+			continue;
+		if (l->len == r->len && memcmp(l->key, r->key, l->len) == 0)
+			fprintf(stderr, "tl_phgen: duplicate key \"%s\"\n", l->key);
+		else
+			fprintf(stderr, "tl_phgen: \"%s\" and \"%s\" share a hash\n", l->key, r->key);
+		ok = 0;
+	}
+
+	free(sorted);
+	return ok;
+}
+
+/**
+ * One CHD placement attempt with gen->seed, largest buckets first. Returns 1 on success, 0 when another seed should be
+ * tried.
+ */
+static int
+phgen_place(struct phgen* gen, size_t* offsets, size_t* members, size_t* order, size_t* slots, unsigned char* taken)
+{
+	const size_t n = gen->count;
+	const size_t nb = gen->num_buckets;
+	size_t i;
+	size_t b;
+
+	for (i = 0; i < n; i++) {
+		gen->keys[i].mixed = phgen_mix(gen->keys[i].hash ^ gen->seed);
+	}
+
+	memset(offsets, 0, (nb + 1) * sizeof(size_t));
+	for (i = 0; i < n; i++) {
+		offsets[(gen->keys[i].mixed & (nb - 1)) + 1]++;
+	}
+	for (b = 0; b < nb; b++) {
+		offsets[b + 1] += offsets[b];
+		order[b] = offsets[b];
+	}
+	for (i = 0; i < n; i++) {
+		members[order[gen->keys[i].mixed & (nb - 1)]++] = i;
+	}
+
+	/* order the buckets largest first with a counting sort over their sizes, slots is free until placement */
+	size_t largest = 0;
+	for (b = 0; b < nb; b++) {
+		if (offsets[b + 1] - offsets[b] > largest) largest = offsets[b + 1] - offsets[b];
+	}
+	size_t* by_size = slots + largest;
+	memset(by_size, 0, (largest + 1) * sizeof(size_t));
+	for (b = 0; b < nb; b++) {
+		by_size[largest - (offsets[b + 1] - offsets[b])]++;
+	}
+	size_t start = 0;
+	for (i = 0; i <= largest; i++) {
+		const size_t count = by_size[i];
+		by_size[i] = start;
+		start += count;
+	}
+	for (b = 0; b < nb; b++) {
+		order[by_size[largest - (offsets[b + 1] - offsets[b])]++] = b;
+	}
+
+	memset(taken, 0, n);
+	size_t next_free = 0;
+	for (b = 0; b < nb; b++) {
+		const size_t bucket = order[b];
+		const size_t* member = members + offsets[bucket];
+		const size_t k = offsets[bucket + 1] - offsets[bucket];
+
+		if (k == 0) {
+			gen->disp[bucket] = 0;
+			continue;
+		}
+		if (k == 1) {
+			while (taken[next_free]) next_free++;
+			taken[next_free] = 1;
+			gen->disp[bucket] = PHGEN_DIRECT | (uint32_t)next_free;
+			continue;
+		}
+
+		uint32_t d;
+		for (d = 0; d < PHGEN_MAX_DISP; d++) {
+			for (i = 0; i < k; i++) {
+				size_t j;
+				slots[i] = phgen_slot(gen->keys[member[i]].mixed, d, n);
+				if (taken[slots[i]])
+					break;
+				for (j = 0; j < i && slots[j] != slots[i]; j++);
+				if (j != i)
+					break;
+			}
+			if (i == k)
+				break;
+		}
+		if (d == PHGEN_MAX_DISP)
+			return 0;
+
+		for (i = 0; i < k; i++) {
+			taken[slots[i]] = 1;
+		}
+		gen->disp[bucket] = d;
+	}
+
+	for (i = 0; i < n; i++) {
+		const struct phgen_key* key = &gen->keys[i];
+		gen->slot_of[phgen_slot(key->mixed, gen->disp[key->mixed & (nb - 1)], n)] = i;
+	}
+	return 1;
+}
+
+static int
+phgen_build(struct phgen* gen)
+{
+	const size_t n = gen->count;
+	size_t nb = 2;
+	while (nb < (n + 3) / 4) nb <<= 1u;
+
+	gen->num_buckets = nb;
+	gen->disp = calloc(nb, sizeof(uint32_t));
+	gen->slot_of = calloc(n ? n : 1, sizeof(size_t));
+
+	size_t* offsets = calloc(nb + 1, sizeof(size_t));
+	size_t* members = calloc(n ? n : 1, sizeof(size_t));
+	size_t* order = calloc(nb, sizeof(size_t));
+	size_t* slots = calloc((2 * n) + 1, sizeof(size_t));
+	unsigned char* taken = calloc(n ? n : 1, 1);
+	int ok = 0;
+
+	if (gen->disp && gen->slot_of && offsets && members && order && slots && taken) {
+		for (uint64_t attempt = 0; attempt < PHGEN_SEEDS && !ok; attempt++) {
+			gen->seed = phgen_mix(attempt + 1);
+			ok = phgen_place(gen, offsets, members, order, slots, taken);
+		}
+		if (!ok)
+			fprintf(stderr, "tl_phgen: no perfect hash found\n");
+	}
+
+	free(offsets);
+	free(members);
+	free(order);
+	free(slots);
+	free(taken);
+	return ok;
+}
+
+static void
+phgen_write_string(FILE* out, const char* key, size_t len)
+{
+	fputc('"', out);
+	for (size_t i = 0; i < len; i++) {
+		const unsigned char c = (unsigned char)key[i];
+		if (c == '"' || c == '\\')
+			fprintf(out, "\\%c", c);
+		else if (c == '?')
+			fputs("\\?", out);    /* no trigraphs */
+		else if (isprint(c))
+			fputc(c, out);
+		else
+			fprintf(out, "\\%03o", c);
+	}
+	fputc('"', out);
+}
+
+static int
+phgen_write(const struct phgen* gen, const char* name, const char* path, const char* value_type)
+{
+	FILE* out = fopen(path, "wb");
+	if (!out) {
+		fprintf(stderr, "tl_phgen: cannot create %s\n", path);
+		return 0;
+	}
+
+	char upper[256];
+	size_t i;
+	for (i = 0; name[i] != '\0' && i < sizeof(upper) - 1; i++) {
+		upper[i] = (char)toupper((unsigned char)name[i]);
+	}
+	upper[i] = '\0';
+
+	const size_t n = gen->count;
+	const size_t table_n = n ? n : 1;
+
+	fprintf(out, "/* Generated by tl_phgen. Do not edit. */\n\n");
+	fprintf(out, "#ifndef TEMPLATE_LIB_PHASH_%s_H\n#define TEMPLATE_LIB_PHASH_%s_H\n\n", upper, upper);
+	fprintf(out, "#include <stddef.h>\n#include <stdint.h>\n#include <string.h>\n\n");
+	fprintf(out, "#define PHASH_%s_COUNT %zuu\n\n", upper, n);
+
+	fprintf(out, "static const char* const phash_%s_keys[%zu] = {\n", name, table_n);
+	for (i = 0; i < n; i++) {
+		const struct phgen_key* key = &gen->keys[gen->slot_of[i]];
+		fputc('\t', out);
+		phgen_write_string(out, key->key, key->len);
+		fputs(",\n", out);
+	}
+	if (n == 0) fputs("\t\"\",\n", out);
+	fputs("};\n\n", out);
+
+	fprintf(out, "static const uint32_t phash_%s_lengths[%zu] = {\n", name, table_n);
+	for (i = 0; i < n; i++) {
+		fprintf(out, "\t%zuu,\n", gen->keys[gen->slot_of[i]].len);
+	}
+	if (n == 0) fputs("\t0u,\n", out);
+	fputs("};\n\n", out);
+
+	if (value_type) {
+		fprintf(out, "static const %s phash_%s_values[%zu] = {\n", value_type, name, table_n);
+		for (i = 0; i < n; i++) {
+			fprintf(out, "\t%s,\n", gen->keys[gen->slot_of[i]].value);
+		}
+		if (n == 0) fputs("\t{0},\n", out);
+		fputs("};\n\n", out);
+	}
+
+	fprintf(out, "static const uint32_t phash_%s_disp[%zu] = {", name, gen->num_buckets);
+	for (i = 0; i < gen->num_buckets; i++) {
+		fprintf(out, "%s0x%08lxu,", (i % 6 == 0) ? "\n\t" : " ", (unsigned long)gen->disp[i]);
+	}
+	fputs("\n};\n\n", out);
+
+	fprintf(out,
+		"static inline uint64_t\n"
+		"phash_%s_mix(uint64_t hash)\n"
+		"{\n"
+		"\thash ^= hash >> 33u;\n"
+		"\thash *= UINT64_C(0xff51afd7ed558ccd);\n"
+		"\thash ^= hash >> 33u;\n"
+		"\thash *= UINT64_C(0xc4ceb9fe1a85ec53);\n"
+		"\thash ^= hash >> 33u;\n"
+		"\treturn hash;\n"
+		"}\n\n", name);
+
+	fprintf(out,
+		"static inline size_t\n"
+		"phash_%s_index(const char* key, size_t len)\n"
+		"{\n"
+		"\tconst unsigned char* data = (const unsigned char*)key;\n"
+		"\tuint64_t hash = UINT64_C(0xcbf29ce484222325);\n"
+		"\tfor (size_t i = 0; i < len; i++) {\n"
+		"\t\thash = (data[i] ^ hash) * UINT64_C(0x00000100000001b3);\n"
+		"\t}\n\n"
+		"\tconst uint64_t mixed = phash_%s_mix(hash ^ UINT64_C(0x%016llx));\n"
+		"\tconst uint32_t disp = phash_%s_disp[mixed & %zuu];\n"
+		"\tconst size_t slot = (disp & 0x80000000u)\n"
+		"\t\t? (size_t)(disp ^ 0x80000000u)\n"
+		"\t\t: (size_t)(((phash_%s_mix(mixed ^ disp) >> 32u) * UINT64_C(%zu)) >> 32u);\n\n"
+		"\tif (PHASH_%s_COUNT == 0u || phash_%s_lengths[slot] != len"
+		" || memcmp(phash_%s_keys[slot], key, len) != 0)\n"
+		"\t\treturn PHASH_%s_COUNT;\n"
+		"\treturn slot;\n"
+		"}\n\n",
+		name, name, (unsigned long long)gen->seed, name, gen->num_buckets - 1, name, n, upper, name, name, upper);
+
+	fprintf(out,
+		"static inline size_t\n"
+		"phash_%s_find(const char* key)\n"
+		"{\n"
+		"\treturn phash_%s_index(key, strlen(key));\n"
+		"}\n\n", name, name);
+
+	fprintf(out,
+		"static inline int\n"
+		"phash_%s_contains(const char* key, size_t len)\n"
+		"{\n"
+		"\treturn phash_%s_index(key, len) != PHASH_%s_COUNT;\n"
+		"}\n\n", name, name, upper);
+
+	if (value_type) {
+		fprintf(out,
+			"static inline int\n"
+			"phash_%s_try_get(const char* key, size_t len, %s* out_value)\n"
+			"{\n"
+			"\tconst size_t slot = phash_%s_index(key, len);\n"
+			"\tif (slot == PHASH_%s_COUNT)\n"
+			"\t\treturn 0;\n"
+			"\t*out_value = phash_%s_values[slot];\n"
+			"\treturn 1;\n"
+			"}\n\n", name, value_type, name, upper, name);
+	}
+
+	fprintf(out, "#endif //TEMPLATE_LIB_PHASH_%s_H\n", upper);
+
+	const int ok = !ferror(out);
+	return (fclose(out) == 0) && ok;
+}
+
+static int
+phgen_valid_name(const char* name)
+{
+	if (!isalpha((unsigned char)name[0]) && name[0] != '_')
+		return 0;
+	for (const char* c = name; *c != '\0'; c++) {
+		if (!isalnum((unsigned char)*c) && *c != '_')
+			return 0;
+	}
+	return strlen(name) < 200;
+}
+
+int
+main(int argc, char** argv)
+{
+	if (argc != 4 && argc != 5) {
+		fprintf(stderr, "usage: %s <name> <keys file> <output header> [value type]\n", argv[0]);
+		return 2;
+	}
+	if (!phgen_valid_name(argv[1])) {
+		fprintf(stderr, "tl_phgen: \"%s\" is not a valid C identifier\n", argv[1]);
+		return 2;
+	}
+
+	struct phgen gen;
+	memset(&gen, 0, sizeof(gen));
+	const char* value_type = (argc == 5) ? argv[4] : NULL;
+
+	int ok = phgen_read(&gen, argv[2], value_type != NULL)
+		&& phgen_check_duplicates(&gen)
+		&& phgen_build(&gen)
+		&& phgen_write(&gen, argv[1], argv[3], value_type);
+
+	for (size_t i = 0; i < gen.count; i++) {
+		free(gen.keys[i].key);
+		free(gen.keys[i].value);
+	}
+	free(gen.keys);
+	free(gen.disp);
+	free(gen.slot_of);
+	return ok ? 0 : 1;
+}